@@ -0,0 +1,350 @@
+/* This file is part of the R-package 'GWcovar'
+ *
+ * Copyright (C) 2019 Josef Stocker <josef@josefstocker.ch>
+ *
+ * 'GWcovar' is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <https://www.gnu.org/licenses/>.
+ * */
+
+
+/* ***************************************************************************
+ * ** Include directives  ****************************************************
+ * **************************************************************************/
+
+#include "async.h"
+
+#include "pthread.h"
+#include "signal.h"
+#include "time.h"
+#include "math.h"
+
+/* ***************************************************************************
+ * ** Private data structures ************************************************
+ * **************************************************************************/
+
+static pthread_mutex_t async_lock = PTHREAD_MUTEX_INITIALIZER ;
+static pthread_cond_t async_work = PTHREAD_COND_INITIALIZER ;
+static pthread_cond_t async_finished = PTHREAD_COND_INITIALIZER ;
+/* one lock protects the whole pool; 'async_work' is signalled when a job is
+ * queued, 'async_finished' when a job is done */
+
+static Async_job* async_head = NULL ;
+static Async_job* async_tail = NULL ;
+/* queued jobs, first in first out */
+
+static Async_job* async_running = NULL ;
+/* jobs being run (in no particular order) */
+
+static size_t async_workers = 0 ;
+/* number of threads of the pool */
+
+static int async_forkable = 0 ;
+/* '1' once the fork handlers are registered */
+
+
+
+/* ***************************************************************************
+ * ** Functions **************************************************************
+ * **************************************************************************/
+
+
+/* ***********************
+ * ** private functions **
+ * **********************/
+
+static void
+finish (
+
+        Async_job* job ,
+        int status
+        )
+/* marks 'job' as done; the lock has to be held */
+{
+    job->status = status ;
+    job->state = ASYNC_DONE ;
+    job->next = NULL ;
+    pthread_cond_broadcast( &async_finished ) ;
+}
+
+static void
+remove_running (
+
+        Async_job* job
+        )
+/* removes 'job' from the list of running jobs; the lock has to be held */
+{
+    Async_job** p = &async_running ;
+    while ( *p != NULL && *p != job ) {
+
+        p = &(*p)->next ;
+    }
+    if ( *p != NULL ) {
+
+        *p = job->next ;
+    }
+}
+
+static void*
+worker (
+
+        void* dummy
+        )
+/* thread of the pool: runs the queued jobs one after the other */
+{
+    (void) dummy ;
+    pthread_mutex_lock( &async_lock ) ;
+    for ( ;; ) {
+
+        while ( async_head == NULL ) {
+
+            pthread_cond_wait( &async_work, &async_lock ) ;
+        }
+        Async_job* job = async_head ;
+        async_head = job->next ;
+        if ( async_head == NULL ) {
+
+            async_tail = NULL ;
+        }
+        job->state = ASYNC_RUNNING ;
+        job->next = async_running ;
+        async_running = job ;
+
+        pthread_mutex_unlock( &async_lock ) ;
+        int status = job->run( job ) ;
+        pthread_mutex_lock( &async_lock ) ;
+
+        /* the owner may free the job as soon as the lock is released */
+        remove_running( job ) ;
+        finish( job, status ) ;
+    }
+    return NULL ;
+}
+
+static void
+fork_prepare (
+
+        void
+        )
+/* no job changes its state while the process forks */
+{
+    pthread_mutex_lock( &async_lock ) ;
+}
+
+static void
+fork_parent (
+
+        void
+        )
+{
+    pthread_mutex_unlock( &async_lock ) ;
+}
+
+static void
+fork_child (
+
+        void
+        )
+/* the child has no thread of the pool: its jobs can never finish */
+{
+    while ( async_head != NULL ) {
+
+        Async_job* job = async_head ;
+        async_head = job->next ;
+        finish( job, ASYNC_CANCELLED ) ;
+    }
+    while ( async_running != NULL ) {
+
+        Async_job* job = async_running ;
+        async_running = job->next ;
+        finish( job, ASYNC_CANCELLED ) ;
+    }
+    async_tail = NULL ;
+    async_workers = 0 ;
+    pthread_mutex_unlock( &async_lock ) ;
+}
+
+static int
+start_workers (
+
+        size_t workers
+        )
+/* grows the pool to 'workers' threads; the lock has to be held. Returns
+ * 'ASYNC_OK' if the pool has at least one thread. */
+{
+    if ( !async_forkable ) {
+
+        async_forkable = pthread_atfork( fork_prepare, fork_parent,
+                fork_child ) == 0 ;
+    }
+
+    /* the threads inherit the blocked signals */
+    sigset_t all, old ;
+    sigfillset( &all ) ;
+    pthread_sigmask( SIG_SETMASK, &all, &old ) ;
+
+    pthread_attr_t attr ;
+    pthread_attr_init( &attr ) ;
+    pthread_attr_setdetachstate( &attr, PTHREAD_CREATE_DETACHED ) ;
+    while ( async_workers < workers ) {
+
+        pthread_t thread ;
+        if ( pthread_create( &thread, &attr, worker, NULL ) != 0 ) {
+
+            break ;
+        }
+        async_workers++ ;
+    }
+    pthread_attr_destroy( &attr ) ;
+    pthread_sigmask( SIG_SETMASK, &old, NULL ) ;
+
+    return async_workers > 0 ? ASYNC_OK : ASYNC_ETHREAD ;
+}
+
+
+
+/* **********************
+ * ** public functions **
+ * *********************/
+
+int
+async_submit (
+
+        Async_job* job ,
+        size_t workers
+        )
+{
+    pthread_mutex_lock( &async_lock ) ;
+    int ret = start_workers( workers > 0 ? workers : 1 ) ;
+    job->cancel = 0 ;
+    job->next = NULL ;
+    if ( ret != ASYNC_OK ) {
+
+        job->state = ASYNC_NEW ;
+        pthread_mutex_unlock( &async_lock ) ;
+        return ret ;
+    }
+
+    job->state = ASYNC_QUEUED ;
+    if ( async_tail == NULL ) {
+
+        async_head = job ;
+    } else {
+
+        async_tail->next = job ;
+    }
+    async_tail = job ;
+    pthread_cond_signal( &async_work ) ;
+    pthread_mutex_unlock( &async_lock ) ;
+    return ASYNC_OK ;
+}
+
+int
+async_done (
+
+        Async_job* job
+        )
+{
+    pthread_mutex_lock( &async_lock ) ;
+    int done = job->state == ASYNC_DONE || job->state == ASYNC_NEW ;
+    pthread_mutex_unlock( &async_lock ) ;
+    return done ;
+}
+
+void
+async_wait (
+
+        Async_job* job
+        )
+{
+    pthread_mutex_lock( &async_lock ) ;
+    while ( job->state == ASYNC_QUEUED || job->state == ASYNC_RUNNING ) {
+
+        pthread_cond_wait( &async_finished, &async_lock ) ;
+    }
+    pthread_mutex_unlock( &async_lock ) ;
+}
+
+int
+async_wait_for (
+
+        Async_job* job ,
+        double seconds
+        )
+{
+    struct timespec until ;
+    clock_gettime( CLOCK_REALTIME, &until ) ;
+    double whole = floor( seconds ) ;
+    until.tv_sec += (time_t) whole ;
+    until.tv_nsec += (long) ( ( seconds - whole ) * 1e9 ) ;
+    if ( until.tv_nsec >= 1000000000L ) {
+
+        until.tv_sec++ ;
+        until.tv_nsec -= 1000000000L ;
+    }
+
+    pthread_mutex_lock( &async_lock ) ;
+    int ret = 0 ;
+    while ( ( job->state == ASYNC_QUEUED || job->state == ASYNC_RUNNING )
+            && ret == 0 ) {
+
+        ret = pthread_cond_timedwait( &async_finished, &async_lock, &until ) ;
+    }
+    int done = job->state != ASYNC_QUEUED && job->state != ASYNC_RUNNING ;
+    pthread_mutex_unlock( &async_lock ) ;
+    return done ;
+}
+
+void
+async_cancel (
+
+        Async_job* job
+        )
+{
+    pthread_mutex_lock( &async_lock ) ;
+    job->cancel = 1 ;
+    if ( job->state == ASYNC_QUEUED ) {
+
+        Async_job* prev = NULL ;
+        Async_job* p = async_head ;
+        while ( p != job ) {
+
+            prev = p ;
+            p = p->next ;
+        }
+        if ( prev == NULL ) {
+
+            async_head = job->next ;
+        } else {
+
+            prev->next = job->next ;
+        }
+        if ( async_tail == job ) {
+
+            async_tail = prev ;
+        }
+        finish( job, ASYNC_CANCELLED ) ;
+    }
+    pthread_mutex_unlock( &async_lock ) ;
+}
+
+int
+async_cancelled (
+
+        Async_job* job
+        )
+{
+    pthread_mutex_lock( &async_lock ) ;
+    int cancel = job->cancel ;
+    pthread_mutex_unlock( &async_lock ) ;
+    return cancel ;
+}
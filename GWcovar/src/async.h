@@ -0,0 +1,159 @@
+/* This file is part of the R-package 'GWcovar'
+ *
+ * Copyright (C) 2019 Josef Stocker <josef@josefstocker.ch>
+ *
+ * 'GWcovar' is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <https://www.gnu.org/licenses/>.
+ * */
+
+#ifndef ASYNC_H_
+#define ASYNC_H_
+
+
+/* ****************************************************************************
+ * ** Include directives  *****************************************************
+ * ***************************************************************************/
+
+#include "stddef.h" /* for type size_t */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+
+/* ***************************************************************************
+ * ** Public data structures *************************************************
+ * **************************************************************************/
+
+#define ASYNC_OK 0
+#define ASYNC_ETHREAD 1
+/* return values of 'async_submit(...)' */
+
+#define ASYNC_CANCELLED -1
+/* status of a job that was cancelled before it started or lost in a fork */
+
+typedef enum {
+    ASYNC_NEW = 0,
+    ASYNC_QUEUED = 1,
+    ASYNC_RUNNING = 2,
+    ASYNC_DONE = 3
+} Async_state ;
+
+
+typedef struct Async_job Async_job ;
+
+struct Async_job {
+/* ***************************************************************************
+ * A job of the background thread pool. A job is usually the first member of
+ * a larger structure holding its data, which 'run' casts the job to. The
+ * pool never allocates or frees a job; the owner has to keep it alive until
+ * it is done (see 'async_wait(...)'). 'run' is called on a thread of the
+ * pool, so it must not call the R API (which is single-threaded) nor use
+ * static data of the package that is not thread-safe.
+ * **************************************************************************/
+    int (*run)( Async_job* job ) ;
+    /* the work; its return value becomes 'status' */
+
+    int status ;
+    /* return value of 'run' or 'ASYNC_CANCELLED', valid once the job is
+     * done */
+
+    Async_state state ;
+    int cancel ;
+    Async_job* next ;
+    /* managed by the pool and read with the functions below; a new job has
+     * to be zero-initialised ('ASYNC_NEW') */
+} ;
+
+
+
+/* ***************************************************************************
+ * ***************************************************************************
+ * ** Public functions  ******************************************************
+ * ***************************************************************************
+ * **************************************************************************/
+
+int
+async_submit (
+/* ***************************************************************************
+ * The function 'int async_submit(...)' queues 'job' (with 'run' set) to be
+ * run by the pool. The pool is started on the first call and grows to
+ * 'workers' threads (at least 1) if more are requested later; jobs are run
+ * in the order they were submitted. The threads block all signals, so
+ * interrupts keep being delivered to the main thread, and they are not
+ * inherited by a forked child: jobs queued or running in the parent are
+ * marked done with the status 'ASYNC_CANCELLED' in the child. Returns
+ * 'ASYNC_OK' or 'ASYNC_ETHREAD' if no thread could be started.
+ * **************************************************************************/
+        Async_job* job ,
+        size_t workers
+        ) ;
+
+
+int
+async_done (
+/* ***************************************************************************
+ * Returns '1' if 'job' is done (or was never submitted), '0' otherwise.
+ * Does not block.
+ * **************************************************************************/
+        Async_job* job
+        ) ;
+
+
+void
+async_wait (
+/* ***************************************************************************
+ * Blocks until 'job' is done. Returns at once for a job that was never
+ * submitted.
+ * **************************************************************************/
+        Async_job* job
+        ) ;
+
+
+int
+async_wait_for (
+/* ***************************************************************************
+ * Blocks until 'job' is done or 'seconds' have passed, so that the caller
+ * can check for interrupts in between. Returns '1' if the job is done.
+ * **************************************************************************/
+        Async_job* job ,
+        double seconds
+        ) ;
+
+
+void
+async_cancel (
+/* ***************************************************************************
+ * Cancels 'job': a queued job is removed from the queue and done at once
+ * with the status 'ASYNC_CANCELLED', a running job sees the request with
+ * 'async_cancelled(...)' and may stop early. Does not block.
+ * **************************************************************************/
+        Async_job* job
+        ) ;
+
+
+int
+async_cancelled (
+/* ***************************************************************************
+ * Returns '1' if 'async_cancel(...)' was called for 'job'; to be polled by
+ * 'run'.
+ * **************************************************************************/
+        Async_job* job
+        ) ;
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  /* #ifndef ASYNC_H_ */
@@ -23,14 +23,27 @@
 
 #include "stdio.h"
 #include "stdlib.h"
+#include "string.h"
+#include "limits.h"
 
 #include "R.h"
 #include "Rinternals.h"
 #include "Rmath.h"
-#include "gsl/gsl_interp.h"
 #include "gsl/gsl_errno.h"
 
 #include "wendland.h"
+#include "grid_index.h"
+#include "stats.h"
+#include "planner.h"
+#include "store.h"
+#include "surface.h"
+#include "gwcovar.h"
+#include "sim.h"
+#include "vecchia.h"
+#include "sfc.h"
+#include "mem.h"
+#include "scratch.h"
+#include "async.h"
 
 /* ***********************************
  * ** PRIVATE DATA STRUCTURES ********
@@ -39,11 +52,670 @@
 static const R_CallMethodDef callMethods[] = {
    {"covar_m_dist", (DL_FUNC) &covar_m_dist, 8},
    {"covar_interpol", (DL_FUNC) &covar_interpol, 9},
-   {"covar_vector_dir", (DL_FUNC) &covar_vector_dir, 10},
-   {"covar_vector_interpol", (DL_FUNC) &covar_vector_interpol, 11},
+   {"covar_vector_dir", (DL_FUNC) &covar_vector_dir, 11},
+   {"covar_vector_interpol", (DL_FUNC) &covar_vector_interpol, 12},
+   {"covar_vector_dir_fill", (DL_FUNC) &covar_vector_dir_fill, 12},
+   {"covar_vector_interpol_fill", (DL_FUNC) &covar_vector_interpol_fill, 13},
+   {"covar_append", (DL_FUNC) &covar_append, 10},
+   {"covar_vector_auto", (DL_FUNC) &covar_vector_auto, 10},
+   {"covar_stats_enable", (DL_FUNC) &covar_stats_enable, 1},
+   {"covar_stats_get", (DL_FUNC) &covar_stats_get, 1},
+   {"covar_store_open", (DL_FUNC) &covar_store_open, 2},
+   {"covar_store_info", (DL_FUNC) &covar_store_info, 0},
+   {"covar_sim", (DL_FUNC) &covar_sim, 9},
+   {"covar_vecchia", (DL_FUNC) &covar_vecchia, 12},
+   {"covar_vector_compact", (DL_FUNC) &covar_vector_compact, 13},
+   {"covar_progress_set", (DL_FUNC) &covar_progress_set, 2},
+   {"covar_coords", (DL_FUNC) &covar_coords, 10},
+   {"covar_sfc_order", (DL_FUNC) &covar_sfc_order, 2},
+   {"covar_multi", (DL_FUNC) &covar_multi, 9},
+   {"covar_dense", (DL_FUNC) &covar_dense, 13},
+   {"covar_ext_matvec", (DL_FUNC) &covar_ext_matvec, 3},
+   {"covar_ext_get", (DL_FUNC) &covar_ext_get, 1},
+   {"covar_scratch_get", (DL_FUNC) &covar_scratch_get, 2},
+   {"covar_block", (DL_FUNC) &covar_block, 15},
+   {"covar_surface_build", (DL_FUNC) &covar_surface_build, 7},
+   {"covar_surface_open", (DL_FUNC) &covar_surface_open, 1},
+   {"covar_surface_info", (DL_FUNC) &covar_surface_info, 0},
+   {"covar_async_start", (DL_FUNC) &covar_async_start, 11},
+   {"covar_async_done", (DL_FUNC) &covar_async_done, 1},
+   {"covar_async_get", (DL_FUNC) &covar_async_get, 1},
    {NULL, NULL, 0}
 };
 
+typedef struct {
+    /* state shared with 'append_visit(...)' while the new rows of the
+     * covariance matrix are collected */
+    const Gw_params* params ;
+    size_t row ;        /* index of the new location that is queried */
+    int fill ;          /* 0: count the entries, 1: store them */
+    size_t pos ;        /* next free position in the output */
+    int* p_i ;          /* row indices (1-based) */
+    int* p_j ;          /* column indices (1-based) */
+    double* p_x ;       /* covariance values */
+    int error ;         /* set if the integration failed */
+} Append_ctx ;
+
+typedef struct {
+    /* dense covariance matrix outside of the R heap, see
+     * 'covar_dense(...)' */
+    Mem_block block ;
+    size_t n ;          /* number of rows and columns */
+} Ext_matrix ;
+
+typedef struct {
+    /* covariances calculated on a thread of the pool of 'async.c', see
+     * 'covar_async_start(...)'. Only 'async_run(...)' touches it while the
+     * job is queued or running; it never calls the R API. */
+    Async_job job ;     /* first member, see 'async.h' */
+    Gw_kernel* kernel ; /* taken from the surface or the store, or created
+                         * by the job */
+    int computed ;      /* '1' if the job calculated the table itself */
+    int stored ;        /* '1' once the table is in the store */
+    Gw_params params ;
+    size_t n_interpol ;
+    size_t chunk ;      /* values between two checks for cancellation */
+    const double* dist ;
+    double* out ;       /* both in R vectors protected by the handle */
+    size_t nrow ;
+    size_t ncol ;       /* 0 for a vector of 'nrow' distances */
+    int gsl_error ;
+} Covar_async ;
+
+static Covar_stats covar_stats = { 0 } ;
+/* statistics collected by all entry points, see 'covar_stats_get(...)' */
+
+static Scratch covar_scratch = { { NULL }, NULL, 0, 0, 0, 0, 0 } ;
+/* pool for the scratch buffers of all calculations, so that repeated calls
+ * reuse their buffers */
+
+static Gw_store covar_store = { NULL, 0, NULL, 0, 0, 0 } ;
+/* table store used for the interpolation tables, see 'covar_store_open(...)'
+ * */
+
+static Gw_surface covar_surface = { NULL, 0 } ;
+/* surface from which the interpolation tables are interpolated, see
+ * 'covar_surface_open(...)' */
+
+static SEXP covar_progress_fun = NULL ;
+static size_t covar_chunk = 65536 ;
+static int covar_progress_active = 0 ;
+/* R function called with the progress and number of values calculated
+ * between two checks for a user interrupt, see 'covar_progress_set(...)';
+ * 'covar_progress_active' is set while the function runs */
+
+
+/* ***********************************
+ * ** PRIVATE FUNCTIONS  *************
+ * **********************************/
+
+static void
+report_error (
+        int status ,
+        int gsl_error
+        )
+/* prints an error message for a return code of 'gwcovar.h' */
+{
+    if ( status == GW_EINTEG ) {
+
+        REprintf(
+                "%s\n%s%s\n",
+                "Error occured during numerical integration",
+                "GSL Error: ",
+                gsl_strerror( gsl_error )
+               ) ;
+    } else if ( status == GW_EBETA ) {
+
+        REprintf(
+                "%s\n%s%s\n",
+                "Error occured while calculating the beta function",
+                "GSL Error: ",
+                gsl_strerror( gsl_error )
+               ) ;
+    } else if ( status != GW_OK ) {
+
+        REprintf( "Error: %s\n", gw_strerror( status ) ) ;
+    }
+}
+
+static int
+check_wendland_errors (
+        Wendland_result* result
+        )
+/* returns '1' if both 'result.error' and 'result.error_b' are '0'. Otherwise
+ * an error message is printed and '0' is returned. */
+{
+    if ( result->error != 0 ) {
+
+        report_error( GW_EINTEG, result->error ) ;
+    }
+    if ( result->error_b != 0 ) {
+
+        report_error( GW_EBETA, result->error_b ) ;
+    }
+    return wendland_error( result ) == 0 ;
+}
+
+static int
+check_result (
+        Wendland_result* result
+        )
+/* records 'result' in the statistics (if enabled) and checks it for errors
+ * with 'check_wendland_errors(...)' */
+{
+    if ( covar_stats.enabled ) {
+
+        stats_record( &covar_stats, result ) ;
+    }
+    return check_wendland_errors( result ) ;
+}
+
+static double
+stats_start (
+        void
+        )
+/* counts a call of an entry point and returns the current time, if the
+ * statistics are enabled */
+{
+    if ( !covar_stats.enabled ) {
+
+        return 0 ;
+    }
+    covar_stats.calls++ ;
+    return stats_clock() ;
+}
+
+static double
+stats_lap (
+        Stats_phase phase ,
+        double t0
+        )
+/* attributes the time since 't0' to 'phase' and returns the current time */
+{
+    if ( !covar_stats.enabled ) {
+
+        return 0 ;
+    }
+    double t1 = stats_clock() ;
+    covar_stats.time[phase] += t1 - t0 ;
+    return t1 ;
+}
+
+static int
+surface_usable (
+        const Gw_params* params
+        )
+/* '1' if the open surface covers the parameters and its estimated error
+ * does not exceed the absolute tolerance requested for the integration,
+ * which is what the integration itself allows for the smallest values */
+{
+    return surface_covers( &covar_surface, params->mu, params->smoothness )
+        && covar_surface.map->error <= params->abstol ;
+}
+
+static int
+interpol_kernel (
+        Gw_kernel** kernel ,
+        const Gw_params* params ,
+        size_t n
+        )
+/* kernel with an interpolation table of 'n' points: interpolated from the
+ * surface if it covers the parameters and is accurate enough (with the size
+ * of the surface, see 'surface_usable(...)'), copied
+ * from the table store if it contains the table, calculated (and added to
+ * the store) otherwise. The kernel owns its table in any case, so it stays
+ * valid whatever happens to the store. Returns '1' on success and '0' on
+ * error. */
+{
+    int gsl_error = 0 ;
+    int ret ;
+    if ( surface_usable( params ) ) {
+
+        size_t n_r = (size_t) covar_surface.map->n_r ;
+        double* table = scratch_alloc( n_r * sizeof(double) ) ;
+        if ( table == NULL ) {
+
+            report_error( GW_ENOMEM, 0 ) ;
+            return 0 ;
+        }
+        surface_values( &covar_surface, params->mu, params->smoothness,
+                table ) ;
+        covar_stats.cache_hits += covar_stats.enabled ;
+        ret = gw_kernel_adopt( kernel, params, n_r, table ) ;
+        report_error( ret, gsl_error ) ;
+        return ret == GW_OK ;
+    }
+
+    const double* values = store_lookup( &covar_store, params->mu,
+            params->smoothness, params->abstol, params->reltol, n ) ;
+    if ( values != NULL ) {
+        /* copied, since a later lookup or addition may remap the store
+         * while the kernel is still used */
+
+        double* table = scratch_alloc( n * sizeof(double) ) ;
+        if ( table == NULL ) {
+
+            report_error( GW_ENOMEM, 0 ) ;
+            return 0 ;
+        }
+        memcpy( table, values, n * sizeof(double) ) ;
+        covar_stats.cache_hits += covar_stats.enabled ;
+        ret = gw_kernel_adopt( kernel, params, n, table ) ;
+        report_error( ret, gsl_error ) ;
+        return ret == GW_OK ;
+    }
+    if ( covar_store.path != NULL ) {
+
+        covar_stats.cache_misses += covar_stats.enabled ;
+    }
+
+    ret = gw_kernel_new( kernel, params, n, &covar_stats, &gsl_error ) ;
+    if ( ret != GW_OK ) {
+
+        report_error( ret, gsl_error ) ;
+        return 0 ;
+    }
+    if ( covar_store.writable ) {
+
+        values = gw_kernel_table( *kernel, &n ) ;
+        ret = store_add( &covar_store, params->mu, params->smoothness,
+                params->abstol, params->reltol, n, values ) ;
+        if ( ret != STORE_OK ) {
+            /* the table can still be used */
+
+            REprintf( "Table could not be added to '%s': %s\n",
+                    covar_store.path, store_strerror( ret ) ) ;
+        }
+    }
+    return 1 ;
+}
+
+static const double*
+plan_lookup (
+        void* ctx ,
+        const Gw_params* params ,
+        size_t n
+        )
+/* 'lookup' of the 'Plan_cache' of 'covar_vector_auto(...)': tables of the
+ * table store */
+{
+    (void) ctx ;
+    return store_lookup( &covar_store, params->mu, params->smoothness,
+            params->abstol, params->reltol, n ) ;
+}
+
+static void
+plan_add (
+        void* ctx ,
+        const Gw_params* params ,
+        size_t n ,
+        const double* values
+        )
+/* 'add' of the 'Plan_cache' of 'covar_vector_auto(...)': adds the table to
+ * the store if it is writable */
+{
+    (void) ctx ;
+    if ( !covar_store.writable ) {
+
+        return ;
+    }
+    int ret = store_add( &covar_store, params->mu, params->smoothness,
+            params->abstol, params->reltol, n, values ) ;
+    if ( ret != STORE_OK ) {
+        /* the table can still be used */
+
+        REprintf( "Table could not be added to '%s': %s\n",
+                covar_store.path, store_strerror( ret ) ) ;
+    }
+}
+
+static void
+check_interrupt_fn (
+        void* dummy
+        )
+/* helper of 'check_interrupt(...)' */
+{
+    (void) dummy ;
+    R_CheckUserInterrupt() ;
+}
+
+static int
+check_interrupt (
+        void
+        )
+/* '1' if the user wants to interrupt the calculation. The interrupt is
+ * caught by 'R_ToplevelExec(...)', so the caller can release its memory
+ * before returning. */
+{
+    return R_ToplevelExec( check_interrupt_fn, NULL ) == FALSE ;
+}
+
+static int
+covar_progress (
+        size_t done ,
+        size_t total ,
+        void* ctx
+        )
+/* progress callback of the kernels (see 'gw_kernel_progress(...)'): checks
+ * for a user interrupt and calls the R function set with
+ * 'covar_progress_set(...)'. Returns '1' to cancel the calculation, if the
+ * user interrupted, the R function failed or it returned 'FALSE'. The R
+ * function may call the package again (the running kernel owns its memory,
+ * see 'interpol_kernel(...)'), but calculations started from it do not call
+ * it themselves. */
+{
+    (void) ctx ;
+    if ( check_interrupt() ) {
+
+        return 1 ;
+    }
+    if ( covar_progress_fun == NULL || covar_progress_active ) {
+
+        return 0 ;
+    }
+    SEXP CALL, DONE, TOTAL ;
+    PROTECT( DONE = ScalarReal( (double) done ) ) ;
+    PROTECT( TOTAL = ScalarReal( (double) total ) ) ;
+    PROTECT( CALL = lang3( covar_progress_fun, DONE, TOTAL ) ) ;
+    int error = 0 ;
+    covar_progress_active = 1 ;
+    SEXP VALUE = R_tryEval( CALL, R_GlobalEnv, &error ) ;
+    covar_progress_active = 0 ;
+    int cancel = error || ( isLogical( VALUE ) && LENGTH( VALUE ) == 1
+            && LOGICAL( VALUE )[0] == FALSE ) ;
+    UNPROTECT(3) ; /* DONE, TOTAL, CALL */
+    return cancel ;
+}
+
+static Gw_kernel*
+kernel_progress (
+        Gw_kernel* kernel
+        )
+/* lets 'kernel' check for interrupts and report its progress */
+{
+    gw_kernel_progress( kernel, covar_progress, NULL, covar_chunk ) ;
+    return kernel ;
+}
+
+static int
+spam32_indices (
+        SEXP COLINDICES ,
+        SEXP ROWPOINTERS
+        )
+/* '1' if the index vectors of a spam matrix are 32-bit integers; for other
+ * types (e.g. spam64 with double indices) a message is printed and '0' is
+ * returned */
+{
+    if ( TYPEOF( COLINDICES ) != INTSXP || TYPEOF( ROWPOINTERS ) != INTSXP ) {
+
+        REprintf( "%s\n", "Only spam matrices with 32-bit indices are "
+                "supported here (not spam64)" ) ;
+        return 0 ;
+    }
+    return 1 ;
+}
+
+static R_xlen_t
+length_arg (
+        SEXP LENGTH ,
+        SEXP DIST
+        )
+/* the length passed from R, which is an integer or, for long vectors, a
+ * double; returns -1 (with a message) if it exceeds the length of 'DIST' */
+{
+    double length = asReal( LENGTH ) ;
+    if ( !( length >= 0 ) || length > (double) XLENGTH( DIST ) ) {
+
+        REprintf( "%s\n", "'LENGTH' exceeds the length of the distances" ) ;
+        return -1 ;
+    }
+    return (R_xlen_t) length ;
+}
+
+static void
+ext_finalize (
+        SEXP PTR
+        )
+/* finalizer of the external pointers returned by 'covar_dense(...)' */
+{
+    Ext_matrix* ext = R_ExternalPtrAddr( PTR ) ;
+    if ( ext != NULL ) {
+
+        mem_free( &ext->block ) ;
+        free( ext ) ;
+        R_ClearExternalPtr( PTR ) ;
+    }
+}
+
+static Ext_matrix*
+ext_matrix (
+        SEXP PTR
+        )
+/* matrix of an external pointer from 'covar_dense(...)' or 'NULL' (with a
+ * message) */
+{
+    Ext_matrix* ext = TYPEOF( PTR ) == EXTPTRSXP
+        && R_ExternalPtrTag( PTR ) == install( "covar_dense" )
+        ? R_ExternalPtrAddr( PTR ) : NULL ;
+    if ( ext == NULL ) {
+
+        REprintf( "%s\n", "Invalid or released external matrix" ) ;
+    }
+    return ext ;
+}
+
+static int
+async_progress (
+        size_t done ,
+        size_t total ,
+        void* ctx
+        )
+/* progress callback of the kernel of an asynchronous job: cancels the
+ * calculation if the handle was released */
+{
+    (void) done ;
+    (void) total ;
+    return async_cancelled( &((Covar_async*) ctx)->job ) ;
+}
+
+static int
+async_run (
+        Async_job* job
+        )
+/* calculates the covariances of a 'Covar_async' on a thread of the pool;
+ * the kernel is created here unless it was taken from the surface or the
+ * store, without statistics since they are not thread-safe */
+{
+    Covar_async* a = (Covar_async*) job ;
+    int ret = GW_OK ;
+    if ( a->kernel == NULL ) {
+
+        ret = gw_kernel_new( &a->kernel, &a->params, a->n_interpol, NULL,
+                &a->gsl_error ) ;
+        a->computed = ret == GW_OK && a->n_interpol > 0 ;
+    }
+    if ( ret != GW_OK ) {
+
+        return ret ;
+    }
+    gw_kernel_progress( a->kernel, async_progress, a, a->chunk ) ;
+    if ( a->ncol > 0 ) {
+
+        return gw_eval_matrix( a->kernel, a->dist, a->out, a->nrow, a->ncol,
+                NULL, &a->gsl_error ) ;
+    }
+    return gw_eval( a->kernel, a->dist, a->out, a->nrow, NULL,
+            &a->gsl_error ) ;
+}
+
+static int
+async_kernel (
+        Covar_async* a
+        )
+/* takes the interpolation table of 'a' from the surface or the store on the
+ * main thread, where they may be used, as 'interpol_kernel(...)' does. The
+ * values of the store are copied since the store may be remapped before
+ * the job runs. Otherwise the kernel is left to the job. Returns 'GW_OK' or
+ * 'GW_ENOMEM'. */
+{
+    const Gw_params* params = &a->params ;
+    size_t n = 0 ;
+    const double* values = NULL ;
+    if ( a->n_interpol == 0 ) {
+
+        return GW_OK ;
+    }
+    if ( surface_usable( params ) ) {
+
+        n = (size_t) covar_surface.map->n_r ;
+    } else {
+
+        values = store_lookup( &covar_store, params->mu, params->smoothness,
+                params->abstol, params->reltol, a->n_interpol ) ;
+        if ( values == NULL ) {
+
+            covar_stats.cache_misses += covar_stats.enabled
+                && covar_store.path != NULL ;
+            return GW_OK ;
+        }
+        n = a->n_interpol ;
+    }
+
+    double* table = scratch_alloc( n * sizeof(double) ) ;
+    if ( table == NULL ) {
+
+        return GW_ENOMEM ;
+    }
+    if ( values != NULL ) {
+
+        memcpy( table, values, n * sizeof(double) ) ;
+        a->stored = 1 ;
+    } else {
+
+        surface_values( &covar_surface, params->mu, params->smoothness,
+                table ) ;
+    }
+    covar_stats.cache_hits += covar_stats.enabled ;
+    return gw_kernel_adopt( &a->kernel, params, n, table ) ;
+}
+
+static void
+async_finalize (
+        SEXP PTR
+        )
+/* finalizer of the handles returned by 'covar_async_start(...)': the job is
+ * cancelled and waited for, since it writes to memory of the handle */
+{
+    Covar_async* a = R_ExternalPtrAddr( PTR ) ;
+    if ( a != NULL ) {
+
+        async_cancel( &a->job ) ;
+        async_wait( &a->job ) ;
+        if ( a->kernel != NULL ) {
+
+            gw_kernel_free( a->kernel ) ;
+        }
+        free( a ) ;
+        R_ClearExternalPtr( PTR ) ;
+    }
+}
+
+static Covar_async*
+async_handle (
+        SEXP PTR
+        )
+/* job of a handle from 'covar_async_start(...)' or 'NULL' (with a
+ * message) */
+{
+    Covar_async* a = TYPEOF( PTR ) == EXTPTRSXP
+        && R_ExternalPtrTag( PTR ) == install( "covar_async" )
+        ? R_ExternalPtrAddr( PTR ) : NULL ;
+    if ( a == NULL ) {
+
+        REprintf( "%s\n", "Invalid or released asynchronous covariance" ) ;
+    }
+    return a ;
+}
+
+static int
+kernel_base (
+        Gw_kernel* kernel ,
+        SEXP BASE ,
+        int* gsl_error
+        )
+/* tapers 'kernel' with the base correlation function 'BASE' (type, range,
+ * smoothness) unless it is 'NULL' */
+{
+    if ( BASE == R_NilValue ) {
+
+        return GW_OK ;
+    }
+    Gw_base base = {
+        (int) REAL( BASE )[0], REAL( BASE )[1], REAL( BASE )[2]
+    } ;
+    return gw_kernel_base( kernel, &base, gsl_error ) ;
+}
+
+static int
+covar_value (
+        const Gw_params* params ,
+        double dist ,
+        double* value
+        )
+/* calculates the GW covariance for the distance 'dist' in the same way as
+ * 'covar_vector_dir(...)'. Returns '1' on success and '0' on error. */
+{
+    if ( dist < params->eps ) {
+
+        *value = params->sill + params->nugget ;
+        return 1 ;
+    }
+    if ( dist >= params->rnge ) {
+
+        *value = 0 ;
+        return 1 ;
+    }
+
+    Wendland_result result ;
+    wendland( &result, dist / params->rnge, params->mu, params->smoothness,
+            params->abstol, params->reltol ) ;
+    if ( check_result( &result ) ) {
+
+        *value = params->sill * result.result ;
+        return 1 ;
+    }
+    return 0 ;
+}
+
+static void
+append_visit (
+        size_t index ,
+        double dist ,
+        void* p_ctx
+        )
+/* callback for 'grid_index_query(...)' used by 'covar_append(...)' */
+{
+    Append_ctx* ctx = (Append_ctx*) p_ctx ;
+
+    if ( ctx->error ) {
+
+        return ;
+    }
+    if ( ctx->fill ) {
+
+        double value ;
+        if ( !covar_value( ctx->params, dist, &value ) ) {
+
+            ctx->error = 1 ;
+            return ;
+        }
+        ctx->p_i[ctx->pos] = (int) ctx->row + 1 ;
+        ctx->p_j[ctx->pos] = (int) index + 1 ;
+        ctx->p_x[ctx->pos] = value ;
+    }
+    ctx->pos++ ;
+}
+
 
 /* ***********************************
  * ** PUBLIC FUNCTIONS  **************
@@ -64,6 +736,7 @@ R_init_covar(
             ) ;
     R_useDynamicSymbols( info, 0 ) ;
     R_forceSymbols( info, 1 ) ;
+    scratch_use( &covar_scratch ) ;
 }
 
     
@@ -79,279 +752,1643 @@ covar_m_dist (
         SEXP ABSTOL,     /* absolute tolerance for integration */
         SEXP RELTOL      /* relative tolerance for integration */
         )
-/* **************************************************************************** 
- * The function 'SEXP covar_m_dist(...)' returns the Generalized Wendland
- * (GW) covariance matrix based on a distance matrix in standard R matrix
- * format.  The values of the covariance function are calculated using  
- * non-addaptive Gauss-Kronrod integration.
- * ***************************************************************************/
+/* **************************************************************************** 
+ * The function 'SEXP covar_m_dist(...)' returns the Generalized Wendland
+ * (GW) covariance matrix based on a distance matrix in standard R matrix
+ * format.  The values of the covariance function are calculated using  
+ * non-addaptive Gauss-Kronrod integration.
+ * ***************************************************************************/
+{
+    /* create local representatives for the SEXPs */
+    int* p_dim = INTEGER(getAttrib( DIST, R_DimSymbol )) ;
+    Gw_params params = {
+        *REAL( MU ), *REAL( SMOOTHNESS ), *REAL( SILL ), *REAL( RNGE ),
+        *REAL( NUGGET ), *REAL( ABSTOL ), *REAL( RELTOL ), 0
+    } ;
+
+    /* allocate return object */
+    SEXP RESULT ;
+    PROTECT( 
+            RESULT = allocMatrix( REALSXP, *p_dim, *(p_dim+1) ) 
+           ) ; 
+
+    double t0 = stats_start() ;
+    Gw_kernel* kernel ;
+    int gsl_error = 0 ;
+    int ret = gw_kernel_new( &kernel, &params, 0, &covar_stats, &gsl_error ) ;
+    if ( ret == GW_OK ) {
+
+        ret = gw_eval_matrix( kernel_progress( kernel ), REAL( DIST ),
+                REAL( RESULT ), p_dim[0], p_dim[1], &covar_stats,
+                &gsl_error ) ;
+        gw_kernel_free( kernel ) ;
+    }
+    if ( ret != GW_OK ) {
+
+        report_error( ret, gsl_error ) ;
+        UNPROTECT(1) ; /* RESULT */
+        return R_NilValue ;
+    }
+    stats_lap( STATS_KERNEL, t0 ) ;
+    UNPROTECT(1) ; /* RESULT */
+    return RESULT ;
+}
+
+
+
+
+SEXP 
+covar_interpol (
+        SEXP DIST ,     /* distance matrix */
+        SEXP MU ,       /* param. of GW correlation function */
+        SEXP SMOOTHNESS,/* param. of GW correlation function */
+        SEXP SILL ,     /* param. of GW correlation function */
+        SEXP RNGE ,     /* param. of GW correlation function */
+        SEXP NUGGET ,   /* param. of GW correlation function */
+        SEXP N ,        /* nbr. of points where fct is
+                         * evaluated for interpolation */ 
+        SEXP ABSTOL ,   /* rel. tolerance for integration */
+        SEXP RELTOL     /* abs. tolerance for integration */ 
+        )
+/* **************************************************************************** 
+ * The function 'SEXP covar_mat_interpol(...)' returns the Generalized Wendland
+ * (GW) covariance matrix based on a distance matrix in standard R matrix
+ * format.  The values of the covariance function are interpolated using cubic
+ * splines. For the calculation of the GW covariance function the
+ * non-addaptive Gauss-Kronrod algorithm is used.
+ * ***************************************************************************/
+{
+    /* create local representation for the SEXPs */
+    int* p_dim = INTEGER(getAttrib( DIST, R_DimSymbol )) ;
+    Gw_params params = {
+        *REAL( MU ), *REAL( SMOOTHNESS ), *REAL( SILL ), *REAL( RNGE ),
+        *REAL( NUGGET ), *REAL( ABSTOL ), *REAL( RELTOL ), 0
+    } ;
+    int n = *INTEGER( N ) ;
+
+    /* allocate return object */
+    SEXP RESULT ;
+    PROTECT( 
+            RESULT = allocMatrix( REALSXP, *p_dim, *(p_dim+1) )
+           ) ; 
+
+    double t0 = stats_start() ;
+    Gw_kernel* kernel ;
+    if ( n < 1 || !interpol_kernel( &kernel, &params, (size_t) n ) ) {
+
+        UNPROTECT(1) ; /* RESULT */
+        return R_NilValue ;
+    }
+    t0 = stats_lap( STATS_TABLE, t0 ) ;
+
+    int gsl_error = 0 ;
+    int ret = gw_eval_matrix( kernel_progress( kernel ), REAL( DIST ),
+            REAL( RESULT ), p_dim[0], p_dim[1], &covar_stats, &gsl_error ) ;
+    gw_kernel_free( kernel ) ;
+    if ( ret != GW_OK ) {
+
+        report_error( ret, gsl_error ) ;
+        UNPROTECT(1) ; /* RESULT */
+        return R_NilValue ;
+    }
+    stats_lap( STATS_OUTPUT, t0 ) ;
+    UNPROTECT(1) ; /* RESULT */
+    return RESULT ;
+}
+
+SEXP covar_vector_dir (
+        SEXP DIST ,         /* R vector containing distances */    
+        SEXP LENGTH ,       /* length of 'SEXP DIST' */ 
+        SEXP MU ,           /* param. of the GW covariance fct */
+        SEXP SMOOTHNESS ,   /* param. of the GW covariance fct */
+        SEXP SILL ,         /* param. of the GW covariance fct */
+        SEXP RNGE ,         /* param. of the GW covariance fct */
+        SEXP NUGGET ,       /* param. of the GW covariance fct */
+        SEXP ABSTOL ,       /* abs. tolerance for integration */
+        SEXP RELTOL ,       /* rel. tolerance for integration */
+        SEXP EPS ,          /* treshhold below which values are
+                             * considered 0 */
+        SEXP BASE           /* base correlation fct tapered or 'NULL' */
+       )
+/* ****************************************************************************
+ * The function 'int covar_vector_dir  (...)' calculates the Generalized
+ * Wendland (GW) covariance function for all values of the R  vector 'DIST'.
+ * If an error occures, the NULL pointer is returned.  The integral is
+ * calculated with the non-adaptive Gauss-Kronrod algorithm from the 'GNU
+ * Scientific Library'. 
+ * **************************************************************************/
+{
+    /* declare and allocate matrix that will be returned */
+    R_xlen_t length = length_arg( LENGTH, DIST ) ;
+    if ( length < 0 ) {
+
+        return R_NilValue ;
+    }
+    SEXP RESULT ;
+    PROTECT( 
+            RESULT = allocVector( REALSXP, length ) 
+           ) ;
+
+    if ( covar_vector_dir_fill( DIST, RESULT, LENGTH, MU, SMOOTHNESS, SILL,
+                RNGE, NUGGET, ABSTOL, RELTOL, EPS, BASE ) == R_NilValue ) {
+
+        UNPROTECT(1) ; /* RESULT */
+        return R_NilValue ;
+    }
+
+    UNPROTECT(1) ; /* RESULT */
+    return RESULT ;
+}
+
+SEXP covar_vector_dir_fill (
+        SEXP DIST ,         /* R vector containing distances */    
+        SEXP OUT ,          /* R vector the covariances are written to */
+        SEXP LENGTH ,       /* length of 'SEXP DIST' */ 
+        SEXP MU ,           /* param. of the GW covariance fct */
+        SEXP SMOOTHNESS ,   /* param. of the GW covariance fct */
+        SEXP SILL ,         /* param. of the GW covariance fct */
+        SEXP RNGE ,         /* param. of the GW covariance fct */
+        SEXP NUGGET ,       /* param. of the GW covariance fct */
+        SEXP ABSTOL ,       /* abs. tolerance for integration */
+        SEXP RELTOL ,       /* rel. tolerance for integration */
+        SEXP EPS ,          /* treshhold below which values are
+                             * considered 0 */
+        SEXP BASE           /* base correlation fct tapered or 'NULL' */
+       )
+/* ****************************************************************************
+ * The function 'SEXP covar_vector_dir_fill(...)' does the same as
+ * 'covar_vector_dir(...)', but writes the covariances into the existing
+ * vector 'OUT' instead of allocating a new one. 'OUT' may be 'DIST' itself.
+ * **************************************************************************/
+{
+    /* local representation for the SEXPs */
+    R_xlen_t length = length_arg( LENGTH, DIST ) ;
+    if ( length < 0 ) {
+
+        return R_NilValue ;
+    }
+    if ( XLENGTH( OUT ) < length ) {
+
+        REprintf( "%s\n", "'OUT' is shorter than the distances" ) ;
+        return R_NilValue ;
+    }
+    Gw_params params = {
+        *REAL( MU ), *REAL( SMOOTHNESS ), *REAL( SILL ), *REAL( RNGE ),
+        *REAL( NUGGET ), *REAL( ABSTOL ), *REAL( RELTOL ), *REAL( EPS )
+    } ;
+
+    double t0 = stats_start() ;
+    Gw_kernel* kernel ;
+    int gsl_error = 0 ;
+    int ret = gw_kernel_new( &kernel, &params, 0, &covar_stats, &gsl_error ) ;
+    if ( ret == GW_OK ) {
+
+        ret = kernel_base( kernel, BASE, &gsl_error ) ;
+    }
+    if ( ret == GW_OK ) {
+
+        ret = gw_eval( kernel_progress( kernel ), REAL( DIST ), REAL( OUT ),
+                (size_t) length, &covar_stats, &gsl_error ) ;
+    }
+    gw_kernel_free( kernel ) ;
+    if ( ret != GW_OK ) {
+
+        report_error( ret, gsl_error ) ;
+        return R_NilValue ;
+    }
+    stats_lap( STATS_KERNEL, t0 ) ;
+
+    return OUT ;
+}
+
+SEXP covar_vector_interpol (
+        SEXP DIST ,         /* R vector containing distances */    
+        SEXP LENGTH ,       /* length of 'SEXP DIST' */ 
+        SEXP MU ,           /* param. of the GW covariance fct */
+        SEXP SMOOTHNESS ,   /* param. of the GW covariance fct */
+        SEXP SILL ,         /* param. of the GW covariance fct */
+        SEXP RNGE ,         /* param. of the GW covariance fct */
+        SEXP NUGGET ,       /* param. of the GW covariance fct */
+        SEXP ABSTOL ,       /* abs. tolerance for integration */
+        SEXP RELTOL ,       /* rel. tolerance for integration */
+        SEXP EPS ,          /* treshhold below which values are
+                             * considered 0 */
+        SEXP NBR_INTERPOL , /* nbr. of interpolation points */
+        SEXP BASE           /* base correlation fct tapered or 'NULL' */
+        )
+/* *****************************************************************************
+ * The function 'int covar_vector_interpol  (...)' calculates the Generalized
+ * Wendland (GW) covariance function for all values of the R  vector 'DIST'.
+ * If an error occures, the NULL pointer is returned.  The integral is
+ * calculated with the non-adaptive Gauss-Kronrod algorithm from the 'GNU
+ * Scientific Library'. This function uses interpolation in order to speed
+ * up the calculation.
+  * **************************************************************************/
+{
+    /* declare and allocate matrix that will be returned */
+    R_xlen_t length = length_arg( LENGTH, DIST ) ;
+    if ( length < 0 ) {
+
+        return R_NilValue ;
+    }
+    SEXP RESULT ;
+    PROTECT( 
+            RESULT = allocVector( REALSXP, length ) 
+           ) ;
+
+    if ( covar_vector_interpol_fill( DIST, RESULT, LENGTH, MU, SMOOTHNESS,
+                SILL, RNGE, NUGGET, ABSTOL, RELTOL, EPS, NBR_INTERPOL, BASE )
+            == R_NilValue ) {
+
+        UNPROTECT(1) ; /* RESULT */
+        return R_NilValue ;
+    }
+
+    UNPROTECT(1) ; /* RESULT */
+    return RESULT ;
+}
+
+SEXP covar_vector_interpol_fill (
+        SEXP DIST ,         /* R vector containing distances */    
+        SEXP OUT ,          /* R vector the covariances are written to */
+        SEXP LENGTH ,       /* length of 'SEXP DIST' */ 
+        SEXP MU ,           /* param. of the GW covariance fct */
+        SEXP SMOOTHNESS ,   /* param. of the GW covariance fct */
+        SEXP SILL ,         /* param. of the GW covariance fct */
+        SEXP RNGE ,         /* param. of the GW covariance fct */
+        SEXP NUGGET ,       /* param. of the GW covariance fct */
+        SEXP ABSTOL ,       /* abs. tolerance for integration */
+        SEXP RELTOL ,       /* rel. tolerance for integration */
+        SEXP EPS ,          /* treshhold below which values are
+                             * considered 0 */
+        SEXP NBR_INTERPOL , /* nbr. of interpolation points */
+        SEXP BASE           /* base correlation fct tapered or 'NULL' */
+        )
+/* *****************************************************************************
+ * The function 'SEXP covar_vector_interpol_fill(...)' does the same as
+ * 'covar_vector_interpol(...)', but writes the covariances into the existing
+ * vector 'OUT' instead of allocating a new one. 'OUT' may be 'DIST' itself.
+  * **************************************************************************/
+{
+    /* local representation for the SEXPs */
+    R_xlen_t length = length_arg( LENGTH, DIST ) ;
+    if ( length < 0 ) {
+
+        return R_NilValue ;
+    }
+    if ( XLENGTH( OUT ) < length ) {
+
+        REprintf( "%s\n", "'OUT' is shorter than the distances" ) ;
+        return R_NilValue ;
+    }
+    Gw_params params = {
+        *REAL( MU ), *REAL( SMOOTHNESS ), *REAL( SILL ), *REAL( RNGE ),
+        *REAL( NUGGET ), *REAL( ABSTOL ), *REAL( RELTOL ), *REAL( EPS )
+    } ;
+    int n = *INTEGER( NBR_INTERPOL ) ;
+
+    double t0 = stats_start() ;
+    Gw_kernel* kernel ;
+    if ( n < 1 || !interpol_kernel( &kernel, &params, (size_t) n ) ) {
+
+        return R_NilValue ;
+    }
+    int gsl_error = 0 ;
+    int ret = kernel_base( kernel, BASE, &gsl_error ) ;
+    t0 = stats_lap( STATS_TABLE, t0 ) ;
+
+    if ( ret == GW_OK ) {
+
+        ret = gw_eval( kernel_progress( kernel ), REAL( DIST ), REAL( OUT ),
+                (size_t) length, &covar_stats, &gsl_error ) ;
+    }
+    gw_kernel_free( kernel ) ;
+    if ( ret != GW_OK ) {
+
+        report_error( ret, gsl_error ) ;
+        return R_NilValue ;
+    }
+    stats_lap( STATS_OUTPUT, t0 ) ;
+
+    return OUT ;
+}
+
+SEXP covar_append (
+        SEXP LOC_OLD ,      /* coordinates of the existing locations */
+        SEXP LOC_NEW ,      /* coordinates of the appended locations */
+        SEXP MU ,           /* param. of the GW covariance fct */
+        SEXP SMOOTHNESS ,   /* param. of the GW covariance fct */
+        SEXP SILL ,         /* param. of the GW covariance fct */
+        SEXP RNGE ,         /* param. of the GW covariance fct */
+        SEXP NUGGET ,       /* param. of the GW covariance fct */
+        SEXP ABSTOL ,       /* abs. tolerance for integration */
+        SEXP RELTOL ,       /* rel. tolerance for integration */
+        SEXP EPS            /* treshhold below which values are
+                             * considered 0 */
+        )
+/* ****************************************************************************
+ * The function 'SEXP covar_append(...)' calculates the entries of the GW
+ * covariance matrix that are added when the locations 'LOC_NEW' are appended
+ * to the locations 'LOC_OLD'. The locations within the range are found with a
+ * grid index, so only pairs closer than the range are evaluated.
+ * **************************************************************************/
+{
+    /* local representation for the SEXPs */
+    int* p_dim_old = INTEGER( getAttrib( LOC_OLD, R_DimSymbol ) ) ;
+    int* p_dim_new = INTEGER( getAttrib( LOC_NEW, R_DimSymbol ) ) ;
+    double* p_old = REAL( LOC_OLD ) ;
+    double* p_new = REAL( LOC_NEW ) ;
+    size_t n_old = (size_t) p_dim_old[0] ;
+    size_t n_new = (size_t) p_dim_new[0] ;
+    int dim = p_dim_new[1] ;
+    Gw_params params = {
+        *REAL( MU ), *REAL( SMOOTHNESS ), *REAL( SILL ), *REAL( RNGE ),
+        *REAL( NUGGET ), *REAL( ABSTOL ), *REAL( RELTOL ), *REAL( EPS )
+    } ;
+
+    if ( p_dim_old[1] != dim ) {
+
+        REprintf( "%s\n",
+                "The old and the new locations have different dimensions" ) ;
+        return R_NilValue ;
+    }
+    if ( n_old > INT_MAX || n_new > INT_MAX ) {
+        /* the indices are returned as 32-bit integers */
+
+        REprintf( "%s\n", "Too many locations for 32-bit indices" ) ;
+        return R_NilValue ;
+    }
+
+    Grid_index index_old ;
+    Grid_index index_new ;
+    if ( grid_index_build( &index_old, p_old, n_old, dim, params.rnge ) ) {
+
+        REprintf( "%s\n", "Could not allocate the grid index" ) ;
+        return R_NilValue ;
+    }
+    if ( grid_index_build( &index_new, p_new, n_new, dim, params.rnge ) ) {
+
+        grid_index_free( &index_old ) ;
+        REprintf( "%s\n", "Could not allocate the grid index" ) ;
+        return R_NilValue ;
+    }
+
+    /* first pass: count the entries */
+    Append_ctx cross = { &params, 0, 0, 0, NULL, NULL, NULL, 0 } ;
+    Append_ctx within = { &params, 0, 0, 0, NULL, NULL, NULL, 0 } ;
+    for ( size_t k = 0 ; k < n_new ; k++ ) {
+
+        cross.row = k ;
+        within.row = k ;
+        grid_index_query( &index_old, p_new + k, n_new, params.rnge,
+                append_visit, &cross ) ;
+        grid_index_query( &index_new, p_new + k, n_new, params.rnge,
+                append_visit, &within ) ;
+    }
+
+    /* allocate return object */
+    SEXP RESULT ;
+    SEXP NAMES ;
+    const char* names[] = {
+        "cross.i", "cross.j", "cross.values",
+        "within.i", "within.j", "within.values"
+    } ;
+    PROTECT( RESULT = allocVector( VECSXP, 6 ) ) ;
+    PROTECT( NAMES = allocVector( STRSXP, 6 ) ) ;
+    SET_VECTOR_ELT( RESULT, 0, allocVector( INTSXP, cross.pos ) ) ;
+    SET_VECTOR_ELT( RESULT, 1, allocVector( INTSXP, cross.pos ) ) ;
+    SET_VECTOR_ELT( RESULT, 2, allocVector( REALSXP, cross.pos ) ) ;
+    SET_VECTOR_ELT( RESULT, 3, allocVector( INTSXP, within.pos ) ) ;
+    SET_VECTOR_ELT( RESULT, 4, allocVector( INTSXP, within.pos ) ) ;
+    SET_VECTOR_ELT( RESULT, 5, allocVector( REALSXP, within.pos ) ) ;
+    for ( int k = 0 ; k < 6 ; k++ ) {
+
+        SET_STRING_ELT( NAMES, k, mkChar( names[k] ) ) ;
+    }
+    setAttrib( RESULT, R_NamesSymbol, NAMES ) ;
+
+    /* second pass: calculate the covariances */
+    cross.fill = 1 ;
+    cross.pos = 0 ;
+    cross.p_i = INTEGER( VECTOR_ELT( RESULT, 0 ) ) ;
+    cross.p_j = INTEGER( VECTOR_ELT( RESULT, 1 ) ) ;
+    cross.p_x = REAL( VECTOR_ELT( RESULT, 2 ) ) ;
+    within.fill = 1 ;
+    within.pos = 0 ;
+    within.p_i = INTEGER( VECTOR_ELT( RESULT, 3 ) ) ;
+    within.p_j = INTEGER( VECTOR_ELT( RESULT, 4 ) ) ;
+    within.p_x = REAL( VECTOR_ELT( RESULT, 5 ) ) ;
+
+    double t0 = stats_start() ;
+    gsl_set_error_handler_off() ;
+    int cancelled = 0 ;
+    size_t next = 0 ;
+    for ( size_t k = 0 ; k < n_new && !cross.error && !within.error ; k++ ) {
+
+        if ( cross.pos + within.pos >= next ) {
+            /* after about 'covar_chunk' values */
+
+            if ( k > 0 && covar_progress( k, n_new, NULL ) ) {
+
+                cancelled = 1 ;
+                break ;
+            }
+            next = cross.pos + within.pos + covar_chunk ;
+        }
+        cross.row = k ;
+        within.row = k ;
+        grid_index_query( &index_old, p_new + k, n_new, params.rnge,
+                append_visit, &cross ) ;
+        grid_index_query( &index_new, p_new + k, n_new, params.rnge,
+                append_visit, &within ) ;
+    }
+
+    stats_lap( STATS_KERNEL, t0 ) ;
+    grid_index_free( &index_old ) ;
+    grid_index_free( &index_new ) ;
+    UNPROTECT(2) ; /* RESULT, NAMES */
+
+    if ( cancelled ) {
+
+        report_error( GW_ECANCEL, 0 ) ;
+        return R_NilValue ;
+    }
+    if ( cross.error || within.error ) {
+
+        return R_NilValue ;
+    }
+    return RESULT ;
+}
+
+
+SEXP covar_stats_enable (
+        SEXP ENABLE         /* logical: enable the statistics */
+        )
+/* ****************************************************************************
+ * The function 'SEXP covar_stats_enable(...)' switches the collection of
+ * statistics on or off and returns the previous state.
+ * **************************************************************************/
+{
+    int previous = covar_stats.enabled ;
+    covar_stats.enabled = *LOGICAL( ENABLE ) ;
+    return ScalarLogical( previous ) ;
+}
+
+SEXP covar_stats_get (
+        SEXP RESET          /* logical: reset the statistics */
+        )
+/* ****************************************************************************
+ * The function 'SEXP covar_stats_get(...)' returns the statistics collected
+ * since the last reset as named R list.
+ * **************************************************************************/
+{
+    const char* names[] = {
+        "enabled", "calls", "quadratures", "evaluations", "mean.evaluations",
+        "abserr.histogram", "gsl.errors", "time", "cache"
+    } ;
+    const char* time_names[] = { "table", "kernel", "output" } ;
+    const char* cache_names[] = { "hits", "misses" } ;
+    const char* bin_names[STATS_ABSERR_BINS] = {
+        "<1e-15", "[1e-15,1e-14)", "[1e-14,1e-13)", "[1e-13,1e-12)",
+        "[1e-12,1e-11)", "[1e-11,1e-10)", "[1e-10,1e-09)", "[1e-09,1e-08)",
+        "[1e-08,1e-07)", "[1e-07,1e-06)", "[1e-06,1e-05)", "[1e-05,1e-04)",
+        "[1e-04,1e-03)", ">=1e-03"
+    } ;
+    SEXP RESULT, NAMES, HIST, HIST_NAMES, ERRORS, ERROR_NAMES, TIME,
+         TIME_NAMES, CACHE, CACHE_NAMES ;
+
+    PROTECT( RESULT = allocVector( VECSXP, 9 ) ) ;
+    PROTECT( NAMES = allocVector( STRSXP, 9 ) ) ;
+    for ( int k = 0 ; k < 9 ; k++ ) {
+
+        SET_STRING_ELT( NAMES, k, mkChar( names[k] ) ) ;
+    }
+    setAttrib( RESULT, R_NamesSymbol, NAMES ) ;
+
+    SET_VECTOR_ELT( RESULT, 0, ScalarLogical( covar_stats.enabled ) ) ;
+    SET_VECTOR_ELT( RESULT, 1, ScalarReal( (double) covar_stats.calls ) ) ;
+    SET_VECTOR_ELT( RESULT, 2,
+            ScalarReal( (double) covar_stats.quadratures ) ) ;
+    SET_VECTOR_ELT( RESULT, 3, ScalarReal( (double) covar_stats.neval ) ) ;
+    SET_VECTOR_ELT( RESULT, 4, ScalarReal( covar_stats.quadratures > 0 ?
+                (double) covar_stats.neval / covar_stats.quadratures : 0 ) ) ;
+
+    /* histogram of the integration errors */
+    PROTECT( HIST = allocVector( REALSXP, STATS_ABSERR_BINS ) ) ;
+    PROTECT( HIST_NAMES = allocVector( STRSXP, STATS_ABSERR_BINS ) ) ;
+    for ( int k = 0 ; k < STATS_ABSERR_BINS ; k++ ) {
+
+        REAL(HIST)[k] = (double) covar_stats.abserr_hist[k] ;
+        SET_STRING_ELT( HIST_NAMES, k, mkChar( bin_names[k] ) ) ;
+    }
+    setAttrib( HIST, R_NamesSymbol, HIST_NAMES ) ;
+    SET_VECTOR_ELT( RESULT, 5, HIST ) ;
+
+    /* GSL errors, only the codes that occured */
+    int n_errors = 0 ;
+    for ( int k = 0 ; k < STATS_MAX_ERRNO ; k++ ) {
+
+        n_errors += covar_stats.errors[k] > 0 ;
+    }
+    PROTECT( ERRORS = allocVector( REALSXP, n_errors ) ) ;
+    PROTECT( ERROR_NAMES = allocVector( STRSXP, n_errors ) ) ;
+    for ( int k = 0, pos = 0 ; k < STATS_MAX_ERRNO ; k++ ) {
+
+        if ( covar_stats.errors[k] > 0 ) {
+
+            REAL(ERRORS)[pos] = (double) covar_stats.errors[k] ;
+            SET_STRING_ELT( ERROR_NAMES, pos, mkChar( gsl_strerror( k ) ) ) ;
+            pos++ ;
+        }
+    }
+    setAttrib( ERRORS, R_NamesSymbol, ERROR_NAMES ) ;
+    SET_VECTOR_ELT( RESULT, 6, ERRORS ) ;
+
+    /* wall time per phase */
+    PROTECT( TIME = allocVector( REALSXP, 3 ) ) ;
+    PROTECT( TIME_NAMES = allocVector( STRSXP, 3 ) ) ;
+    for ( int k = 0 ; k < 3 ; k++ ) {
+
+        REAL(TIME)[k] = covar_stats.time[k] ;
+        SET_STRING_ELT( TIME_NAMES, k, mkChar( time_names[k] ) ) ;
+    }
+    setAttrib( TIME, R_NamesSymbol, TIME_NAMES ) ;
+    SET_VECTOR_ELT( RESULT, 7, TIME ) ;
+
+    /* table cache */
+    PROTECT( CACHE = allocVector( REALSXP, 2 ) ) ;
+    PROTECT( CACHE_NAMES = allocVector( STRSXP, 2 ) ) ;
+    REAL(CACHE)[0] = (double) covar_stats.cache_hits ;
+    REAL(CACHE)[1] = (double) covar_stats.cache_misses ;
+    for ( int k = 0 ; k < 2 ; k++ ) {
+
+        SET_STRING_ELT( CACHE_NAMES, k, mkChar( cache_names[k] ) ) ;
+    }
+    setAttrib( CACHE, R_NamesSymbol, CACHE_NAMES ) ;
+    SET_VECTOR_ELT( RESULT, 8, CACHE ) ;
+
+    if ( *LOGICAL( RESET ) ) {
+
+        stats_reset( &covar_stats ) ;
+    }
+
+    UNPROTECT(10) ;
+    return RESULT ;
+}
+
+
+SEXP covar_vector_auto (
+        SEXP DIST ,         /* R vector containing distances */
+        SEXP OUT ,          /* R vector for the result or 'NULL' */
+        SEXP MU ,           /* param. of the GW covariance fct */
+        SEXP SMOOTHNESS ,   /* param. of the GW covariance fct */
+        SEXP SILL ,         /* param. of the GW covariance fct */
+        SEXP RNGE ,         /* param. of the GW covariance fct */
+        SEXP NUGGET ,       /* param. of the GW covariance fct */
+        SEXP ABSTOL ,       /* abs. tolerance for integration */
+        SEXP RELTOL ,       /* rel. tolerance for integration */
+        SEXP EPS            /* treshhold below which values are
+                             * considered 0 */
+        )
+/* ****************************************************************************
+ * The function 'SEXP covar_vector_auto(...)' calculates the GW covariance
+ * function for all values of 'DIST' with the strategy chosen by
+ * 'plan_fill(...)' and returns them together with a description of the
+ * plan.
+ * **************************************************************************/
+{
+    R_xlen_t length = XLENGTH( DIST ) ;
+    Gw_params params = {
+        *REAL( MU ), *REAL( SMOOTHNESS ), *REAL( SILL ), *REAL( RNGE ),
+        *REAL( NUGGET ), *REAL( ABSTOL ), *REAL( RELTOL ), *REAL( EPS )
+    } ;
+
+    if ( OUT != R_NilValue
+            && ( TYPEOF( OUT ) != REALSXP || XLENGTH( OUT ) < length ) ) {
+
+        REprintf( "%s\n", "'OUT' is not a double vector as long as the "
+                "distances" ) ;
+        return R_NilValue ;
+    }
+
+    SEXP RESULT ;
+    if ( OUT == R_NilValue ) {
+
+        PROTECT( RESULT = allocVector( REALSXP, length ) ) ;
+    } else {
+
+        PROTECT( RESULT = OUT ) ;
+    }
+
+    /* tables are reused from the table store, if one is open */
+    Plan_cache cache = { plan_lookup, plan_add, NULL } ;
+    stats_start() ;
+    Plan plan ;
+    int ret = plan_fill( &plan, REAL( DIST ), REAL( RESULT ), (size_t) length,
+            &params, covar_store.path != NULL ? &cache : NULL,
+            &covar_stats ) ;
+    if ( ret != GW_OK ) {
+
+        report_error( ret, plan.gsl_error ) ;
+        UNPROTECT(1) ; /* RESULT */
+        return R_NilValue ;
+    }
+
+    /* description of the plan, returned beside the values so that a vector
+     * 'OUT' of the caller is not given an attribute */
+    SEXP VALUE, PLAN, NAMES ;
+    const char* names[] = {
+        "strategy", "reason", "entries", "unique", "n.interpol",
+        "table.error"
+    } ;
+    PROTECT( PLAN = allocVector( VECSXP, 6 ) ) ;
+    PROTECT( NAMES = allocVector( STRSXP, 6 ) ) ;
+    for ( int k = 0 ; k < 6 ; k++ ) {
+
+        SET_STRING_ELT( NAMES, k, mkChar( names[k] ) ) ;
+    }
+    setAttrib( PLAN, R_NamesSymbol, NAMES ) ;
+    SET_VECTOR_ELT( PLAN, 0, mkString( plan_strategy_name( plan.strategy ) ) ) ;
+    SET_VECTOR_ELT( PLAN, 1, mkString( plan.reason ) ) ;
+    SET_VECTOR_ELT( PLAN, 2, ScalarReal( (double) plan.entries ) ) ;
+    SET_VECTOR_ELT( PLAN, 3, ScalarReal( (double) plan.unique ) ) ;
+    SET_VECTOR_ELT( PLAN, 4, ScalarReal( (double) plan.n_interpol ) ) ;
+    SET_VECTOR_ELT( PLAN, 5, ScalarReal( plan.table_error ) ) ;
+
+    PROTECT( VALUE = allocVector( VECSXP, 2 ) ) ;
+    SET_VECTOR_ELT( VALUE, 0, RESULT ) ;
+    SET_VECTOR_ELT( VALUE, 1, PLAN ) ;
+
+    UNPROTECT(4) ; /* RESULT, PLAN, NAMES, VALUE */
+    return VALUE ;
+}
+
+
+SEXP covar_store_open (
+        SEXP PATH ,         /* path of the store file or 'NULL' */
+        SEXP WRITABLE       /* logical: add new tables to the file */
+        )
+/* ****************************************************************************
+ * The function 'SEXP covar_store_open(...)' closes the current table store
+ * and opens the one at 'PATH' (if not 'NULL'). Returns the same as
+ * 'covar_store_info()' or 'NULL' on error.
+ * **************************************************************************/
+{
+    store_close( &covar_store ) ;
+    if ( PATH != R_NilValue ) {
+
+        int ret = store_open( &covar_store,
+                translateCharFS( STRING_ELT( PATH, 0 ) ),
+                *LOGICAL( WRITABLE ) ) ;
+        if ( ret != STORE_OK ) {
+
+            REprintf( "Table store could not be opened: %s\n",
+                    store_strerror( ret ) ) ;
+            return R_NilValue ;
+        }
+    }
+    return covar_store_info() ;
+}
+
+SEXP covar_store_info (
+        void
+        )
+/* ****************************************************************************
+ * The function 'SEXP covar_store_info(...)' describes the open table store as
+ * named R list.
+ * **************************************************************************/
+{
+    const char* names[] = {
+        "path", "writable", "tables", "bytes", "version"
+    } ;
+    SEXP INFO, NAMES ;
+    PROTECT( INFO = allocVector( VECSXP, 5 ) ) ;
+    PROTECT( NAMES = allocVector( STRSXP, 5 ) ) ;
+    for ( int k = 0 ; k < 5 ; k++ ) {
+
+        SET_STRING_ELT( NAMES, k, mkChar( names[k] ) ) ;
+    }
+    setAttrib( INFO, R_NamesSymbol, NAMES ) ;
+
+    if ( covar_store.path != NULL ) {
+
+        SET_VECTOR_ELT( INFO, 0, mkString( covar_store.path ) ) ;
+    } else {
+
+        SET_VECTOR_ELT( INFO, 0, ScalarString( NA_STRING ) ) ;
+    }
+    SET_VECTOR_ELT( INFO, 1, ScalarLogical( covar_store.writable ) ) ;
+    SET_VECTOR_ELT( INFO, 2, ScalarReal( (double) store_count( &covar_store ) ) ) ;
+    SET_VECTOR_ELT( INFO, 3, ScalarReal( (double) covar_store.size ) ) ;
+    SET_VECTOR_ELT( INFO, 4, ScalarInteger( STORE_VERSION ) ) ;
+
+    UNPROTECT(2) ; /* INFO, NAMES */
+    return INFO ;
+}
+
+
+SEXP covar_surface_info (
+        void
+        )
+/* ****************************************************************************
+ * The function 'SEXP covar_surface_info(...)' describes the open surface as
+ * named R list.
+ * **************************************************************************/
+{
+    const char* names[] = {
+        "open", "n", "mu", "kappa", "abstol", "reltol", "error"
+    } ;
+    SEXP INFO, NAMES ;
+    PROTECT( INFO = allocVector( VECSXP, 7 ) ) ;
+    PROTECT( NAMES = allocVector( STRSXP, 7 ) ) ;
+    for ( int k = 0 ; k < 7 ; k++ ) {
+
+        SET_STRING_ELT( NAMES, k, mkChar( names[k] ) ) ;
+    }
+    setAttrib( INFO, R_NamesSymbol, NAMES ) ;
+
+    const Surface_header* header = covar_surface.map ;
+    SET_VECTOR_ELT( INFO, 0, ScalarLogical( header != NULL ) ) ;
+    if ( header != NULL ) {
+
+        SEXP N, MU, KAPPA ;
+        PROTECT( N = allocVector( REALSXP, 3 ) ) ;
+        PROTECT( MU = allocVector( REALSXP, 2 ) ) ;
+        PROTECT( KAPPA = allocVector( REALSXP, 2 ) ) ;
+        REAL( N )[0] = (double) header->n_r ;
+        REAL( N )[1] = (double) header->n_mu ;
+        REAL( N )[2] = (double) header->n_kappa ;
+        REAL( MU )[0] = header->mu_lo ;
+        REAL( MU )[1] = header->mu_hi ;
+        REAL( KAPPA )[0] = header->kappa_lo ;
+        REAL( KAPPA )[1] = header->kappa_hi ;
+        SET_VECTOR_ELT( INFO, 1, N ) ;
+        SET_VECTOR_ELT( INFO, 2, MU ) ;
+        SET_VECTOR_ELT( INFO, 3, KAPPA ) ;
+        SET_VECTOR_ELT( INFO, 4, ScalarReal( header->abstol ) ) ;
+        SET_VECTOR_ELT( INFO, 5, ScalarReal( header->reltol ) ) ;
+        SET_VECTOR_ELT( INFO, 6, ScalarReal( header->error ) ) ;
+        UNPROTECT(3) ; /* N, MU, KAPPA */
+    }
+
+    UNPROTECT(2) ; /* INFO, NAMES */
+    return INFO ;
+}
+
+
+SEXP covar_surface_open (
+        SEXP PATH           /* path of the surface file or 'NULL' */
+        )
+/* ****************************************************************************
+ * The function 'SEXP covar_surface_open(...)' closes the current surface and
+ * opens the one at 'PATH' (if not 'NULL'). Returns the same as
+ * 'covar_surface_info()' or 'NULL' on error.
+ * **************************************************************************/
+{
+    surface_close( &covar_surface ) ;
+    if ( PATH != R_NilValue ) {
+
+        int ret = surface_open( &covar_surface,
+                translateCharFS( STRING_ELT( PATH, 0 ) ) ) ;
+        if ( ret != SURFACE_OK ) {
+
+            REprintf( "Surface could not be opened: %s\n",
+                    surface_strerror( ret ) ) ;
+            return R_NilValue ;
+        }
+    }
+    return covar_surface_info() ;
+}
+
+
+SEXP covar_surface_build (
+        SEXP PATH ,         /* path of the surface file */
+        SEXP N ,            /* nbr. of grid points in r, mu and kappa */
+        SEXP MU ,           /* lower and upper bound of mu */
+        SEXP KAPPA ,        /* lower and upper bound of kappa */
+        SEXP ABSTOL ,       /* abs. tolerance for integration */
+        SEXP RELTOL ,       /* rel. tolerance for integration */
+        SEXP THREADS        /* nbr. of threads or 0 */
+        )
+/* ****************************************************************************
+ * The function 'SEXP covar_surface_build(...)' tabulates the GW correlation
+ * function with 'surface_build(...)' from 'surface.c', writes it to 'PATH'
+ * and opens it as with 'covar_surface_open(...)'.
+ * **************************************************************************/
+{
+    Surface_header header = {
+        { 0 }, 0, 0, (uint64_t) INTEGER( N )[0], (uint64_t) INTEGER( N )[1],
+        (uint64_t) INTEGER( N )[2], REAL( MU )[0], REAL( MU )[1],
+        REAL( KAPPA )[0], REAL( KAPPA )[1], *REAL( ABSTOL ), *REAL( RELTOL ), 0
+    } ;
+
+    int gsl_error = 0 ;
+    int ret = surface_build( &header, translateCharFS( STRING_ELT( PATH, 0 ) ),
+            *INTEGER( THREADS ), &gsl_error ) ;
+    if ( ret == SURFACE_EINTEG || ret == SURFACE_EBETA ) {
+        /* the codes agree with the ones of 'gwcovar.h' */
+
+        report_error( ret, gsl_error ) ;
+        return R_NilValue ;
+    }
+    if ( ret != SURFACE_OK ) {
+
+        REprintf( "Surface could not be built: %s\n",
+                surface_strerror( ret ) ) ;
+        return R_NilValue ;
+    }
+    return covar_surface_open( PATH ) ;
+}
+
+
+SEXP covar_sim (
+        SEXP ENTRIES ,      /* entries of the Cholesky factor */
+        SEXP COLINDICES ,   /* column indices of the Cholesky factor */
+        SEXP ROWPOINTERS ,  /* row pointers of the Cholesky factor */
+        SEXP PIVOT ,        /* permutation of the Cholesky factor */
+        SEXP NSIM ,         /* number of realisations */
+        SEXP SEED ,         /* two integers */
+        SEXP OUT ,          /* R matrix for the result or 'NULL' */
+        SEXP PATH ,         /* file for the result or 'NULL' */
+        SEXP BLOCK          /* nbr. of realisations calculated together */
+        )
+/* ****************************************************************************
+ * The function 'SEXP covar_sim(...)' draws realisations of a Gaussian random
+ * field with 'gw_sim_fill(...)' or 'gw_sim_write(...)' from 'sim.c'.
+ * **************************************************************************/
+{
+    if ( !spam32_indices( COLINDICES, ROWPOINTERS ) ) {
+
+        return R_NilValue ;
+    }
+    Gw_factor factor = {
+        (size_t) XLENGTH( ROWPOINTERS ) - 1, REAL( ENTRIES ),
+        INTEGER( COLINDICES ), INTEGER( ROWPOINTERS ), INTEGER( PIVOT )
+    } ;
+    size_t nsim = (size_t) *REAL( NSIM ) ;
+    uint64_t seed = ( (uint64_t) (uint32_t) INTEGER( SEED )[0] << 32 )
+        | (uint32_t) INTEGER( SEED )[1] ;
+    size_t block = (size_t) *INTEGER( BLOCK ) ;
+    if ( PATH == R_NilValue && ( factor.n > INT_MAX || nsim > INT_MAX ) ) {
+        /* the dimensions of an R matrix are 32-bit integers */
+
+        REprintf( "%s\n", "Too many locations or realisations for an R "
+                "matrix" ) ;
+        return R_NilValue ;
+    }
+
+    SEXP RESULT ;
+    int ret ;
+    double t0 = stats_clock() ;
+
+    if ( PATH != R_NilValue ) {
+
+        const char* path = translateCharFS( STRING_ELT( PATH, 0 ) ) ;
+        FILE* file = fopen( path, "wb" ) ;
+        if ( file == NULL ) {
+
+            REprintf( "File '%s' could not be opened\n", path ) ;
+            return R_NilValue ;
+        }
+        size_t chunk = ( (size_t) 1 << 23 ) / ( factor.n + 1 ) ;
+        /* about 64 MB of realisations are held in memory */
+
+        ret = gw_sim_write( &factor, file, nsim, seed, block,
+                chunk > block ? chunk : block ) ;
+        if ( fclose( file ) != 0 && ret == GW_OK ) {
+
+            ret = GW_EIO ;
+        }
+        PROTECT( RESULT = mkString( path ) ) ;
+    } else {
+
+        if ( OUT == R_NilValue ) {
+
+            PROTECT( RESULT = allocMatrix( REALSXP, (int) factor.n,
+                        (int) nsim ) ) ;
+        } else {
+
+            PROTECT( RESULT = OUT ) ;
+        }
+        ret = gw_sim_fill( &factor, REAL( RESULT ), 0, nsim, seed, block ) ;
+    }
+
+    if ( ret != GW_OK ) {
+
+        report_error( ret, 0 ) ;
+        UNPROTECT(1) ; /* RESULT */
+        return R_NilValue ;
+    }
+    if ( RESULT != OUT ) {
+        /* the caller's buffer is not given an attribute */
+
+        double elapsed = stats_clock() - t0 ;
+        setAttrib( RESULT, install( "replicates.per.second" ),
+                ScalarReal( elapsed > 0 ? (double) nsim / elapsed
+                    : R_PosInf ) ) ;
+    }
+    UNPROTECT(1) ; /* RESULT */
+    return RESULT ;
+}
+
+
+SEXP covar_vecchia (
+        SEXP COORDS ,       /* matrix of coordinates (n x dim) */
+        SEXP Y ,            /* observations */
+        SEXP NEIGHBOURS ,   /* max. nbr. of neighbours */
+        SEXP MU ,           /* param. of the GW covariance fct */
+        SEXP SMOOTHNESS ,   /* param. of the GW covariance fct */
+        SEXP SILL ,         /* param. of the GW covariance fct */
+        SEXP RNGE ,         /* param. of the GW covariance fct */
+        SEXP NUGGET ,       /* param. of the GW covariance fct */
+        SEXP ABSTOL ,       /* abs. tolerance for integration */
+        SEXP RELTOL ,       /* rel. tolerance for integration */
+        SEXP EPS ,          /* treshhold below which values are
+                             * considered 0 */
+        SEXP N_INTERPOL     /* size of the interpolation table or 0 */
+        )
+/* ****************************************************************************
+ * The function 'SEXP covar_vecchia(...)' calculates the Vecchia approximation
+ * of the log-likelihood with 'gw_vecchia_loglik(...)' from 'vecchia.c'. The
+ * interpolation table is taken from (or added to) the table store.
+ * **************************************************************************/
+{
+    int* p_dim = INTEGER( getAttrib( COORDS, R_DimSymbol ) ) ;
+    Gw_params params = {
+        *REAL( MU ), *REAL( SMOOTHNESS ), *REAL( SILL ), *REAL( RNGE ),
+        *REAL( NUGGET ), *REAL( ABSTOL ), *REAL( RELTOL ), *REAL( EPS )
+    } ;
+    int n_interpol = *INTEGER( N_INTERPOL ) ;
+    int gsl_error = 0 ;
+    int ret ;
+
+    double t0 = stats_start() ;
+    Gw_kernel* kernel ;
+    if ( n_interpol > 0 ) {
+
+        if ( !interpol_kernel( &kernel, &params, (size_t) n_interpol ) ) {
+
+            return R_NilValue ;
+        }
+    } else {
+
+        ret = gw_kernel_new( &kernel, &params, 0, NULL, NULL ) ;
+        if ( ret != GW_OK ) {
+
+            report_error( ret, 0 ) ;
+            return R_NilValue ;
+        }
+    }
+    t0 = stats_lap( STATS_TABLE, t0 ) ;
+
+    double loglik ;
+    ret = gw_vecchia_loglik( kernel, REAL( COORDS ), (size_t) p_dim[0],
+            p_dim[1], REAL( Y ), (size_t) *INTEGER( NEIGHBOURS ), &loglik,
+            &gsl_error ) ;
+    gw_kernel_free( kernel ) ;
+    if ( ret != GW_OK ) {
+
+        report_error( ret, gsl_error ) ;
+        return R_NilValue ;
+    }
+    stats_lap( STATS_KERNEL, t0 ) ;
+    return ScalarReal( loglik ) ;
+}
+
+
+SEXP covar_vector_compact (
+        SEXP DIST ,         /* entries of the spam distance matrix */
+        SEXP COLINDICES ,   /* column indices of the distance matrix */
+        SEXP ROWPOINTERS ,  /* row pointers of the distance matrix */
+        SEXP MU ,           /* param. of the GW covariance fct */
+        SEXP SMOOTHNESS ,   /* param. of the GW covariance fct */
+        SEXP SILL ,         /* param. of the GW covariance fct */
+        SEXP RNGE ,         /* param. of the GW covariance fct */
+        SEXP NUGGET ,       /* param. of the GW covariance fct */
+        SEXP ABSTOL ,       /* abs. tolerance for integration */
+        SEXP RELTOL ,       /* rel. tolerance for integration */
+        SEXP EPS ,          /* treshhold below which values are
+                             * considered 0 */
+        SEXP NBR_INTERPOL , /* nbr. of interpolation points or 0 */
+        SEXP BASE           /* base correlation fct tapered or 'NULL' */
+        )
+/* ****************************************************************************
+ * The function 'SEXP covar_vector_compact(...)' calculates the GW covariance
+ * matrix of a spam distance matrix without the entries beyond the range,
+ * using 'gw_eval_compact(...)' from 'gwcovar.c'.
+ * **************************************************************************/
+{
+    Gw_params params = {
+        *REAL( MU ), *REAL( SMOOTHNESS ), *REAL( SILL ), *REAL( RNGE ),
+        *REAL( NUGGET ), *REAL( ABSTOL ), *REAL( RELTOL ), *REAL( EPS )
+    } ;
+    int n = *INTEGER( NBR_INTERPOL ) ;
+    size_t nrow = (size_t) XLENGTH( ROWPOINTERS ) - 1 ;
+    size_t length = (size_t) XLENGTH( DIST ) ;
+    const double* dist = REAL( DIST ) ;
+    SEXPTYPE index_type = TYPEOF( ROWPOINTERS ) ;
+    /* 'REALSXP' for spam64 */
+    if ( TYPEOF( COLINDICES ) != index_type
+            || ( index_type != INTSXP && index_type != REALSXP ) ) {
+
+        REprintf( "%s\n", "Invalid index vectors of the spam matrix" ) ;
+        return R_NilValue ;
+    }
+
+    /* number of entries within the range, with the test of
+     * 'gw_eval_compact(...)', which keeps missing distances (NaN) */
+    size_t count = 0 ;
+    for ( size_t k = 0 ; k < length ; k++ ) {
+
+        count += !( dist[k] >= params.rnge ) ;
+    }
+
+    /* the R objects are allocated first, since an allocation error would
+     * leak the kernel */
+    SEXP RESULT, ENTRIES_OUT, COLINDICES_OUT, ROWPOINTERS_OUT ;
+    PROTECT( RESULT = allocVector( VECSXP, 3 ) ) ;
+    PROTECT( ENTRIES_OUT = allocVector( REALSXP, count > 0 ? count : 1 ) ) ;
+    PROTECT( COLINDICES_OUT = allocVector( index_type,
+                count > 0 ? count : 1 ) ) ;
+    PROTECT( ROWPOINTERS_OUT = allocVector( index_type, nrow + 1 ) ) ;
+    SET_VECTOR_ELT( RESULT, 0, ENTRIES_OUT ) ;
+    SET_VECTOR_ELT( RESULT, 1, COLINDICES_OUT ) ;
+    SET_VECTOR_ELT( RESULT, 2, ROWPOINTERS_OUT ) ;
+    UNPROTECT(3) ; /* ENTRIES_OUT, COLINDICES_OUT, ROWPOINTERS_OUT */
+
+    double t0 = stats_start() ;
+    Gw_kernel* kernel ;
+    int gsl_error = 0 ;
+    int ret ;
+    if ( n > 0 ) {
+
+        if ( !interpol_kernel( &kernel, &params, (size_t) n ) ) {
+
+            UNPROTECT(1) ; /* RESULT */
+            return R_NilValue ;
+        }
+        ret = GW_OK ;
+    } else {
+
+        ret = gw_kernel_new( &kernel, &params, 0, &covar_stats, &gsl_error ) ;
+    }
+    if ( ret == GW_OK ) {
+
+        ret = kernel_base( kernel, BASE, &gsl_error ) ;
+    }
+    if ( ret != GW_OK ) {
+
+        gw_kernel_free( kernel ) ;
+        report_error( ret, gsl_error ) ;
+        UNPROTECT(1) ; /* RESULT */
+        return R_NilValue ;
+    }
+    t0 = stats_lap( STATS_TABLE, t0 ) ;
+
+    size_t nnz ;
+    if ( index_type == REALSXP ) {
+
+        ret = gw_eval_compact64( kernel_progress( kernel ), dist,
+                REAL( COLINDICES ), REAL( ROWPOINTERS ), nrow,
+                REAL( ENTRIES_OUT ), REAL( COLINDICES_OUT ),
+                REAL( ROWPOINTERS_OUT ), &nnz, &covar_stats, &gsl_error ) ;
+    } else {
+
+        ret = gw_eval_compact( kernel_progress( kernel ), dist,
+                INTEGER( COLINDICES ), INTEGER( ROWPOINTERS ), nrow,
+                REAL( ENTRIES_OUT ), INTEGER( COLINDICES_OUT ),
+                INTEGER( ROWPOINTERS_OUT ), &nnz, &covar_stats, &gsl_error ) ;
+    }
+    gw_kernel_free( kernel ) ;
+    if ( ret != GW_OK ) {
+
+        report_error( ret, gsl_error ) ;
+        UNPROTECT(1) ; /* RESULT */
+        return R_NilValue ;
+    }
+    if ( nnz == 0 ) {
+        /* spam stores an empty matrix as a single zero in the first row */
+
+        REAL( ENTRIES_OUT )[0] = 0 ;
+        for ( size_t i = 1 ; i <= nrow ; i++ ) {
+
+            if ( index_type == REALSXP ) {
+
+                REAL( ROWPOINTERS_OUT )[i] = 2 ;
+            } else {
+
+                INTEGER( ROWPOINTERS_OUT )[i] = 2 ;
+            }
+        }
+        if ( index_type == REALSXP ) {
+
+            REAL( COLINDICES_OUT )[0] = 1 ;
+        } else {
+
+            INTEGER( COLINDICES_OUT )[0] = 1 ;
+        }
+    }
+    stats_lap( STATS_OUTPUT, t0 ) ;
+    UNPROTECT(1) ; /* RESULT */
+    return RESULT ;
+}
+
+
+SEXP covar_progress_set (
+        SEXP FUN ,          /* R function or 'NULL' */
+        SEXP CHUNK          /* nbr. of values between two checks */
+        )
+/* ****************************************************************************
+ * The function 'SEXP covar_progress_set(...)' sets the R function that is
+ * called with the progress of long calculations and the number of values
+ * calculated between two checks for a user interrupt.
+ * **************************************************************************/
+{
+    if ( covar_progress_fun != NULL ) {
+
+        R_ReleaseObject( covar_progress_fun ) ;
+        covar_progress_fun = NULL ;
+    }
+    if ( FUN != R_NilValue ) {
+
+        R_PreserveObject( FUN ) ;
+        covar_progress_fun = FUN ;
+    }
+    covar_chunk = *REAL( CHUNK ) >= 1 ? (size_t) *REAL( CHUNK ) : 1 ;
+    return R_NilValue ;
+}
+
+
+SEXP covar_coords (
+        SEXP COORDS ,       /* coordinates of the locations */
+        SEXP MU ,           /* param. of the GW covariance fct */
+        SEXP SMOOTHNESS ,   /* param. of the GW covariance fct */
+        SEXP SILL ,         /* param. of the GW covariance fct */
+        SEXP RNGE ,         /* param. of the GW covariance fct */
+        SEXP NUGGET ,       /* param. of the GW covariance fct */
+        SEXP ABSTOL ,       /* abs. tolerance for integration */
+        SEXP RELTOL ,       /* rel. tolerance for integration */
+        SEXP EPS ,          /* treshhold below which values are
+                             * considered 0 */
+        SEXP NBR_INTERPOL   /* nbr. of interpolation points or 0 */
+        )
+/* ****************************************************************************
+ * The function 'SEXP covar_coords(...)' calculates the dense GW covariance
+ * matrix of the locations 'COORDS' without a distance matrix, using
+ * 'gw_eval_coords(...)' from 'gwcovar.c'.
+ * **************************************************************************/
 {
-    /* create local representatives for the SEXPs */
-    int* p_dim = INTEGER(getAttrib( DIST, R_DimSymbol )) ;
-    double* p_dist = REAL( DIST ) ;
-    double mu = *REAL( MU ) ;
-    double smoothness = * REAL( SMOOTHNESS ) ;
-    double sill = *REAL( SILL ) ;
-    double rnge = *REAL( RNGE ) ;
-    double nugget = *REAL( NUGGET ) ;
-    double abstol = *REAL( ABSTOL ) ;
-    double reltol = *REAL( RELTOL ) ;
+    int* p_dim = INTEGER( getAttrib( COORDS, R_DimSymbol ) ) ;
+    Gw_params params = {
+        *REAL( MU ), *REAL( SMOOTHNESS ), *REAL( SILL ), *REAL( RNGE ),
+        *REAL( NUGGET ), *REAL( ABSTOL ), *REAL( RELTOL ), *REAL( EPS )
+    } ;
+    int n = *INTEGER( NBR_INTERPOL ) ;
 
-    /* allocate return object */
+    /* the result is allocated first, since an allocation error would leak
+     * the kernel */
     SEXP RESULT ;
-    PROTECT( 
-            RESULT = allocMatrix( REALSXP, *p_dim, *(p_dim+1) ) 
-           ) ; 
+    PROTECT( RESULT = allocMatrix( REALSXP, p_dim[0], p_dim[0] ) ) ;
 
-    Wendland_result result ;
-    gsl_set_error_handler_off() ;
-    if ( *p_dim == *(p_dim+1) ) {
-        /* if matrix is square */
+    double t0 = stats_start() ;
+    Gw_kernel* kernel ;
+    int gsl_error = 0 ;
+    int ret ;
+    if ( n > 0 ) {
+
+        if ( !interpol_kernel( &kernel, &params, (size_t) n ) ) {
+
+            UNPROTECT(1) ; /* RESULT */
+            return R_NilValue ;
+        }
+        ret = GW_OK ;
+    } else {
+
+        ret = gw_kernel_new( &kernel, &params, 0, &covar_stats, &gsl_error ) ;
+    }
+    if ( ret != GW_OK ) {
 
-        for ( int i=0 ; i < *p_dim ; i++ ) {
-            /* for each row */
+        report_error( ret, gsl_error ) ;
+        UNPROTECT(1) ; /* RESULT */
+        return R_NilValue ;
+    }
+    t0 = stats_lap( STATS_TABLE, t0 ) ;
+
+    ret = gw_eval_coords( kernel_progress( kernel ), REAL( COORDS ),
+            (size_t) p_dim[0], p_dim[1], REAL( RESULT ), &covar_stats,
+            &gsl_error ) ;
+    gw_kernel_free( kernel ) ;
+    if ( ret != GW_OK ) {
 
-            REAL(RESULT)[i + i*(*p_dim)] = sill+nugget ; 
-            /* diagonal element  of matrix */
+        report_error( ret, gsl_error ) ;
+        UNPROTECT(1) ; /* RESULT */
+        return R_NilValue ;
+    }
+    stats_lap( n > 0 ? STATS_OUTPUT : STATS_KERNEL, t0 ) ;
+    UNPROTECT(1) ; /* RESULT */
+    return RESULT ;
+}
 
-            /* For loop calculates the values for the upper triangular matrix
-             * and than uses the simetry of the covariance matrix to insert the
-             * value into the lower triangular matrix, too.*/
-            for ( int j=i+1 ; j< *(p_dim+1) ; j++ ) {
 
-                if( *(p_dist + i + j * (*p_dim) )  == 0 ) {
-                    /* if distance = 0 */
+SEXP covar_sfc_order (
+        SEXP COORDS ,       /* coordinates of the locations */
+        SEXP CURVE          /* 0: Hilbert curve, 1: Morton curve */
+        )
+/* ****************************************************************************
+ * The function 'SEXP covar_sfc_order(...)' orders the locations along a
+ * space-filling curve using 'sfc_order(...)' from 'sfc.c'.
+ * **************************************************************************/
+{
+    int* p_dim = INTEGER( getAttrib( COORDS, R_DimSymbol ) ) ;
+    size_t n = (size_t) p_dim[0] ;
+    int curve = *INTEGER( CURVE ) ;
 
-                    REAL(RESULT)[i + j*(*p_dim)] = sill + nugget ;
-                    /* upper triangular matrix */
+    /* the result is allocated first, since an allocation error would leak
+     * the buffer of the order */
+    SEXP RESULT ;
+    PROTECT( RESULT = allocVector( INTSXP, n ) ) ;
+    size_t* order = scratch_alloc( ( n > 0 ? n : 1 ) * sizeof(size_t) ) ;
+    if ( order == NULL ) {
 
-                    REAL(RESULT)[j + i*(*p_dim)] = REAL(RESULT)[i + j*(*p_dim)] ;
-                    /* lower triangular matrix */
+        report_error( GW_ENOMEM, 0 ) ;
+        UNPROTECT(1) ; /* RESULT */
+        return R_NilValue ;
+    }
+    int ret = sfc_order( REAL( COORDS ), n, p_dim[1],
+            curve == 1 ? SFC_MORTON : SFC_HILBERT, order ) ;
+    if ( ret != GW_OK ) {
+
+        scratch_free( order ) ;
+        report_error( ret, 0 ) ;
+        UNPROTECT(1) ; /* RESULT */
+        return R_NilValue ;
+    }
 
-                } else if (*(p_dist + i + j*(*p_dim) ) < rnge ) {
-                    /* if distance < rnge */
+    for ( size_t k = 0 ; k < n ; k++ ) {
 
-                    /* upper triangular matrix */
-                     wendland( &result,
-                            *(p_dist+i+j * (*p_dim) ) / rnge ,
-                            mu, smoothness, abstol, reltol ) ;
+        INTEGER( RESULT )[k] = (int) order[k] + 1 ;
+    }
+    scratch_free( order ) ;
+    UNPROTECT(1) ; /* RESULT */
+    return RESULT ;
+}
 
 
-                    if ( check_wendland_errors( &result ) ) {
+SEXP covar_multi (
+        SEXP DIST ,         /* distances (matrix or entries of spam) */
+        SEXP COLINDICES ,   /* column indices of spam or 'NULL' */
+        SEXP ROWPOINTERS ,  /* row pointers of spam or 'NULL' */
+        SEXP P ,            /* nbr. of variables */
+        SEXP PARAMS ,       /* p x p x 5 array of GW parameters */
+        SEXP ABSTOL ,       /* abs. tolerance for integration */
+        SEXP RELTOL ,       /* rel. tolerance for integration */
+        SEXP EPS ,          /* treshhold below which values are
+                             * considered 0 */
+        SEXP NBR_INTERPOL   /* nbr. of interpolation points or 0 */
+        )
+/* ****************************************************************************
+ * The function 'SEXP covar_multi(...)' calculates the multivariate GW
+ * covariance matrix using 'gw_eval_multi_matrix(...)' or
+ * 'gw_eval_multi_spam(...)' from 'gwcovar.c'.
+ * **************************************************************************/
+{
+    size_t p = (size_t) *INTEGER( P ) ;
+    size_t nkernels = p * ( p + 1 ) / 2 ;
+    int n_interpol = *INTEGER( NBR_INTERPOL ) ;
+    const double* par = REAL( PARAMS ) ;
+    int sparse = COLINDICES != R_NilValue ;
 
-                        REAL(RESULT)[i + j*(*p_dim)] = sill * result.result ;
+    if ( p < 1 || (size_t) XLENGTH( PARAMS ) != 5 * p * p ) {
 
-                        REAL(RESULT)[j + i*(*p_dim)] = REAL(RESULT)[i + j*(*p_dim)] ;
-                    } else {
+        report_error( GW_EINVAL, 0 ) ;
+        return R_NilValue ;
+    }
+    if ( sparse && !spam32_indices( COLINDICES, ROWPOINTERS ) ) {
 
-                        return R_NilValue ;
-                    }
+        return R_NilValue ;
+    }
+    if ( sparse && (double) XLENGTH( DIST ) * p * p > INT_MAX ) {
 
+        REprintf( "%s\n", "The multivariate covariance matrix has too many "
+                "entries for 'spam' with 32-bit indices" ) ;
+        return R_NilValue ;
+    }
 
+    /* the R objects are allocated first, since an allocation error would
+     * leak the kernels */
+    SEXP RESULT ;
+    size_t nrow ;
+    if ( sparse ) {
+
+        nrow = (size_t) XLENGTH( ROWPOINTERS ) - 1 ;
+        R_xlen_t nnz = XLENGTH( DIST ) * (R_xlen_t) ( p * p ) ;
+        SEXP ENTRIES_OUT, COLINDICES_OUT, ROWPOINTERS_OUT ;
+        PROTECT( RESULT = allocVector( VECSXP, 3 ) ) ;
+        PROTECT( ENTRIES_OUT = allocVector( REALSXP, nnz ) ) ;
+        PROTECT( COLINDICES_OUT = allocVector( INTSXP, nnz ) ) ;
+        PROTECT( ROWPOINTERS_OUT = allocVector( INTSXP, nrow * p + 1 ) ) ;
+        SET_VECTOR_ELT( RESULT, 0, ENTRIES_OUT ) ;
+        SET_VECTOR_ELT( RESULT, 1, COLINDICES_OUT ) ;
+        SET_VECTOR_ELT( RESULT, 2, ROWPOINTERS_OUT ) ;
+        UNPROTECT(3) ; /* ENTRIES_OUT, COLINDICES_OUT, ROWPOINTERS_OUT */
+    } else {
 
-                    /* lower triangular matrix */
-                } else {
+        nrow = (size_t) INTEGER( getAttrib( DIST, R_DimSymbol ) )[0] ;
+        PROTECT( RESULT = allocMatrix( REALSXP, (int) ( nrow * p ),
+                    (int) ( nrow * p ) ) ) ;
+    }
 
-                    REAL(RESULT)[i + j*(*p_dim)] = 0 ;
-                    /* upper triangular matrix */
+    /* kernels of the pairs a <= b */
+    double t0 = stats_start() ;
+    Gw_kernel** kernels = calloc( nkernels, sizeof(Gw_kernel*) ) ;
+    int gsl_error = 0 ;
+    int ret = kernels == NULL ? GW_ENOMEM : GW_OK ;
+    int ok = ret == GW_OK ;
+    for ( size_t b = 0 ; b < p && ok ; b++ ) {
+
+        for ( size_t a = 0 ; a <= b && ok ; a++ ) {
+
+            size_t k = a + b * ( b + 1 ) / 2 ;
+            size_t ab = a + b*p ;
+            Gw_params params = {
+                par[ab + p*p], par[ab + 2*p*p], par[ab + 3*p*p], par[ab],
+                par[ab + 4*p*p], *REAL( ABSTOL ), *REAL( RELTOL ),
+                *REAL( EPS )
+            } ;
+            if ( n_interpol > 0 ) {
+
+                ok = interpol_kernel( &kernels[k], &params,
+                        (size_t) n_interpol ) ;
+            } else {
 
-                    REAL(RESULT)[j + i*(*p_dim)] = 0 ;
-                    /* lower triangular matrix */
-                }
+                ret = gw_kernel_new( &kernels[k], &params, 0, &covar_stats,
+                        &gsl_error ) ;
+                ok = ret == GW_OK ;
             }
         }
-    } else {
-        /* if matrix is not square */
+    }
+    if ( !ok ) {
 
-        /* For loop iterates through all matrix entries */
-        for ( int i=0 ; i< *p_dim  ; i++ ) {
+        for ( size_t k = 0 ; kernels != NULL && k < nkernels ; k++ ) {
 
-            for ( int j=0; j< *(p_dim+1) ; j++ ) {
+            gw_kernel_free( kernels[k] ) ;
+        }
+        free( kernels ) ;
+        if ( ret != GW_OK ) {
 
-                if( *(p_dist + i + j * (*p_dim) ) == 0 ) {
+            report_error( ret, gsl_error ) ;
+        }
+        UNPROTECT(1) ; /* RESULT */
+        return R_NilValue ;
+    }
+    kernel_progress( kernels[0] ) ;
+    t0 = stats_lap( STATS_TABLE, t0 ) ;
 
-                    REAL(RESULT)[i + j*(*p_dim)] = sill + nugget ;
-                } else if ( *(p_dist+i + j * (*p_dim) ) < rnge ) {
+    if ( sparse ) {
 
-                    wendland( &result ,
-                            *(p_dist +i +j * (*p_dim) ) / rnge, 
-                            mu, smoothness, abstol, reltol ) ;
-                    
-                    if ( check_wendland_errors( &result ) ) {
+        ret = gw_eval_multi_spam( (const Gw_kernel* const*) kernels, p,
+                REAL( DIST ), INTEGER( COLINDICES ), INTEGER( ROWPOINTERS ),
+                nrow, REAL( VECTOR_ELT( RESULT, 0 ) ),
+                INTEGER( VECTOR_ELT( RESULT, 1 ) ),
+                INTEGER( VECTOR_ELT( RESULT, 2 ) ), &covar_stats,
+                &gsl_error ) ;
+    } else {
 
-                        REAL(RESULT)[i + j*(*p_dim)] = sill * result.result ;
-                    } else {
+        ret = gw_eval_multi_matrix( (const Gw_kernel* const*) kernels, p,
+                REAL( DIST ), nrow, REAL( RESULT ), &covar_stats,
+                &gsl_error ) ;
+    }
 
-                        return R_NilValue ;
-                    }
-                } else {
+    for ( size_t k = 0 ; k < nkernels ; k++ ) {
 
-                    REAL(RESULT)[i + j*(*p_dim)] = 0 ;
-                }
-            }
+        gw_kernel_free( kernels[k] ) ;
+    }
+    free( kernels ) ;
+    if ( ret != GW_OK ) {
 
-        }
+        report_error( ret, gsl_error ) ;
+        UNPROTECT(1) ; /* RESULT */
+        return R_NilValue ;
     }
+    stats_lap( n_interpol > 0 ? STATS_OUTPUT : STATS_KERNEL, t0 ) ;
     UNPROTECT(1) ; /* RESULT */
     return RESULT ;
 }
 
 
-
-
-SEXP 
-covar_interpol (
-        SEXP DIST ,     /* distance matrix */
-        SEXP MU ,       /* param. of GW correlation function */
-        SEXP SMOOTHNESS,/* param. of GW correlation function */
-        SEXP SILL ,     /* param. of GW correlation function */
-        SEXP RNGE ,     /* param. of GW correlation function */
-        SEXP NUGGET ,   /* param. of GW correlation function */
-        SEXP N ,        /* nbr. of points where fct is
-                         * evaluated for interpolation */ 
-        SEXP ABSTOL ,   /* rel. tolerance for integration */
-        SEXP RELTOL     /* abs. tolerance for integration */ 
+SEXP covar_dense (
+        SEXP DIST ,         /* distance matrix */
+        SEXP MU ,           /* param. of the GW covariance fct */
+        SEXP SMOOTHNESS ,   /* param. of the GW covariance fct */
+        SEXP SILL ,         /* param. of the GW covariance fct */
+        SEXP RNGE ,         /* param. of the GW covariance fct */
+        SEXP NUGGET ,       /* param. of the GW covariance fct */
+        SEXP ABSTOL ,       /* abs. tolerance for integration */
+        SEXP RELTOL ,       /* rel. tolerance for integration */
+        SEXP EPS ,          /* threshold for distances considered 0 */
+        SEXP NBR_INTERPOL , /* nbr. of interpolation points or 0 */
+        SEXP THREADS ,      /* nbr. of threads or 0 */
+        SEXP PAGES ,        /* kind of pages, see 'mem.h' */
+        SEXP EXTPTR         /* 'TRUE' for an external pointer */
         )
-/* **************************************************************************** 
- * The function 'SEXP covar_mat_interpol(...)' returns the Generalized Wendland
- * (GW) covariance matrix based on a distance matrix in standard R matrix
- * format.  The values of the covariance function are interpolated using cubic
- * splines. For the calculation of the GW covariance function the
- * non-addaptive Gauss-Kronrod algorithm is used.
- * ***************************************************************************/
+/* ****************************************************************************
+ * The function 'SEXP covar_dense(...)' calculates the dense GW covariance
+ * matrix in parallel with 'gw_eval_matrix_parallel(...)' from 'gwcovar.c'
+ * into memory with huge pages that is first touched by the threads of the
+ * calculation.
+ * **************************************************************************/
 {
-    /* create local representation for the SEXPs */
-    int* p_dim = INTEGER(getAttrib( DIST, R_DimSymbol )) ;
-    double* p_dist = REAL( DIST ) ;
-    double mu = *REAL( MU ) ;
-    double smoothness = * REAL( SMOOTHNESS ) ;
-    double sill = *REAL( SILL ) ;
-    double rnge = *REAL( RNGE ) ;
-    double nugget = *REAL( NUGGET ) ;
-    int n = *INTEGER( N ) ;
-    double abstol = *REAL( ABSTOL ) ;
-    double reltol = *REAL( RELTOL ) ;
+    int* p_dim = INTEGER( getAttrib( DIST, R_DimSymbol ) ) ;
+    size_t n = (size_t) p_dim[0] ;
+    Gw_params params = {
+        *REAL( MU ), *REAL( SMOOTHNESS ), *REAL( SILL ), *REAL( RNGE ),
+        *REAL( NUGGET ), *REAL( ABSTOL ), *REAL( RELTOL ), *REAL( EPS )
+    } ;
+    int n_interpol = *INTEGER( NBR_INTERPOL ) ;
+    int threads = *INTEGER( THREADS ) ;
+    int pages = *INTEGER( PAGES ) ;
+
+    if ( p_dim[1] != p_dim[0] ) {
+
+        REprintf( "%s\n", "The distance matrix has to be square" ) ;
+        return R_NilValue ;
+    }
 
-    
-    /* allocate return object */
+    /* the result is allocated first, since an allocation error would leak
+     * the kernel */
     SEXP RESULT ;
-    PROTECT( 
-            RESULT = allocMatrix( REALSXP, *p_dim, *(p_dim+1) )
-           ) ; 
-
-    double *points = malloc( n * sizeof(double) ) ;
-    /* allocating array for the interpolation points */
-
-    double *wendl = malloc( n * sizeof(double) ) ;
-    /* allocation array for the values of the cov. fct.  in the interpolation
-     * points */
-
-    double interval = rnge / ( (double) n - 1.0 ) ;
-    /* distance between the interpolation points */
-
-    gsl_set_error_handler_off() ;
-    Wendland_result result ;
+    double* out ;
+    Ext_matrix* ext = NULL ;
+    if ( *LOGICAL( EXTPTR ) ) {
+
+        PROTECT( RESULT = R_MakeExternalPtr( NULL, install( "covar_dense" ),
+                    R_NilValue ) ) ;
+        R_RegisterCFinalizerEx( RESULT, ext_finalize, TRUE ) ;
+        ext = malloc( sizeof(Ext_matrix) ) ;
+        if ( ext == NULL
+                || mem_alloc( &ext->block, n * n * sizeof(double), pages ) ) {
+
+            free( ext ) ;
+            report_error( GW_ENOMEM, 0 ) ;
+            UNPROTECT(1) ; /* RESULT */
+            return R_NilValue ;
+        }
+        ext->n = n ;
+        R_SetExternalPtrAddr( RESULT, ext ) ;
+        out = ext->block.ptr ;
+    } else {
 
-    /* calculating the function in the interpolation points */
-    for ( int i=0 ; i < n ; ++i ) {
+        PROTECT( RESULT = allocMatrix( REALSXP, p_dim[0], p_dim[0] ) ) ;
+        out = REAL( RESULT ) ;
+        mem_advise( out, n * n * sizeof(double), pages ) ;
+    }
 
-        points[i] = i*interval ;
-        wendland( &result,  points[i]/rnge, mu, smoothness, abstol, reltol ) ;
+    double t0 = stats_start() ;
+    Gw_kernel* kernel ;
+    int gsl_error = 0 ;
+    int ret ;
+    int ok ;
+    if ( n_interpol > 0 ) {
 
-        if ( check_wendland_errors( &result ) ) {
+        ok = interpol_kernel( &kernel, &params, (size_t) n_interpol ) ;
+    } else {
 
-            wendl[i]    = sill * result.result ;     
-        } else {
+        ret = gw_kernel_new( &kernel, &params, 0, &covar_stats, &gsl_error ) ;
+        if ( ret != GW_OK ) {
 
-            return R_NilValue ;
-        }   
+            report_error( ret, gsl_error ) ;
+        }
+        ok = ret == GW_OK ;
     }
+    if ( !ok ) {
 
-    /* initialisation for the interpolation */
-    gsl_interp *interpol = gsl_interp_alloc(gsl_interp_cspline , n ) ;
-    gsl_interp_init( interpol,  points, wendl, n ) ;
-    gsl_interp_accel *acc =  gsl_interp_accel_alloc() ;
-
-    if ( *p_dim == *(p_dim+1) ) {
-        /* if the matrix is square */
+        if ( ext != NULL ) {
 
-        /* For loop iterates through the upper triangular matrix. For the lower
-         * triangular matrix symetry is used. */
-        for ( int i=0 ; i< *p_dim ; i++ ) {
+            ext_finalize( RESULT ) ;
+        }
+        UNPROTECT(1) ; /* RESULT */
+        return R_NilValue ;
+    }
+    t0 = stats_lap( STATS_TABLE, t0 ) ;
 
-            REAL(RESULT)[i + i*(*p_dim)] = sill+nugget ; 
-            /* diagonal of matrix */
+    ret = gw_eval_matrix_parallel( kernel, REAL( DIST ), out, n, threads,
+            &gsl_error ) ;
+    gw_kernel_free( kernel ) ;
+    if ( ret != GW_OK ) {
 
-            for ( int j=i+1 ; j< *(p_dim+1) ; j++ ) {
+        if ( ext != NULL ) {
+            /* release the memory now instead of at the next collection */
 
-                if ( *(p_dist+i+j*(*p_dim)) == 0 ) {
-                    /* dist = 0 */ 
+            ext_finalize( RESULT ) ;
+        }
+        report_error( ret, gsl_error ) ;
+        UNPROTECT(1) ; /* RESULT */
+        return R_NilValue ;
+    }
+    stats_lap( n_interpol > 0 ? STATS_OUTPUT : STATS_KERNEL, t0 ) ;
+    UNPROTECT(1) ; /* RESULT */
+    return RESULT ;
+}
 
-                    REAL(RESULT)[i + j*(*p_dim)] = sill + nugget ;
-                    /* upper triangular matrix */
 
-                    /* lower triangular matrix */
-                    REAL(RESULT)[j + i*(*p_dim)] =
-                        REAL(RESULT)[i + j*(*p_dim)] ;
-                } else if ( *(p_dist+i+j*(*p_dim)) < rnge ) {
-                    /* dist < rnge */
+SEXP covar_ext_matvec (
+        SEXP PTR ,          /* external matrix from 'covar_dense(...)' */
+        SEXP V ,            /* vector */
+        SEXP THREADS        /* nbr. of threads or 0 */
+        )
+/* ****************************************************************************
+ * The function 'SEXP covar_ext_matvec(...)' multiplies an external matrix
+ * with a vector using 'gw_matvec_parallel(...)'.
+ * **************************************************************************/
+{
+    Ext_matrix* ext = ext_matrix( PTR ) ;
+    if ( ext == NULL ) {
 
-                    /* upper triangular matrix */
-                    REAL(RESULT)[i + j*(*p_dim)] = 
-                        gsl_interp_eval( interpol, points, wendl, 
-                                *(p_dist+i+j*(*p_dim)) , acc ) ;
+        return R_NilValue ;
+    }
+    if ( (size_t) XLENGTH( V ) != ext->n ) {
 
-                    /* lower triangular matrix */
-                    REAL(RESULT)[j + i*(*p_dim)] =
-                        REAL(RESULT)[i + j*(*p_dim)] ;
-                } else {
-                    /* dist > rnge */
+        report_error( GW_EINVAL, 0 ) ;
+        return R_NilValue ;
+    }
+    SEXP RESULT ;
+    PROTECT( RESULT = allocVector( REALSXP, ext->n ) ) ;
+    gw_matvec_parallel( ext->block.ptr, ext->n, REAL( V ), REAL( RESULT ),
+            *INTEGER( THREADS ) ) ;
+    UNPROTECT(1) ; /* RESULT */
+    return RESULT ;
+}
 
-                    REAL(RESULT)[i + j*(*p_dim)] = 0 ;
-                    /* upper triangular matrix */
 
-                    REAL(RESULT)[j + i*(*p_dim)] = 0 ;
-                    /* lower triangular matrix */
-                }
-            }
-        }
-    } else {
-        /* matrix is not square */
+SEXP covar_ext_get (
+        SEXP PTR            /* external matrix from 'covar_dense(...)' */
+        )
+/* ****************************************************************************
+ * The function 'SEXP covar_ext_get(...)' copies an external matrix into a
+ * standard R matrix.
+ * **************************************************************************/
+{
+    Ext_matrix* ext = ext_matrix( PTR ) ;
+    if ( ext == NULL ) {
 
-        /* For loop iterates through all matrix entries */
-        for ( int i=0 ; i< *p_dim ; i++ ) {
+        return R_NilValue ;
+    }
+    SEXP RESULT ;
+    PROTECT( RESULT = allocMatrix( REALSXP, (int) ext->n, (int) ext->n ) ) ;
+    const double* a = ext->block.ptr ;
+    for ( size_t k = 0 ; k < ext->n * ext->n ; k++ ) {
 
-            for ( int j=0; j< *(p_dim+1) ; j++ ) {
+        REAL( RESULT )[k] = a[k] ;
+    }
+    UNPROTECT(1) ; /* RESULT */
+    return RESULT ;
+}
 
-                if( *(p_dist + i + j * (*p_dim)) == 0 ) {
-                    /* dist = 0 */
 
-                    REAL(RESULT)[i + j*(*p_dim)] = sill + nugget ;
-                } else if ( *(p_dist+i+j*(*p_dim)) < rnge ) {
-                    /* dist < rnge */
+SEXP covar_scratch_get (
+        SEXP RELEASE ,      /* logical: free the cached buffers */
+        SEXP RESET          /* logical: reset the high-water mark */
+        )
+/* ****************************************************************************
+ * The function 'SEXP covar_scratch_get(...)' returns the figures of the
+ * scratch pool as named R vector.
+ * **************************************************************************/
+{
+    const char* names[] = {
+        "in.use", "high.water", "cached", "allocations", "reuses"
+    } ;
+    SEXP RESULT, NAMES ;
+
+    PROTECT( RESULT = allocVector( REALSXP, 5 ) ) ;
+    PROTECT( NAMES = allocVector( STRSXP, 5 ) ) ;
+    REAL( RESULT )[0] = (double) covar_scratch.in_use ;
+    REAL( RESULT )[1] = (double) covar_scratch.high_water ;
+    REAL( RESULT )[2] = (double) covar_scratch.cached ;
+    REAL( RESULT )[3] = (double) covar_scratch.allocations ;
+    REAL( RESULT )[4] = (double) covar_scratch.reuses ;
+    for ( int k = 0 ; k < 5 ; k++ ) {
+
+        SET_STRING_ELT( NAMES, k, mkChar( names[k] ) ) ;
+    }
+    setAttrib( RESULT, R_NamesSymbol, NAMES ) ;
 
-                    REAL(RESULT)[i + j*(*p_dim)] = gsl_interp_eval( 
-                            interpol, points, wendl, *(p_dist+i+j*(*p_dim)) , acc ) ;
-                } else {
-                    /* dist > rnge */
+    if ( *LOGICAL( RELEASE ) ) {
 
-                    REAL(RESULT)[i + j*(*p_dim)] = 0 ;
-                }
-            }
+        scratch_release( &covar_scratch ) ;
+    }
+    if ( *LOGICAL( RESET ) ) {
 
-        }
+        scratch_reset_peak( &covar_scratch ) ;
     }
-    gsl_interp_accel_free( acc ) ;
-    gsl_interp_free( interpol ) ;   
-    free(points) ;
-    free(wendl) ;
-    UNPROTECT(1) ; /* RESULT */
+    UNPROTECT(2) ; /* RESULT, NAMES */
     return RESULT ;
 }
 
-SEXP covar_vector_dir (
-        SEXP DIST ,         /* R vector containing distances */    
-        SEXP LENGTH ,       /* length of 'SEXP DIST' */ 
+
+SEXP covar_block (
+        SEXP COORDS ,       /* points (n x dim) or lower corners of boxes */
+        SEXP STARTS ,       /* first point of every block and n, or 'NULL' */
+        SEXP UPPER ,        /* upper corners of boxes or 'NULL' */
         SEXP MU ,           /* param. of the GW covariance fct */
         SEXP SMOOTHNESS ,   /* param. of the GW covariance fct */
         SEXP SILL ,         /* param. of the GW covariance fct */
@@ -359,73 +2396,110 @@ SEXP covar_vector_dir (
         SEXP NUGGET ,       /* param. of the GW covariance fct */
         SEXP ABSTOL ,       /* abs. tolerance for integration */
         SEXP RELTOL ,       /* rel. tolerance for integration */
-        SEXP EPS            /* treshhold below which values are
-                             * considered 0 */
-       )
+        SEXP EPS ,          /* threshold for distances considered 0 */
+        SEXP NBR_INTERPOL , /* nbr. of interpolation points or 0 */
+        SEXP TOL ,          /* rel. tolerance of the cubature */
+        SEXP MAX_POINTS ,   /* max. nbr. of cubature points per box */
+        SEXP THREADS        /* nbr. of threads or 0 */
+        )
 /* ****************************************************************************
- * The function 'int covar_vector_dir  (...)' calculates the Generalized
- * Wendland (GW) covariance function for all values of the R  vector 'DIST'.
- * If an error occures, the NULL pointer is returned.  The integral is
- * calculated with the non-adaptive Gauss-Kronrod algorithm from the 'GNU
- * Scientific Library'. 
+ * The function 'SEXP covar_block(...)' calculates the block-averaged GW
+ * covariance matrix of blocks given by points with 'gw_eval_blocks(...)' or
+ * of boxes with 'gw_eval_boxes(...)' from 'gwcovar.c'.
  * **************************************************************************/
 {
-    /* local representation for the SEXPs */
-    double* p_dist = REAL(DIST) ;
-    int length = *INTEGER( LENGTH ) ;
-    double mu = *REAL( MU ) ;
-    double smoothness = *REAL( SMOOTHNESS ) ;
-    double sill = *REAL( SILL ) ;
-    double rnge = *REAL( RNGE ) ;
-    double nugget = *REAL( NUGGET ) ;
-    double abstol = *REAL( ABSTOL ) ;
-    double reltol = *REAL( RELTOL ) ;
-    double eps = *REAL( EPS ) ;
+    int* p_dim = INTEGER( getAttrib( COORDS, R_DimSymbol ) ) ;
+    Gw_params params = {
+        *REAL( MU ), *REAL( SMOOTHNESS ), *REAL( SILL ), *REAL( RNGE ),
+        *REAL( NUGGET ), *REAL( ABSTOL ), *REAL( RELTOL ), *REAL( EPS )
+    } ;
+    int n_interpol = *INTEGER( NBR_INTERPOL ) ;
+    int threads = *INTEGER( THREADS ) ;
+    size_t nblocks ;
+    size_t* starts = NULL ;
+
+    if ( UPPER != R_NilValue ) {
+        /* the nugget has measure zero within a box */
+
+        nblocks = (size_t) p_dim[0] ;
+        params.nugget = 0 ;
+    } else {
 
-    /* declare and allocate matrix that will be returned */
+        nblocks = (size_t) XLENGTH( STARTS ) - 1 ;
+    }
+
+    /* the result is allocated first, since an allocation error would leak
+     * the block starts and the kernel */
     SEXP RESULT ;
-    PROTECT( 
-            RESULT = allocVector( REALSXP, length ) 
-           ) ;
+    PROTECT( RESULT = allocMatrix( REALSXP, (int) nblocks, (int) nblocks ) ) ;
+    if ( UPPER == R_NilValue ) {
 
-    gsl_set_error_handler_off() ;
-    Wendland_result result ;
+        starts = scratch_alloc( ( nblocks + 1 ) * sizeof(size_t) ) ;
+        if ( starts == NULL ) {
+
+            report_error( GW_ENOMEM, 0 ) ;
+            UNPROTECT(1) ; /* RESULT */
+            return R_NilValue ;
+        }
+        for ( size_t b = 0 ; b <= nblocks ; b++ ) {
 
-    for( int i = 0 ; i < length ; i++ ) {
+            starts[b] = (size_t) REAL( STARTS )[b] ;
+        }
+    }
 
-        if ( *(p_dist+i) < eps ) {
+    double t0 = stats_start() ;
+    Gw_kernel* kernel ;
+    int gsl_error = 0 ;
+    int ret ;
+    if ( n_interpol > 0 ) {
 
-            REAL(RESULT)[i] = sill + nugget ;
-        } else {
+        if ( !interpol_kernel( &kernel, &params, (size_t) n_interpol ) ) {
 
+            scratch_free( starts ) ;
+            UNPROTECT(1) ; /* RESULT */
+            return R_NilValue ;
+        }
+        ret = GW_OK ;
+    } else {
 
-            wendland ( 
+        ret = gw_kernel_new( &kernel, &params, 0, &covar_stats, &gsl_error ) ;
+    }
+    if ( ret != GW_OK ) {
 
-                    &result,
-                    *(p_dist+i)/rnge,  
-                    mu, 
-                    smoothness, 
-                    abstol, 
-                    reltol
-                    ) ;
+        scratch_free( starts ) ;
+        report_error( ret, gsl_error ) ;
+        UNPROTECT(1) ; /* RESULT */
+        return R_NilValue ;
+    }
+    t0 = stats_lap( STATS_TABLE, t0 ) ;
 
-            if ( check_wendland_errors( &result ) ) {
+    if ( UPPER != R_NilValue ) {
 
-                    REAL(RESULT)[i] = sill * result.result ;
-            } else {
+        ret = gw_eval_boxes( kernel, REAL( COORDS ), REAL( UPPER ), nblocks,
+                p_dim[1], *REAL( TOL ), (size_t) *INTEGER( MAX_POINTS ),
+                REAL( RESULT ), threads, &gsl_error ) ;
+    } else {
 
-                return R_NilValue ;
-            }
-        }         /* if clause */
-    } /* for loop */
+        ret = gw_eval_blocks( kernel, REAL( COORDS ), (size_t) p_dim[0],
+                p_dim[1], starts, nblocks, REAL( RESULT ), threads,
+                &gsl_error ) ;
+    }
+    gw_kernel_free( kernel ) ;
+    scratch_free( starts ) ;
+    if ( ret != GW_OK ) {
 
+        report_error( ret, gsl_error ) ;
+        UNPROTECT(1) ; /* RESULT */
+        return R_NilValue ;
+    }
+    stats_lap( n_interpol > 0 ? STATS_OUTPUT : STATS_KERNEL, t0 ) ;
     UNPROTECT(1) ; /* RESULT */
     return RESULT ;
 }
 
-SEXP covar_vector_interpol (
-        SEXP DIST ,         /* R vector containing distances */    
-        SEXP LENGTH ,       /* length of 'SEXP DIST' */ 
+
+SEXP covar_async_start (
+        SEXP DIST ,         /* distance matrix or vector of distances */
         SEXP MU ,           /* param. of the GW covariance fct */
         SEXP SMOOTHNESS ,   /* param. of the GW covariance fct */
         SEXP SILL ,         /* param. of the GW covariance fct */
@@ -433,98 +2507,133 @@ SEXP covar_vector_interpol (
         SEXP NUGGET ,       /* param. of the GW covariance fct */
         SEXP ABSTOL ,       /* abs. tolerance for integration */
         SEXP RELTOL ,       /* rel. tolerance for integration */
-        SEXP EPS ,          /* treshhold below which values are
-                             * considered 0 */
-        SEXP NBR_INTERPOL  /* nbr. of interpolation points */ 
+        SEXP EPS ,          /* threshold for distances considered 0 */
+        SEXP NBR_INTERPOL , /* nbr. of interpolation points or 0 */
+        SEXP WORKERS        /* nbr. of threads of the pool */
         )
-/* *****************************************************************************
- * The function 'int covar_vector_interpol  (...)' calculates the Generalized
- * Wendland (GW) covariance function for all values of the R  vector 'DIST'.
- * If an error occures, the NULL pointer is returned.  The integral is
- * calculated with the non-adaptive Gauss-Kronrod algorithm from the 'GNU
- * Scientific Library'. This function uses interpolation in order to speed
- * up the calculation.
-  * **************************************************************************/
+/* ****************************************************************************
+ * The function 'SEXP covar_async_start(...)' allocates the result on the
+ * main thread and queues its calculation to the thread pool of 'async.c'.
+ * **************************************************************************/
 {
-    /* local representation for the SEXPs */
-    double* p_dist = REAL(DIST) ;
-    int length = *INTEGER( LENGTH ) ;
-    double mu = *REAL( MU ) ;
-    double smoothness = *REAL( SMOOTHNESS ) ;
-    double sill = *REAL( SILL ) ;
-    double rnge = *REAL( RNGE ) ;
-    double nugget = *REAL( NUGGET ) ;
-    double abstol = *REAL( ABSTOL ) ;
-    double reltol = *REAL( RELTOL ) ;
-    double eps = *REAL( EPS ) ;
-    int n = *INTEGER( NBR_INTERPOL ) ;
-
-
-    /* declare and allocate matrix that will be returned */
-    SEXP RESULT ;
-    PROTECT( 
-            RESULT = allocVector( REALSXP, length ) 
-           ) ;
+    Covar_async* a = calloc( 1, sizeof(Covar_async) ) ;
+    if ( a == NULL ) {
 
+        report_error( GW_ENOMEM, 0 ) ;
+        return R_NilValue ;
+    }
+    Gw_params params = {
+        *REAL( MU ), *REAL( SMOOTHNESS ), *REAL( SILL ), *REAL( RNGE ),
+        *REAL( NUGGET ), *REAL( ABSTOL ), *REAL( RELTOL ), *REAL( EPS )
+    } ;
+    a->job.run = async_run ;
+    a->params = params ;
+    a->n_interpol = (size_t) *INTEGER( NBR_INTERPOL ) ;
+    a->chunk = covar_chunk ;
+
+    SEXP RESULT, PROT, PTR ;
+    if ( isMatrix( DIST ) ) {
+
+        int* p_dim = INTEGER( getAttrib( DIST, R_DimSymbol ) ) ;
+        a->nrow = (size_t) p_dim[0] ;
+        a->ncol = (size_t) p_dim[1] ;
+        PROTECT( RESULT = allocMatrix( REALSXP, p_dim[0], p_dim[1] ) ) ;
+    } else {
 
-    /* interpolation */
+        a->nrow = (size_t) XLENGTH( DIST ) ;
+        PROTECT( RESULT = allocVector( REALSXP, XLENGTH( DIST ) ) ) ;
+    }
+    a->dist = REAL( DIST ) ;
+    a->out = REAL( RESULT ) ;
+
+    /* the handle keeps the distances and the result alive while the job
+     * uses them */
+    PROTECT( PROT = allocVector( VECSXP, 2 ) ) ;
+    SET_VECTOR_ELT( PROT, 0, DIST ) ;
+    SET_VECTOR_ELT( PROT, 1, RESULT ) ;
+    PROTECT( PTR = R_MakeExternalPtr( a, install( "covar_async" ), PROT ) ) ;
+    R_RegisterCFinalizerEx( PTR, async_finalize, TRUE ) ;
+
+    int ret = async_kernel( a ) ;
+    if ( ret != GW_OK ) {
+
+        report_error( ret, 0 ) ;
+        async_finalize( PTR ) ;
+        UNPROTECT(3) ; /* RESULT, PROT, PTR */
+        return R_NilValue ;
+    }
+    if ( async_submit( &a->job, (size_t) *INTEGER( WORKERS ) ) != ASYNC_OK ) {
 
-    double *points = malloc( n * sizeof(double) ) ;
-    /* allocating array for the interpolation points */
+        REprintf( "%s\n", "No thread could be started" ) ;
+        async_finalize( PTR ) ;
+        UNPROTECT(3) ; /* RESULT, PROT, PTR */
+        return R_NilValue ;
+    }
+    UNPROTECT(3) ; /* RESULT, PROT, PTR */
+    return PTR ;
+}
 
-    double *wendl = malloc( n * sizeof(double) ) ;
-    /* allocatin array for the covariance values in the
-     * interpolation points */
 
-    double interval = rnge / ( (double) n - 1.0 ) ;
-    /* distance between interpolation points */
+SEXP covar_async_done (
+        SEXP PTR            /* handle from 'covar_async_start(...)' */
+        )
+/* ****************************************************************************
+ * The function 'SEXP covar_async_done(...)' returns whether the job of 'PTR'
+ * is done, without blocking.
+ * **************************************************************************/
+{
+    Covar_async* a = async_handle( PTR ) ;
+    if ( a == NULL ) {
 
+        return R_NilValue ;
+    }
+    return ScalarLogical( async_done( &a->job ) ) ;
+}
 
-    gsl_set_error_handler_off() ;
-    Wendland_result result ;
-    /* calculating the covariance fct. in the interpolation points 
-     * */
-    for ( int i=0 ; i < n ; ++i ) {
 
-        points[i] = i*interval ;
-        wendland( &result,  points[i]/rnge, mu, smoothness, abstol, reltol ) ;
+SEXP covar_async_get (
+        SEXP PTR            /* handle from 'covar_async_start(...)' */
+        )
+/* ****************************************************************************
+ * The function 'SEXP covar_async_get(...)' waits for the job of 'PTR' (a
+ * user interrupt cancels it) and returns its result, adding a table the job
+ * calculated to the store if it is writable.
+ * **************************************************************************/
+{
+    Covar_async* a = async_handle( PTR ) ;
+    if ( a == NULL ) {
 
-        if ( check_wendland_errors( &result ) ) {
+        return R_NilValue ;
+    }
+    while ( !async_wait_for( &a->job, 0.1 ) ) {
 
-            wendl[i]    = sill * result.result ;     
-        } else {
+        if ( check_interrupt() ) {
 
-            return R_NilValue ;
+            async_cancel( &a->job ) ;
+            async_wait( &a->job ) ;
         }
     }
+    if ( a->job.status != GW_OK ) {
 
-    /* initialisation for the interpolation */
-    gsl_interp *interpol = gsl_interp_alloc(gsl_interp_cspline , n ) ;
-    gsl_interp_init( interpol,  points, wendl, n ) ;
-    gsl_interp_accel *acc =  gsl_interp_accel_alloc() ;
-
-    /* calculating the covariance matrix */
-    for ( int i=0 ; i<length ; i++ ) {
-
-        if ( *(p_dist+i) < eps ) {
+        report_error( a->job.status == ASYNC_CANCELLED
+                ? GW_ECANCEL : a->job.status, a->gsl_error ) ;
+        return R_NilValue ;
+    }
 
-            REAL(RESULT)[i] = sill + nugget ;
-        } else if ( *(p_dist+i) < rnge ) {
+    if ( a->computed && !a->stored && covar_store.writable ) {
 
-            REAL(RESULT)[i] = 
-                gsl_interp_eval( interpol, points, wendl, 
-                        *(p_dist + i), acc )  ;
-        } else {
+        size_t n ;
+        const double* values = gw_kernel_table( a->kernel, &n ) ;
+        int ret = store_add( &covar_store, a->params.mu,
+                a->params.smoothness, a->params.abstol, a->params.reltol, n,
+                values ) ;
+        if ( ret != STORE_OK ) {
+            /* the result is not affected */
 
-            REAL(RESULT)[i] = 0 ;
+            REprintf( "Table could not be added to '%s': %s\n",
+                    covar_store.path, store_strerror( ret ) ) ;
         }
+        a->stored = 1 ;
     }
-
-    gsl_interp_accel_free( acc ) ;
-    gsl_interp_free( interpol ) ;   
-    free(points) ;
-    free(wendl) ;
-    UNPROTECT(1) ; /* RESULT */
-
-    return RESULT ;
+    return VECTOR_ELT( R_ExternalPtrProtected( PTR ), 1 ) ;
 }
@@ -200,6 +200,13 @@ SEXP covar_vector_dir (
  *  -> SEXP EPS:        Treshold below which a number is considered to be equal
  *                      to zero.
  *
+ *  -> SEXP BASE:       'NULL' or a double vector (type, range, smoothness)
+ *                      of a correlation function that is tapered by the GW
+ *                      function, i.e. the values are the product of both
+ *                      (type 1: exponential, 2: Matern, see 'Gw_base' in
+ *                      'gwcovar.h'). Both are evaluated in the same pass over
+ *                      the distances.
+ *
  *
  *
  *  ******************
@@ -219,7 +226,8 @@ SEXP covar_vector_dir (
         SEXP NUGGET ,       /* param. of the GW covariance fct */
         SEXP ABSTOL ,       /* abs. tolerance for integration */
         SEXP RELTOL ,       /* rel. tolerance for integration */
-        SEXP EPS           /* treshhold below which values are */
+        SEXP EPS ,          /* treshhold below which values are */
+        SEXP BASE           /* base correlation fct tapered or 'NULL' */
         ) ;
 
 SEXP covar_vector_interpol (
@@ -269,6 +277,11 @@ SEXP covar_vector_interpol (
  *  ->  SEXP NBR_INTERPOL:  Number of equidistant points in which the GW
  *                      covariance function is evaluated, if interpolation is
  *                      used.
+ *
+ *  -> SEXP BASE:       'NULL' or a base correlation function that is tapered,
+ *                      see 'covar_vector_dir(...)'. The product with the GW
+ *                      function is tabulated in the interpolation points.
+ *
  *  ******************
  *  ** Return value **
  *  ******************
@@ -288,7 +301,897 @@ SEXP covar_vector_interpol (
         SEXP RELTOL ,       /* rel. tolerance for integration */
         SEXP EPS ,          /* treshhold below which values are
                              * considered 0 */
-        SEXP NBR_INTERPOL  /* nbr. of interpolation points */ 
+        SEXP NBR_INTERPOL , /* nbr. of interpolation points */
+        SEXP BASE           /* base correlation fct tapered or 'NULL' */
+        ) ;
+
+SEXP covar_vector_dir_fill (
+/* ****************************************************************************
+ * The function 'SEXP covar_vector_dir_fill(...)' does the same as
+ * 'covar_vector_dir(...)', but the covariance values are written into the
+ * existing R vector 'OUT' instead of a newly allocated one. No memory is
+ * allocated, so a buffer can be reused over many calls (e.g. during the
+ * optimisation of the likelihood).
+ *
+ * 'OUT' is owned by the caller and has to be a double vector with at least
+ * 'LENGTH' elements. Its content is overwritten; every R object that shares
+ * the vector sees the new values. 'OUT' may be 'DIST' itself, in which case
+ * the distances are replaced by the covariances.
+ *
+ *  ****************
+ *  ** Arguments: **
+ *  ****************
+ *
+ *  -> SEXP OUT:        Vector the covariance values are written to.
+ *
+ *  All other arguments are the same as for 'covar_vector_dir(...)'.
+ *
+ *  ******************
+ *  ** Return value **
+ *  ******************
+ *
+ *  'SEXP covar_vector_dir_fill(...)' returns 'OUT'. If an error occures,
+ *  'NULL' is returned and the content of 'OUT' is undefined.
+ *
+ * ****************************************************************************/
+        SEXP DIST ,         /* R vector containing distances */    
+        SEXP OUT ,          /* R vector the covariances are written to */
+        SEXP LENGTH ,       /* length of 'SEXP DIST' */ 
+        SEXP MU ,           /* param. of the GW covariance fct */
+        SEXP SMOOTHNESS ,   /* param. of the GW covariance fct */
+        SEXP SILL ,         /* param. of the GW covariance fct */
+        SEXP RNGE ,         /* param. of the GW covariance fct */
+        SEXP NUGGET ,       /* param. of the GW covariance fct */
+        SEXP ABSTOL ,       /* abs. tolerance for integration */
+        SEXP RELTOL ,       /* rel. tolerance for integration */
+        SEXP EPS ,          /* treshhold below which values are */
+        SEXP BASE           /* base correlation fct tapered or 'NULL' */
+        ) ;
+
+SEXP covar_vector_interpol_fill (
+/* ****************************************************************************
+ * The function 'SEXP covar_vector_interpol_fill(...)' does the same as
+ * 'covar_vector_interpol(...)', but the covariance values are written into
+ * the existing R vector 'OUT'. The ownership rules are the same as for
+ * 'covar_vector_dir_fill(...)'.
+ *
+ *  ****************
+ *  ** Arguments: **
+ *  ****************
+ *
+ *  -> SEXP OUT:        Vector the covariance values are written to.
+ *
+ *  All other arguments are the same as for 'covar_vector_interpol(...)'.
+ *
+ *  ******************
+ *  ** Return value **
+ *  ******************
+ *
+ *  'SEXP covar_vector_interpol_fill(...)' returns 'OUT'. If an error
+ *  occures, 'NULL' is returned and the content of 'OUT' is undefined.
+ *
+ * ****************************************************************************/
+        SEXP DIST ,         /* R vector containing distances */    
+        SEXP OUT ,          /* R vector the covariances are written to */
+        SEXP LENGTH ,       /* length of 'SEXP DIST' */ 
+        SEXP MU ,           /* param. of the GW covariance fct */
+        SEXP SMOOTHNESS ,   /* param. of the GW covariance fct */
+        SEXP SILL ,         /* param. of the GW covariance fct */
+        SEXP RNGE ,         /* param. of the GW covariance fct */
+        SEXP NUGGET ,       /* param. of the GW covariance fct */
+        SEXP ABSTOL ,       /* abs. tolerance for integration */
+        SEXP RELTOL ,       /* rel. tolerance for integration */
+        SEXP EPS ,          /* treshhold below which values are
+                             * considered 0 */
+        SEXP NBR_INTERPOL , /* nbr. of interpolation points */
+        SEXP BASE           /* base correlation fct tapered or 'NULL' */
+        ) ;
+
+SEXP covar_append (
+/* *****************************************************************************
+ * The function 'SEXP covar_append(...)' calculates the rows and columns that
+ * are added to a GW covariance matrix when new locations are appended to the
+ * existing ones. Only pairs of locations closer than the range are evaluated;
+ * they are found with a grid index over the locations, so the number of
+ * evaluations depends on the new locations only. Building the grid index of
+ * the existing locations takes time linear in their number.
+ *
+ *
+ *  ****************
+ *  ** Arguments: **
+ *  ****************
+ *
+ *  -> SEXP LOC_OLD:    Coordinates of the existing locations (R matrix, one
+ *                      location per row).
+ *
+ *  -> SEXP LOC_NEW:    Coordinates of the new locations (R matrix with the
+ *                      same number of columns as 'LOC_OLD').
+ *
+ *  -> SEXP MU:         Parameter of the GW covariance function
+ *
+ *  -> SEXP SMOOTHNESS: Parameter of the GW covariance function
+ *
+ *  -> SEXP SILL:       Parameter of the GW covariance function. 'SILL'
+ *                      controls the variance at the locations
+ *
+ *  -> SEXP RNGE:       Parameter of the GW covariance function. 'RNGE'
+ *                      controls the radius of the compact support of the GW
+ *                      covariance funcion.
+ *
+ *  -> SEXP NUGGET:     Parameter of the GW covariance function. 'NUGGET'
+ *                      controls the nugget of the GW covariance function.
+ *
+ *  -> SEXP ABSTOL:     Parameter for the numerical integration: absolute
+ *                      tolerance.
+ *
+ *  -> SEXP RELTOL:     Parameter for the numerical integration: relative
+ *                      tolerance.
+ *
+ *  -> SEXP EPS:        Treshold below which a number is considered to be equal
+ *                      to zero.
+ *
+ *  ******************
+ *  ** Return value **
+ *  ******************
+ *
+ *  'SEXP covar_append(...)' returns a list with the triplets (1-based row
+ *  index, column index, value) of the cross covariances between the new and
+ *  the old locations ('cross.i', 'cross.j', 'cross.values') and of the
+ *  covariances among the new locations ('within.i', 'within.j',
+ *  'within.values'). If an error occures, 'NULL' is returned.
+ *
+ * ****************************************************************************/
+        SEXP LOC_OLD ,      /* coordinates of the existing locations */
+        SEXP LOC_NEW ,      /* coordinates of the appended locations */
+        SEXP MU ,           /* param. of the GW covariance fct */
+        SEXP SMOOTHNESS ,   /* param. of the GW covariance fct */
+        SEXP SILL ,         /* param. of the GW covariance fct */
+        SEXP RNGE ,         /* param. of the GW covariance fct */
+        SEXP NUGGET ,       /* param. of the GW covariance fct */
+        SEXP ABSTOL ,       /* abs. tolerance for integration */
+        SEXP RELTOL ,       /* rel. tolerance for integration */
+        SEXP EPS            /* treshhold below which values are
+                             * considered 0 */
+        ) ;
+
+SEXP covar_vector_auto (
+/* ****************************************************************************
+ * The function 'SEXP covar_vector_auto(...)' calculates the GW covariance
+ * function for all values of the R vector 'DIST' (which may also be a dense
+ * distance matrix). The evaluation strategy is chosen automatically by
+ * 'plan_fill(...)' from 'planner.c': the closed form if one exists for the
+ * smoothness parameter, a cubic spline table whose accuracy has been checked
+ * against the tolerances, one integration per unique distance or one
+ * integration per distance, whichever is expected to be the fastest. If the
+ * table store is open (see 'covar_store_open(...)'), tables are looked up
+ * there before they are built and added to it afterwards.
+ *
+ *
+ *  ****************
+ *  ** Arguments: **
+ *  ****************
+ *
+ *  -> SEXP DIST:       R vector containing distances.
+ *
+ *  -> SEXP OUT:        'NULL' or a double vector of the same length as
+ *                      'DIST' the result is written to (see
+ *                      'covar_vector_dir_fill(...)'). May be 'DIST' itself.
+ *
+ *  The other arguments are the same as for 'covar_vector_dir(...)'.
+ *
+ *  ******************
+ *  ** Return value **
+ *  ******************
+ *
+ *  'SEXP covar_vector_auto(...)' returns a list of two elements: an R vector
+ *  containing the covariance values (the vector 'OUT' if given, which is
+ *  filled in place and not given any attribute) and a list with the chosen
+ *  strategy, the reason for the choice, the number of distances within the
+ *  range, the number of unique distances among them, the size of the table
+ *  and its largest error relative to the tolerance.
+ *  If an error occures, 'NULL' is returned.
+ *
+ * ****************************************************************************/
+        SEXP DIST ,         /* R vector containing distances */
+        SEXP OUT ,          /* R vector for the result or 'NULL' */
+        SEXP MU ,           /* param. of the GW covariance fct */
+        SEXP SMOOTHNESS ,   /* param. of the GW covariance fct */
+        SEXP SILL ,         /* param. of the GW covariance fct */
+        SEXP RNGE ,         /* param. of the GW covariance fct */
+        SEXP NUGGET ,       /* param. of the GW covariance fct */
+        SEXP ABSTOL ,       /* abs. tolerance for integration */
+        SEXP RELTOL ,       /* rel. tolerance for integration */
+        SEXP EPS            /* treshhold below which values are
+                             * considered 0 */
+        ) ;
+
+SEXP covar_stats_enable (
+/* ****************************************************************************
+ * The function 'SEXP covar_stats_enable(...)' switches the collection of
+ * statistics about the calculations on ('ENABLE' is 'TRUE') or off. While
+ * enabled, all entry points record the number of numerical integrations and
+ * integrand evaluations, the estimated integration errors, the GSL errors
+ * and the wall time spent building tables, evaluating the GW function and
+ * writing the output. Returns the previous state as R logical.
+ * ****************************************************************************/
+        SEXP ENABLE         /* logical: enable the statistics */
+        ) ;
+
+SEXP covar_stats_get (
+/* ****************************************************************************
+ * The function 'SEXP covar_stats_get(...)' returns the statistics collected
+ * by the entry points as named R list (see 'cov.wend.stats()' in R). If
+ * 'RESET' is 'TRUE', all counters are set to zero afterwards.
+ * ****************************************************************************/
+        SEXP RESET          /* logical: reset the statistics */
+        ) ;
+
+
+SEXP covar_store_open (
+/* ****************************************************************************
+ * The function 'SEXP covar_store_open(...)' opens the table store file
+ * 'PATH' (see 'store.h') for the interpolation tables of
+ * 'covar_interpol(...)' and 'covar_vector_interpol(...)'. While a store is
+ * open, these functions take the table from the store if it contains one
+ * for the same parameters mu, smoothness, 'ABSTOL', 'RELTOL' and number of
+ * points; otherwise the table is calculated and, if 'WRITABLE' is 'TRUE',
+ * added to the store. The store stays open for the rest of the R session,
+ * also in forked child processes. A previously opened store is closed; if
+ * 'PATH' is 'NULL' no store is used anymore.
+ *
+ *
+ *  ****************
+ *  ** Arguments: **
+ *  ****************
+ *
+ *  -> SEXP PATH:       character string or 'NULL'.
+ *
+ *  -> SEXP WRITABLE:   logical.
+ *
+ *  ******************
+ *  ** Return value **
+ *  ******************
+ *
+ *  The same as 'covar_store_info()', or 'NULL' if the file could not be
+ *  opened (e.g. because it is not a store or was written by another
+ *  version).
+ *
+ * ****************************************************************************/
+        SEXP PATH ,         /* path of the store file or 'NULL' */
+        SEXP WRITABLE       /* logical: add new tables to the file */
+        ) ;
+
+SEXP covar_store_info (
+/* ****************************************************************************
+ * The function 'SEXP covar_store_info(...)' returns a named R list with the
+ * path of the open table store ('NA' if none), whether it is writable, the
+ * number of tables and the size of the mapped file in bytes, and the
+ * version of the file format.
+ * ****************************************************************************/
+        void
+        ) ;
+
+
+SEXP covar_surface_build (
+/* ****************************************************************************
+ * The function 'SEXP covar_surface_build(...)' tabulates the GW correlation
+ * function over the normalised distance, mu and the smoothness (see
+ * 'surface.h'), writes the surface to the file 'PATH' and opens it as
+ * 'covar_surface_open(...)' does. An estimate of the interpolation error,
+ * checked at points within every cell of the grid, is recorded in the file
+ * (an empirical estimate, not a proven bound).
+ *
+ *
+ *  ****************
+ *  ** Arguments: **
+ *  ****************
+ *
+ *  -> SEXP PATH:       character string
+ *
+ *  -> SEXP N:          number of grid points in r, mu and kappa (3
+ *                      integers)
+ *
+ *  -> SEXP MU, KAPPA:  lower and upper bounds of the box of mu and kappa
+ *                      (2 doubles each)
+ *
+ *  -> SEXP ABSTOL, RELTOL:
+ *                      tolerances of the numerical integration
+ *
+ *  -> SEXP THREADS:    number of threads (integer), 0 for the default of
+ *                      OpenMP
+ *
+ *  ******************
+ *  ** Return value **
+ *  ******************
+ *
+ *  The same as 'covar_surface_info()', or 'NULL' on error.
+ *
+ * ****************************************************************************/
+        SEXP PATH ,         /* path of the surface file */
+        SEXP N ,            /* nbr. of grid points in r, mu and kappa */
+        SEXP MU ,           /* lower and upper bound of mu */
+        SEXP KAPPA ,        /* lower and upper bound of kappa */
+        SEXP ABSTOL ,       /* abs. tolerance for integration */
+        SEXP RELTOL ,       /* rel. tolerance for integration */
+        SEXP THREADS        /* nbr. of threads or 0 */
+        ) ;
+
+SEXP covar_surface_open (
+/* ****************************************************************************
+ * The function 'SEXP covar_surface_open(...)' opens the surface file 'PATH'
+ * (character string, see 'surface.h'). While a surface is open, the
+ * interpolation tables of all functions with an interpolation table are
+ * interpolated from the surface if it covers their mu and smoothness and
+ * its error estimate does not exceed their absolute tolerance, without any
+ * numerical integration; the tables have the size of the surface in r
+ * then, whatever number of points is requested. Other parameters and
+ * tighter tolerances fall back to the table store and to numerical
+ * integration. A
+ * previously opened surface is closed; if 'PATH' is 'NULL' no surface is
+ * used anymore. Returns the same as 'covar_surface_info()', or 'NULL' if
+ * the file could not be opened.
+ * ****************************************************************************/
+        SEXP PATH           /* path of the surface file or 'NULL' */
+        ) ;
+
+SEXP covar_surface_info (
+/* ****************************************************************************
+ * The function 'SEXP covar_surface_info(...)' returns a named R list with
+ * whether a surface is open and, if so, its grid sizes, the bounds of mu
+ * and kappa, the tolerances of the integration and the error estimate
+ * found when it was built.
+ * ****************************************************************************/
+        void
+        ) ;
+
+SEXP covar_sim (
+/* ****************************************************************************
+ * The function 'SEXP covar_sim(...)' draws 'NSIM' realisations of a zero mean
+ * Gaussian random field x = R^T z from the sparse Cholesky factor R of its
+ * (permuted) covariance matrix, see 'gw_sim_fill(...)' in 'sim.h'.
+ *
+ *
+ *  ****************
+ *  ** Arguments: **
+ *  ****************
+ *
+ *  -> SEXP ENTRIES, COLINDICES, ROWPOINTERS:
+ *                      upper triangular Cholesky factor in the format of
+ *                      'spam' ('as.spam(chol(C))').
+ *
+ *  -> SEXP PIVOT:      integer vector, 'ordering(chol(C))'.
+ *
+ *  -> SEXP NSIM:       number of realisations (double).
+ *
+ *  -> SEXP SEED:       integer vector of length 2, key of the random number
+ *                      generator.
+ *
+ *  -> SEXP OUT:        'NULL' or a double matrix with n rows and 'NSIM'
+ *                      columns the realisations are written to.
+ *
+ *  -> SEXP PATH:       'NULL' or the path of a file the realisations are
+ *                      written to as raw doubles instead.
+ *
+ *  -> SEXP BLOCK:      number of realisations calculated together
+ *                      (integer).
+ *
+ *  ******************
+ *  ** Return value **
+ *  ******************
+ *
+ *  The matrix of realisations ('OUT' if given) or 'PATH', with the attribute
+ *  "replicates.per.second" unless 'OUT' is given ('OUT' is filled in place
+ *  and not given an attribute). 'NULL' on error.
+ *
+ * ****************************************************************************/
+        SEXP ENTRIES ,      /* entries of the Cholesky factor */
+        SEXP COLINDICES ,   /* column indices of the Cholesky factor */
+        SEXP ROWPOINTERS ,  /* row pointers of the Cholesky factor */
+        SEXP PIVOT ,        /* permutation of the Cholesky factor */
+        SEXP NSIM ,         /* number of realisations */
+        SEXP SEED ,         /* two integers */
+        SEXP OUT ,          /* R matrix for the result or 'NULL' */
+        SEXP PATH ,         /* file for the result or 'NULL' */
+        SEXP BLOCK          /* nbr. of realisations calculated together */
+        ) ;
+
+SEXP covar_vecchia (
+/* ****************************************************************************
+ * The function 'SEXP covar_vecchia(...)' returns the Vecchia approximation of
+ * the log-likelihood of the observations 'Y' in the locations 'COORDS' of a
+ * zero mean Gaussian random field with GW covariance, conditioning every
+ * location on at most 'NEIGHBOURS' nearest preceding locations within the
+ * range (see 'gw_vecchia_loglik(...)' in 'vecchia.h').
+ *
+ *
+ *  ****************
+ *  ** Arguments: **
+ *  ****************
+ *
+ *  -> SEXP COORDS:     double matrix of the (ordered) coordinates, one
+ *                      location per row.
+ *
+ *  -> SEXP Y:          double vector of the observations.
+ *
+ *  -> SEXP NEIGHBOURS: maximal number of neighbours (integer).
+ *
+ *  -> SEXP MU, ..., EPS:
+ *                      parameters as for 'covar_vector_dir(...)'.
+ *
+ *  -> SEXP N_INTERPOL: size of the interpolation table (integer), '0' for
+ *                      numerical integration of every entry.
+ *
+ *  ******************
+ *  ** Return value **
+ *  ******************
+ *
+ *  The log-likelihood, 'NULL' on error.
+ *
+ * ****************************************************************************/
+        SEXP COORDS ,       /* matrix of coordinates (n x dim) */
+        SEXP Y ,            /* observations */
+        SEXP NEIGHBOURS ,   /* max. nbr. of neighbours */
+        SEXP MU ,           /* param. of the GW covariance fct */
+        SEXP SMOOTHNESS ,   /* param. of the GW covariance fct */
+        SEXP SILL ,         /* param. of the GW covariance fct */
+        SEXP RNGE ,         /* param. of the GW covariance fct */
+        SEXP NUGGET ,       /* param. of the GW covariance fct */
+        SEXP ABSTOL ,       /* abs. tolerance for integration */
+        SEXP RELTOL ,       /* rel. tolerance for integration */
+        SEXP EPS ,          /* treshhold below which values are
+                             * considered 0 */
+        SEXP N_INTERPOL     /* size of the interpolation table or 0 */
+        ) ;
+
+SEXP covar_vector_compact (
+/* ****************************************************************************
+ * The function 'SEXP covar_vector_compact(...)' calculates the GW covariance
+ * matrix for a distance matrix of class 'spam' and drops the entries whose
+ * distance is at least the range while the values are written. If the
+ * pattern of the distance matrix has been calculated with a larger radius
+ * than the range (e.g. 'nearest.dist(delta=...)' with the initial range of
+ * an optimisation), the result has fewer stored zeros, which reduces the
+ * memory and the fill of a Cholesky factorisation.
+ *
+ *
+ *  ****************
+ *  ** Arguments: **
+ *  ****************
+ *
+ *  -> SEXP DIST, COLINDICES, ROWPOINTERS:
+ *                      the slots 'entries', 'colindices' and 'rowpointers'
+ *                      of the distance matrix.
+ *
+ *  -> SEXP MU, ..., EPS:
+ *                      parameters as for 'covar_vector_dir(...)'.
+ *
+ *  -> SEXP NBR_INTERPOL:
+ *                      size of the interpolation table (integer), '0' for
+ *                      numerical integration of every entry.
+ *
+ *  -> SEXP BASE:       'NULL' or a base correlation function that is tapered,
+ *                      see 'covar_vector_dir(...)'.
+ *
+ *  ******************
+ *  ** Return value **
+ *  ******************
+ *
+ *  A list with the new 'entries', 'colindices' and 'rowpointers' (the
+ *  dimension is unchanged), 'NULL' on error.
+ *
+ * ****************************************************************************/
+        SEXP DIST ,         /* entries of the spam distance matrix */
+        SEXP COLINDICES ,   /* column indices of the distance matrix */
+        SEXP ROWPOINTERS ,  /* row pointers of the distance matrix */
+        SEXP MU ,           /* param. of the GW covariance fct */
+        SEXP SMOOTHNESS ,   /* param. of the GW covariance fct */
+        SEXP SILL ,         /* param. of the GW covariance fct */
+        SEXP RNGE ,         /* param. of the GW covariance fct */
+        SEXP NUGGET ,       /* param. of the GW covariance fct */
+        SEXP ABSTOL ,       /* abs. tolerance for integration */
+        SEXP RELTOL ,       /* rel. tolerance for integration */
+        SEXP EPS ,          /* treshhold below which values are
+                             * considered 0 */
+        SEXP NBR_INTERPOL , /* nbr. of interpolation points or 0 */
+        SEXP BASE           /* base correlation fct tapered or 'NULL' */
+        ) ;
+
+SEXP covar_progress_set (
+/* ****************************************************************************
+ * The function 'SEXP covar_progress_set(...)' controls how long calculations
+ * ('covar_m_dist(...)', 'covar_interpol(...)', the 'covar_vector_*'
+ * functions and 'covar_append(...)') report their progress. They work in
+ * chunks of about 'CHUNK' values and check for a user interrupt after each
+ * chunk; if 'FUN' is not 'NULL', it is called as 'FUN(done, total)'
+ * afterwards. An interrupt, an error in 'FUN' or a return value 'FALSE'
+ * cancels the calculation: the scratch memory is released and 'NULL' is
+ * returned (with the message "calculation cancelled"). 'FUN' may use the
+ * package itself (e.g. close the store); calculations started from 'FUN'
+ * do not call 'FUN' again.
+ *
+ *
+ *  ****************
+ *  ** Arguments: **
+ *  ****************
+ *
+ *  -> SEXP FUN:        R function with two arguments or 'NULL'. It is kept
+ *                      until the next call.
+ *
+ *  -> SEXP CHUNK:      number of values between two checks (double).
+ *
+ *  ******************
+ *  ** Return value **
+ *  ******************
+ *
+ *  'NULL'
+ *
+ * ****************************************************************************/
+        SEXP FUN ,          /* R function or 'NULL' */
+        SEXP CHUNK          /* nbr. of values between two checks */
+        ) ;
+
+SEXP covar_coords (
+/* ****************************************************************************
+ * The function 'SEXP covar_coords(...)' returns the dense GW covariance
+ * matrix (standard R matrix) of the locations 'COORDS'. The distances are
+ * calculated in tiles together with the covariances (see
+ * 'gw_eval_coords(...)' in 'gwcovar.h'), so no distance matrix is needed.
+ *
+ *
+ *  ****************
+ *  ** Arguments: **
+ *  ****************
+ *
+ *  -> SEXP COORDS:     n x dim matrix (double) with one location per row
+ *
+ *  -> SEXP MU, SMOOTHNESS, SILL, RNGE, NUGGET, ABSTOL, RELTOL, EPS:
+ *                      see 'covar_vector_dir(...)'
+ *
+ *  -> SEXP NBR_INTERPOL:
+ *                      size of the interpolation table (integer) or 0 to
+ *                      integrate every covariance numerically
+ *
+ *  ******************
+ *  ** Return value **
+ *  ******************
+ *
+ *  n x n matrix or 'NULL' on error
+ *
+ * ****************************************************************************/
+        SEXP COORDS ,       /* coordinates of the locations */
+        SEXP MU ,           /* param. of the GW covariance fct */
+        SEXP SMOOTHNESS ,   /* param. of the GW covariance fct */
+        SEXP SILL ,         /* param. of the GW covariance fct */
+        SEXP RNGE ,         /* param. of the GW covariance fct */
+        SEXP NUGGET ,       /* param. of the GW covariance fct */
+        SEXP ABSTOL ,       /* abs. tolerance for integration */
+        SEXP RELTOL ,       /* rel. tolerance for integration */
+        SEXP EPS ,          /* treshhold below which values are
+                             * considered 0 */
+        SEXP NBR_INTERPOL   /* nbr. of interpolation points or 0 */
+        ) ;
+
+SEXP covar_sfc_order (
+/* ****************************************************************************
+ * The function 'SEXP covar_sfc_order(...)' returns the order of the
+ * locations 'COORDS' along a space-filling curve (see 'sfc_order(...)' in
+ * 'sfc.h'). Building the covariance matrix in this order keeps neighbouring
+ * locations close in memory and the matrix clustered around the diagonal,
+ * which reduces the fill-in of its Cholesky factor.
+ *
+ *
+ *  ****************
+ *  ** Arguments: **
+ *  ****************
+ *
+ *  -> SEXP COORDS:     n x dim matrix (double) with one location per row
+ *
+ *  -> SEXP CURVE:      0 for the Hilbert curve, 1 for the Morton curve
+ *                      (integer)
+ *
+ *  ******************
+ *  ** Return value **
+ *  ******************
+ *
+ *  permutation of 1, ..., n (integer): the k-th location on the curve is
+ *  'COORDS[RESULT[k],]'; 'NULL' on error
+ *
+ * ****************************************************************************/
+        SEXP COORDS ,       /* coordinates of the locations */
+        SEXP CURVE          /* 0: Hilbert curve, 1: Morton curve */
+        ) ;
+
+SEXP covar_multi (
+/* ****************************************************************************
+ * The function 'SEXP covar_multi(...)' returns the covariance matrix of 'P'
+ * variables from one distance matrix, evaluating the p(p+1)/2 GW covariance
+ * functions of all pairs of variables in a single pass over the distances
+ * (see 'gw_eval_multi_matrix(...)' in 'gwcovar.h'). The rows and columns
+ * are interleaved by location: row (i-1)*p + a belongs to location i and
+ * variable a. The validity of the parameters has to be checked by the
+ * caller.
+ *
+ *
+ *  ****************
+ *  ** Arguments: **
+ *  ****************
+ *
+ *  -> SEXP DIST:       n x n distance matrix or the entries of a distance
+ *                      matrix of class 'spam'
+ *
+ *  -> SEXP COLINDICES, ROWPOINTERS:
+ *                      column indices and row pointers of the spam matrix
+ *                      (integer) or 'NULL' for a standard R matrix
+ *
+ *  -> SEXP P:          number of variables (integer)
+ *
+ *  -> SEXP PARAMS:     p x p x 5 array (double) with the range, mu (the
+ *                      'MU' of 'covar_vector_dir(...)'), smoothness, sill
+ *                      and nugget of each pair of variables; only the upper
+ *                      triangle (a <= b) is used
+ *
+ *  -> SEXP ABSTOL, RELTOL, EPS:
+ *                      see 'covar_vector_dir(...)'
+ *
+ *  -> SEXP NBR_INTERPOL:
+ *                      size of the interpolation tables (integer) or 0 to
+ *                      integrate every covariance numerically
+ *
+ *  ******************
+ *  ** Return value **
+ *  ******************
+ *
+ *  np x np matrix for a standard R matrix, list( entries, colindices,
+ *  rowpointers ) of the np x np spam matrix otherwise; 'NULL' on error
+ *
+ * ****************************************************************************/
+        SEXP DIST ,         /* distances (matrix or entries of spam) */
+        SEXP COLINDICES ,   /* column indices of spam or 'NULL' */
+        SEXP ROWPOINTERS ,  /* row pointers of spam or 'NULL' */
+        SEXP P ,            /* nbr. of variables */
+        SEXP PARAMS ,       /* p x p x 5 array of GW parameters */
+        SEXP ABSTOL ,       /* abs. tolerance for integration */
+        SEXP RELTOL ,       /* rel. tolerance for integration */
+        SEXP EPS ,          /* treshhold below which values are
+                             * considered 0 */
+        SEXP NBR_INTERPOL   /* nbr. of interpolation points or 0 */
+        ) ;
+
+SEXP covar_dense (
+/* ****************************************************************************
+ * The function 'SEXP covar_dense(...)' returns the dense GW covariance
+ * matrix of a symmetric distance matrix, calculated in parallel with
+ * 'gw_eval_matrix_parallel(...)' (see 'gwcovar.h'). Each thread first
+ * touches the pages of the columns it calculates, so on a NUMA machine the
+ * matrix is spread over the nodes of the threads and later parallel passes
+ * with the same partition ('covar_ext_matvec(...)') read local memory. The
+ * output can be backed by huge pages and kept outside of the R heap.
+ *
+ *
+ *  ****************
+ *  ** Arguments: **
+ *  ****************
+ *
+ *  -> SEXP DIST:       n x n distance matrix
+ *
+ *  -> SEXP MU, SMOOTHNESS, SILL, RNGE, NUGGET, ABSTOL, RELTOL, EPS:
+ *                      see 'covar_m_dist(...)'
+ *
+ *  -> SEXP NBR_INTERPOL:
+ *                      size of the interpolation table (integer) or 0 to
+ *                      integrate every covariance numerically
+ *
+ *  -> SEXP THREADS:    number of threads (integer), 0 for the default of
+ *                      OpenMP
+ *
+ *  -> SEXP PAGES:      0: normal pages, 1: transparent huge pages, 2:
+ *                      explicit huge pages, falling back to transparent
+ *                      ones (integer, see 'mem.h'). For an R matrix only
+ *                      transparent huge pages can be requested.
+ *
+ *  -> SEXP EXTPTR:     'TRUE' to return an external pointer to memory
+ *                      mapped outside of the R heap, 'FALSE' for a standard
+ *                      R matrix (logical)
+ *
+ *  ******************
+ *  ** Return value **
+ *  ******************
+ *
+ *  n x n matrix or external pointer (released by the garbage collector);
+ *  'NULL' on error
+ *
+ * ****************************************************************************/
+        SEXP DIST ,         /* distance matrix */
+        SEXP MU ,           /* param. of the GW covariance fct */
+        SEXP SMOOTHNESS ,   /* param. of the GW covariance fct */
+        SEXP SILL ,         /* param. of the GW covariance fct */
+        SEXP RNGE ,         /* param. of the GW covariance fct */
+        SEXP NUGGET ,       /* param. of the GW covariance fct */
+        SEXP ABSTOL ,       /* abs. tolerance for integration */
+        SEXP RELTOL ,       /* rel. tolerance for integration */
+        SEXP EPS ,          /* threshold for distances considered 0 */
+        SEXP NBR_INTERPOL , /* nbr. of interpolation points or 0 */
+        SEXP THREADS ,      /* nbr. of threads or 0 */
+        SEXP PAGES ,        /* kind of pages, see 'mem.h' */
+        SEXP EXTPTR         /* 'TRUE' for an external pointer */
+        ) ;
+
+
+SEXP covar_ext_matvec (
+/* ****************************************************************************
+ * The function 'SEXP covar_ext_matvec(...)' returns the product of the
+ * external matrix 'PTR' (from 'covar_dense(...)') with the vector 'V'
+ * (double), calculated with 'THREADS' threads (integer, 0 for the default)
+ * in the partition used to calculate the matrix. Returns 'NULL' on error.
+ * ****************************************************************************/
+        SEXP PTR ,          /* external matrix from 'covar_dense(...)' */
+        SEXP V ,            /* vector */
+        SEXP THREADS        /* nbr. of threads or 0 */
+        ) ;
+
+
+SEXP covar_ext_get (
+/* ****************************************************************************
+ * The function 'SEXP covar_ext_get(...)' returns a copy of the external
+ * matrix 'PTR' (from 'covar_dense(...)') as a standard R matrix or 'NULL'
+ * on error.
+ * ****************************************************************************/
+        SEXP PTR            /* external matrix from 'covar_dense(...)' */
+        ) ;
+
+SEXP covar_scratch_get (
+/* ****************************************************************************
+ * The function 'SEXP covar_scratch_get(...)' returns the figures of the pool
+ * of scratch buffers (see 'scratch.h') that all calculations share: the
+ * bytes currently in use, the high-water mark, the bytes kept for reuse, and
+ * the number of buffers allocated from the system and reused. Afterwards the
+ * kept buffers are freed if 'RELEASE' is 'TRUE' and the high-water mark and
+ * the counters are reset if 'RESET' is 'TRUE' (both logical).
+ * ****************************************************************************/
+        SEXP RELEASE ,      /* logical: free the cached buffers */
+        SEXP RESET          /* logical: reset the high-water mark */
+        ) ;
+
+
+SEXP covar_block (
+/* ****************************************************************************
+ * The function 'SEXP covar_block(...)' returns the block-averaged (change of
+ * support) GW covariance matrix of areal blocks: entry (a,b) is the mean of
+ * the covariance function over the pairs of points of the blocks a and b.
+ * Blocks are either given by points, e.g. samples within polygons (averaged
+ * exactly with 'gw_eval_blocks(...)'), or as axis-aligned boxes (averaged
+ * by adaptive cubature with 'gw_eval_boxes(...)', see 'gwcovar.h').
+ *
+ *
+ *  ****************
+ *  ** Arguments: **
+ *  ****************
+ *
+ *  -> SEXP COORDS:     n x dim matrix of the points of all blocks, block
+ *                      after block, or nblocks x dim matrix of the lower
+ *                      corners of the boxes
+ *
+ *  -> SEXP STARTS:     0-based index of the first point of every block
+ *                      followed by n (double, nblocks+1 entries); ignored
+ *                      for boxes
+ *
+ *  -> SEXP UPPER:      nblocks x dim matrix of the upper corners of the
+ *                      boxes or 'NULL' for blocks given by points
+ *
+ *  -> SEXP MU, SMOOTHNESS, SILL, RNGE, NUGGET, ABSTOL, RELTOL, EPS:
+ *                      see 'covar_m_dist(...)'; the nugget is only used for
+ *                      points, since it has measure zero within a box
+ *
+ *  -> SEXP NBR_INTERPOL:
+ *                      size of the interpolation table (integer) or 0 to
+ *                      integrate every covariance numerically
+ *
+ *  -> SEXP TOL:        relative tolerance of the cubature over boxes
+ *
+ *  -> SEXP MAX_POINTS: maximal number of cubature points per box (integer)
+ *
+ *  -> SEXP THREADS:    number of threads (integer), 0 for the default of
+ *                      OpenMP
+ *
+ *  ******************
+ *  ** Return value **
+ *  ******************
+ *
+ *  nblocks x nblocks matrix; 'NULL' on error
+ *
+ * ****************************************************************************/
+        SEXP COORDS ,       /* points (n x dim) or lower corners of boxes */
+        SEXP STARTS ,       /* first point of every block and n, or 'NULL' */
+        SEXP UPPER ,        /* upper corners of boxes or 'NULL' */
+        SEXP MU ,           /* param. of the GW covariance fct */
+        SEXP SMOOTHNESS ,   /* param. of the GW covariance fct */
+        SEXP SILL ,         /* param. of the GW covariance fct */
+        SEXP RNGE ,         /* param. of the GW covariance fct */
+        SEXP NUGGET ,       /* param. of the GW covariance fct */
+        SEXP ABSTOL ,       /* abs. tolerance for integration */
+        SEXP RELTOL ,       /* rel. tolerance for integration */
+        SEXP EPS ,          /* threshold for distances considered 0 */
+        SEXP NBR_INTERPOL , /* nbr. of interpolation points or 0 */
+        SEXP TOL ,          /* rel. tolerance of the cubature */
+        SEXP MAX_POINTS ,   /* max. nbr. of cubature points per box */
+        SEXP THREADS        /* nbr. of threads or 0 */
+        ) ;
+
+SEXP covar_async_start (
+/* ****************************************************************************
+ * The function 'SEXP covar_async_start(...)' starts the calculation of the
+ * GW covariances of the distances 'DIST' on a pool of native background
+ * threads (see 'async.h') and returns at once, so that R can go on, e.g.
+ * factorising the covariance matrix of the previous parameters while the
+ * one of the next parameters is built.
+ *
+ * All R objects are handled on the main thread: the result is allocated
+ * here and the threads only write to its memory, which is protected by the
+ * returned handle together with 'DIST' ('DIST' must not be modified until
+ * the job is done). The interpolation table is taken from the surface or
+ * the table store here if possible; otherwise it is calculated by the job,
+ * which neither uses the store nor records statistics. Releasing the
+ * handle cancels the job.
+ *
+ *
+ *  ****************
+ *  ** Arguments: **
+ *  ****************
+ *
+ *  -> SEXP DIST:       distance matrix (evaluated like 'covar_m_dist(...)')
+ *                      or vector of distances (like 'covar_vector_dir(...)'
+ *                      or 'covar_vector_interpol(...)'), double
+ *
+ *  -> SEXP MU, SMOOTHNESS, SILL, RNGE, NUGGET, ABSTOL, RELTOL, EPS:
+ *                      see 'covar_vector_dir(...)'
+ *
+ *  -> SEXP NBR_INTERPOL:
+ *                      size of the interpolation table (integer) or 0 to
+ *                      integrate every covariance numerically
+ *
+ *  -> SEXP WORKERS:    number of threads of the pool (integer); the pool
+ *                      only grows
+ *
+ *  ******************
+ *  ** Return value **
+ *  ******************
+ *
+ *  external pointer for 'covar_async_done(...)' and 'covar_async_get(...)';
+ *  'NULL' on error
+ *
+ * ****************************************************************************/
+        SEXP DIST ,         /* distance matrix or vector of distances */
+        SEXP MU ,           /* param. of the GW covariance fct */
+        SEXP SMOOTHNESS ,   /* param. of the GW covariance fct */
+        SEXP SILL ,         /* param. of the GW covariance fct */
+        SEXP RNGE ,         /* param. of the GW covariance fct */
+        SEXP NUGGET ,       /* param. of the GW covariance fct */
+        SEXP ABSTOL ,       /* abs. tolerance for integration */
+        SEXP RELTOL ,       /* rel. tolerance for integration */
+        SEXP EPS ,          /* threshold for distances considered 0 */
+        SEXP NBR_INTERPOL , /* nbr. of interpolation points or 0 */
+        SEXP WORKERS        /* nbr. of threads of the pool */
+        ) ;
+
+SEXP covar_async_done (
+/* ****************************************************************************
+ * The function 'SEXP covar_async_done(...)' returns 'TRUE' if the job of the
+ * handle 'PTR' from 'covar_async_start(...)' is done (successfully or not)
+ * and 'FALSE' otherwise, without blocking; 'NULL' for an invalid handle.
+ * ****************************************************************************/
+        SEXP PTR            /* handle from 'covar_async_start(...)' */
+        ) ;
+
+SEXP covar_async_get (
+/* ****************************************************************************
+ * The function 'SEXP covar_async_get(...)' blocks until the job of the
+ * handle 'PTR' is done and returns the covariances, a matrix or vector like
+ * 'DIST'. A user interrupt while waiting cancels the job. A table the job
+ * calculated is added to the table store here if the store is writable.
+ * Returns 'NULL' if the calculation failed or was cancelled, or for an
+ * invalid handle.
+ * ****************************************************************************/
+        SEXP PTR            /* handle from 'covar_async_start(...)' */
         ) ;
 
 #endif  /* COVAR_H_ */
@@ -0,0 +1,96 @@
+/* This file is part of the R-package 'GWcovar'
+ *
+ * Copyright (C) 2019 Josef Stocker <josef@josefstocker.ch>
+ *
+ * 'GWcovar' is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <https://www.gnu.org/licenses/>.
+ * */
+
+/* ***************************************************************************
+ * Smoke test of the C interface from C++: includes every header of
+ * 'libgwcovar' in a C++ translation unit and links against the library,
+ * which fails if a header lacks the 'extern "C"' guard.
+ *
+ *      make gwcovar_cxx_test
+ *      ./gwcovar_cxx_test
+ *
+ * Exits with status 1 if a value differs from the closed form.
+ * **************************************************************************/
+
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+#include "gwcovar.h"
+#include "wendland.h"
+#include "stats.h"
+#include "table.h"
+#include "planner.h"
+#include "store.h"
+#include "surface.h"
+#include "grid_index.h"
+#include "sim.h"
+#include "vecchia.h"
+#include "sfc.h"
+#include "mem.h"
+#include "scratch.h"
+#include "async.h"
+
+int
+main ( )
+{
+    /* smoothness 1 has a closed form to compare with */
+    Gw_params params = { 5, 1, 2, 0.5, 0.1, 1e-8, 1e-8, 1e-12 } ;
+    std::vector<double> dist( 101 ), out( 101 ) ;
+    for ( size_t i = 0 ; i < dist.size() ; i++ ) {
+
+        dist[i] = 0.6 * (double) i / (double) ( dist.size() - 1 ) ;
+    }
+
+    int failures = 0 ;
+    const size_t sizes[] = { 0, 1025 } ;
+    for ( size_t n_interpol : sizes ) {
+
+        Gw_kernel* kernel = NULL ;
+        int gsl_error = 0 ;
+        int ret = gw_kernel_new( &kernel, &params, n_interpol, NULL,
+                &gsl_error ) ;
+        if ( ret == GW_OK ) {
+
+            ret = gw_eval( kernel, dist.data(), out.data(), dist.size(),
+                    NULL, &gsl_error ) ;
+            gw_kernel_free( kernel ) ;
+        }
+        if ( ret != GW_OK ) {
+
+            std::fprintf( stderr, "n_interpol = %zu: %s\n", n_interpol,
+                    gw_strerror( ret ) ) ;
+            return 1 ;
+        }
+
+        double worst = 0 ;
+        for ( size_t i = 0 ; i < dist.size() ; i++ ) {
+
+            Wendland_result exact ;
+            wendland_closed_form( &exact, dist[i] / params.rnge, params.mu,
+                    params.smoothness ) ;
+            double expected = dist[i] < params.eps
+                ? params.sill + params.nugget : params.sill * exact.result ;
+            worst = std::fmax( worst, std::fabs( out[i] - expected ) ) ;
+        }
+        std::printf( "n_interpol = %zu: max. difference %g\n", n_interpol,
+                worst ) ;
+        failures += !( worst < 1e-6 ) ;
+    }
+    return failures > 0 ;
+}
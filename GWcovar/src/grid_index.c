@@ -0,0 +1,302 @@
+/* This file is part of the R-package 'GWcovar'
+ *
+ * Copyright (C) 2019 Josef Stocker <josef@josefstocker.ch>
+ *
+ * 'GWcovar' is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <https://www.gnu.org/licenses/>.
+ * */
+
+
+/* ***************************************************************************
+ * ** Include directives  ****************************************************
+ * **************************************************************************/
+
+#include "grid_index.h"
+
+#include "stdlib.h"
+#include "math.h"
+
+/* ***************************************************************************
+ * ** Private data structures ************************************************
+ * **************************************************************************/
+
+#define GRID_MAX_CELLS ( (uint64_t) 1 << 40 )
+/* upper bound for the total number of cells, so that the keys cannot
+ * overflow */
+
+typedef struct {
+    /* pair used to sort the locations by their cell key */
+    uint64_t key ;
+    size_t index ;
+} Key_pair ;
+
+
+
+/* ***************************************************************************
+ * ** Functions **************************************************************
+ * **************************************************************************/
+
+
+/* ***********************
+ * ** private functions **
+ * **********************/
+
+static int
+compare_keys (
+
+        const void* a ,
+        const void* b
+        )
+/* comparison function for 'qsort' */
+{
+    uint64_t ka = ((const Key_pair*) a)->key ;
+    uint64_t kb = ((const Key_pair*) b)->key ;
+    return ( ka > kb ) - ( ka < kb ) ;
+}
+
+static size_t
+lower_bound (
+
+        const uint64_t* keys ,
+        size_t n ,
+        uint64_t key
+        )
+/* returns the first position in the sorted array 'keys' which is not
+ * smaller than 'key' */
+{
+    size_t lo = 0 ;
+    size_t hi = n ;
+    while ( lo < hi ) {
+
+        size_t mid = lo + ( hi - lo ) / 2 ;
+        if ( keys[mid] < key ) {
+
+            lo = mid + 1 ;
+        } else {
+
+            hi = mid ;
+        }
+    }
+    return lo ;
+}
+
+static uint64_t
+cell_coord (
+
+        const Grid_index* index ,
+        double x ,
+        int k
+        )
+/* cell coordinate of 'x' in dimension 'k', clamped to the grid */
+{
+    double c = floor( ( x - index->lower[k] ) / index->cellsize ) ;
+    if ( c < 0 ) {
+
+        return 0 ;
+    }
+    if ( c >= (double) index->ncell[k] ) {
+
+        return index->ncell[k] - 1 ;
+    }
+    return (uint64_t) c ;
+}
+
+
+
+/* **********************
+ * ** public functions **
+ * *********************/
+
+int
+grid_index_build (
+
+        Grid_index* index ,
+        const double* coords ,
+        size_t n ,
+        int dim ,
+        double cellsize
+        )
+{
+    index->coords = coords ;
+    index->n = n ;
+    index->dim = dim ;
+    index->lower = malloc( dim * sizeof(double) ) ;
+    index->ncell = malloc( dim * sizeof(uint64_t) ) ;
+    index->keys = malloc( ( n > 0 ? n : 1 ) * sizeof(uint64_t) ) ;
+    index->order = malloc( ( n > 0 ? n : 1 ) * sizeof(size_t) ) ;
+    Key_pair* pairs = malloc( ( n > 0 ? n : 1 ) * sizeof(Key_pair) ) ;
+
+    if ( index->lower == NULL || index->ncell == NULL || index->keys == NULL
+            || index->order == NULL || pairs == NULL ) {
+
+        free( pairs ) ;
+        grid_index_free( index ) ;
+        return 1 ;
+    }
+
+    /* bounding box of the locations */
+    double upper[dim] ;
+    for ( int k = 0 ; k < dim ; k++ ) {
+
+        index->lower[k] = n > 0 ? coords[k*n] : 0 ;
+        upper[k] = index->lower[k] ;
+        for ( size_t i = 1 ; i < n ; i++ ) {
+
+            double x = coords[i + k*n] ;
+            if ( x < index->lower[k] ) index->lower[k] = x ;
+            if ( x > upper[k] ) upper[k] = x ;
+        }
+    }
+
+    /* Enlarge the cells until the total number of cells fits into the key.
+     * Larger cells only make the queries slower, never wrong. */
+    if ( !( cellsize > 0 ) ) {
+
+        cellsize = 1 ;
+    }
+    for ( ;; ) {
+
+        double total = 1 ;
+        for ( int k = 0 ; k < dim ; k++ ) {
+
+            index->ncell[k] = (uint64_t)
+                floor( ( upper[k] - index->lower[k] ) / cellsize ) + 1 ;
+            total *= (double) index->ncell[k] ;
+        }
+        if ( total < (double) GRID_MAX_CELLS ) {
+
+            break ;
+        }
+        cellsize *= 2 ;
+    }
+    index->cellsize = cellsize ;
+
+    /* sort the locations by cell key */
+    for ( size_t i = 0 ; i < n ; i++ ) {
+
+        uint64_t key = 0 ;
+        for ( int k = dim - 1 ; k >= 0 ; k-- ) {
+
+            key = key * index->ncell[k] + cell_coord( index, coords[i + k*n], k ) ;
+        }
+        pairs[i].key = key ;
+        pairs[i].index = i ;
+    }
+    qsort( pairs, n, sizeof(Key_pair), compare_keys ) ;
+    for ( size_t i = 0 ; i < n ; i++ ) {
+
+        index->keys[i] = pairs[i].key ;
+        index->order[i] = pairs[i].index ;
+    }
+    free( pairs ) ;
+    return 0 ;
+}
+
+void
+grid_index_free (
+
+        Grid_index* index
+        )
+{
+    free( index->lower ) ;
+    free( index->ncell ) ;
+    free( index->keys ) ;
+    free( index->order ) ;
+    index->lower = NULL ;
+    index->ncell = NULL ;
+    index->keys = NULL ;
+    index->order = NULL ;
+}
+
+size_t
+grid_index_query (
+
+        const Grid_index* index ,
+        const double* x ,
+        size_t stride ,
+        double radius ,
+        Grid_visit visit ,
+        void* ctx
+        )
+{
+    int dim = index->dim ;
+    size_t n = index->n ;
+    size_t found = 0 ;
+
+    if ( n == 0 ) {
+
+        return 0 ;
+    }
+
+    /* range of cells that intersect the ball around 'x' */
+    uint64_t lo[dim] ;
+    uint64_t hi[dim] ;
+    uint64_t cur[dim] ;
+    for ( int k = 0 ; k < dim ; k++ ) {
+
+        double xk = x[k*stride] ;
+        if ( xk + radius < index->lower[k] ||
+                xk - radius > index->lower[k]
+                    + index->cellsize * (double) index->ncell[k] ) {
+            /* ball does not intersect the grid */
+
+            return 0 ;
+        }
+        lo[k] = cell_coord( index, xk - radius, k ) ;
+        hi[k] = cell_coord( index, xk + radius, k ) ;
+        cur[k] = lo[k] ;
+    }
+
+    /* iterate through the cells like an odometer */
+    for ( ;; ) {
+
+        uint64_t key = 0 ;
+        for ( int k = dim - 1 ; k >= 0 ; k-- ) {
+
+            key = key * index->ncell[k] + cur[k] ;
+        }
+
+        for ( size_t p = lower_bound( index->keys, n, key ) ;
+                p < n && index->keys[p] == key ; p++ ) {
+
+            size_t i = index->order[p] ;
+            double d2 = 0 ;
+            for ( int k = 0 ; k < dim ; k++ ) {
+
+                double diff = index->coords[i + k*n] - x[k*stride] ;
+                d2 += diff * diff ;
+            }
+            if ( d2 < radius * radius ) {
+
+                found++ ;
+                if ( visit != NULL ) {
+
+                    visit( i, sqrt( d2 ), ctx ) ;
+                }
+            }
+        }
+
+        int k = 0 ;
+        while ( k < dim && cur[k] == hi[k] ) {
+
+            cur[k] = lo[k] ;
+            k++ ;
+        }
+        if ( k == dim ) {
+
+            break ;
+        }
+        cur[k]++ ;
+    }
+    return found ;
+}
@@ -0,0 +1,156 @@
+/* This file is part of the R-package 'GWcovar'
+ *
+ * Copyright (C) 2019 Josef Stocker <josef@josefstocker.ch>
+ *
+ * 'GWcovar' is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <https://www.gnu.org/licenses/>.
+ * */
+
+#ifndef GRID_INDEX_H_
+#define GRID_INDEX_H_
+
+
+/* ****************************************************************************
+ * ** Include directives  *****************************************************
+ * ***************************************************************************/
+
+#include "stddef.h" /* for type size_t */
+#include "stdint.h" /* for type uint64_t */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+
+/* ***************************************************************************
+ * ** Public data structures *************************************************
+ * **************************************************************************/
+
+typedef struct {
+/* ***************************************************************************
+ * Uniform grid over a set of locations. The locations are sorted by the key
+ * of the grid cell they fall into, so that all locations within a given
+ * radius of a query point can be found by looking at the neighbouring cells
+ * only. The coordinates are not copied; they have to stay valid as long as
+ * the index is used.
+ * **************************************************************************/
+    const double* coords ;
+    /* coordinates of the indexed locations (column major, n x dim) */
+
+    size_t n ;
+    /* number of indexed locations */
+
+    int dim ;
+    /* dimension of the coordinates */
+
+    double cellsize ;
+    /* edge length of the grid cells */
+
+    double* lower ;
+    /* lower corner of the bounding box of the locations (length dim) */
+
+    uint64_t* ncell ;
+    /* number of cells in each dimension (length dim) */
+
+    uint64_t* keys ;
+    /* sorted cell keys of the locations (length n) */
+
+    size_t* order ;
+    /* index of the location belonging to each entry of 'keys' */
+} Grid_index ;
+
+
+typedef void (*Grid_visit) (
+/* ***************************************************************************
+ * Callback used by 'grid_index_query(...)'. It is called once for every
+ * indexed location 'index' whose distance 'dist' to the query point is
+ * smaller than the query radius. 'ctx' is passed through unchanged.
+ * **************************************************************************/
+        size_t index ,
+        double dist ,
+        void* ctx
+        ) ;
+
+
+
+/* ***************************************************************************
+ * ***************************************************************************
+ * ** Public functions  ******************************************************
+ * ***************************************************************************
+ * **************************************************************************/
+
+int
+grid_index_build (
+/* ***************************************************************************
+ * The function 'int grid_index_build(...)' builds a grid index over the
+ * locations 'coords'. Returns '0' on success and '1' if the memory could not
+ * be allocated. In the latter case nothing has to be freed.
+ *
+ *
+ * ****************
+ * ** Arguments: **
+ * ****************
+ *
+ *  ->  Grid_index* index:  the index that is initialised
+ *
+ *  ->  const double* coords:  coordinates in column major order (n x dim)
+ *
+ *  ->  size_t n:           number of locations
+ *
+ *  ->  int dim:            dimension of the coordinates
+ *
+ *  ->  double cellsize:    edge length of the grid cells. Queries are most
+ *                          efficient if 'cellsize' equals the query radius.
+ *
+ * ***************************************************************************/
+        Grid_index* index ,
+        const double* coords ,
+        size_t n ,
+        int dim ,
+        double cellsize
+        ) ;
+
+
+void
+grid_index_free (
+/* ***************************************************************************
+ * Releases the memory held by 'index'. The coordinates are not touched.
+ * **************************************************************************/
+        Grid_index* index
+        ) ;
+
+
+size_t
+grid_index_query (
+/* ***************************************************************************
+ * The function 'size_t grid_index_query(...)' calls 'visit' for all indexed
+ * locations with a distance smaller than 'radius' to the point 'x' and
+ * returns the number of such locations. The coordinates of the query point
+ * are read as 'x[0]', 'x[stride]', ..., 'x[(dim-1)*stride]', so a row of a
+ * column major coordinate matrix can be passed directly. 'visit' may be
+ * 'NULL', in which case the locations are only counted.
+ * **************************************************************************/
+        const Grid_index* index ,
+        const double* x ,
+        size_t stride ,
+        double radius ,
+        Grid_visit visit ,
+        void* ctx
+        ) ;
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  /* #ifndef GRID_INDEX_H_ */
@@ -0,0 +1,1791 @@
+/* This file is part of the R-package 'GWcovar'
+ *
+ * Copyright (C) 2019 Josef Stocker <josef@josefstocker.ch>
+ *
+ * 'GWcovar' is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <https://www.gnu.org/licenses/>.
+ * */
+
+
+/* ***************************************************************************
+ * ** Include directives  ****************************************************
+ * **************************************************************************/
+
+#include "gwcovar.h"
+
+#include "stdlib.h"
+#include "math.h"
+#include "gsl/gsl_errno.h"
+#include "gsl/gsl_interp.h"
+#include "gsl/gsl_sf_bessel.h"
+#include "gsl/gsl_sf_gamma.h"
+
+#include "table.h"
+#include "scratch.h"
+
+#ifdef _OPENMP
+#include "omp.h"
+#endif
+
+/* ***************************************************************************
+ * ** Private data structures ************************************************
+ * **************************************************************************/
+
+struct Gw_kernel {
+    Gw_params params ;
+
+    Gw_table table ;
+    /* interpolation table ('table.n == 0' for numerical integration) */
+
+    Gw_base base ;
+    /* correlation function tapered by the GW function */
+
+    Gw_table product ;
+    /* table of base * GW in the points of 'table' (for a taper with table) */
+
+    Gw_progress progress ;
+    void* progress_ctx ;
+    size_t chunk ;
+    /* progress callback, called after every 'chunk' values */
+} ;
+
+#define GW_PAGE_DOUBLES 512
+/* doubles per (small) page, for the first touch of the output */
+
+#define GW_TILE 64
+/* number of locations per tile in 'gw_eval_coords(...)'; a tile of
+ * distances (32 KiB) stays in the L1 or L2 cache */
+
+typedef struct {
+    /* extent of a box, for finding boxes of the same shape */
+    const double* lower ;
+    const double* upper ;
+    size_t stride ;
+    int dim ;
+    size_t index ;
+} Box_shape ;
+
+
+
+/* ***************************************************************************
+ * ** Functions **************************************************************
+ * **************************************************************************/
+
+
+/* ***********************
+ * ** private functions **
+ * **********************/
+
+static int
+check_params (
+
+        const Gw_params* params ,
+        size_t n_interpol
+        )
+/* '1' if a kernel can be created with these parameters */
+{
+    return params->rnge > 0 && params->mu > 0 && params->smoothness >= 0
+        && ( n_interpol == 0 || n_interpol >= 3 ) ;
+}
+
+static Gw_kernel*
+kernel_alloc (
+
+        const Gw_params* params
+        )
+{
+    Gw_kernel* kernel = scratch_alloc( sizeof(Gw_kernel) ) ;
+    if ( kernel != NULL ) {
+
+        kernel->params = *params ;
+        kernel->table = (Gw_table) { 0, NULL, NULL, NULL, 0, 0 } ;
+        kernel->base = (Gw_base) { GW_BASE_NONE, 0, 0 } ;
+        kernel->product = (Gw_table) { 0, NULL, NULL, NULL, 0, 0 } ;
+        kernel->progress = NULL ;
+        kernel->progress_ctx = NULL ;
+        kernel->chunk = 0 ;
+    }
+    return kernel ;
+}
+
+static int
+base_value (
+
+        const Gw_base* base ,
+        double dist ,
+        int* gsl_error ,
+        double* value
+        )
+/* base correlation function in 'dist' */
+{
+    double x = dist / base->rnge ;
+    if ( base->type == GW_BASE_EXPONENTIAL ) {
+
+        *value = exp( -x ) ;
+        return GW_OK ;
+    }
+    if ( x == 0 ) {
+
+        *value = 1 ;
+        return GW_OK ;
+    }
+
+    /* Matern, on the log scale to avoid the under- and overflow of K_nu */
+    double nu = base->smoothness ;
+    gsl_sf_result ln_bessel ;
+    int error = gsl_sf_bessel_lnKnu_e( nu, x, &ln_bessel ) ;
+    if ( error != 0 ) {
+
+        if ( gsl_error != NULL ) {
+
+            *gsl_error = error ;
+        }
+        return GW_EBESSEL ;
+    }
+    *value = exp( ( 1 - nu ) * M_LN2 - gsl_sf_lngamma( nu ) + nu * log( x )
+            + ln_bessel.val ) ;
+    return GW_OK ;
+}
+
+static int
+kernel_value (
+
+        const Gw_kernel* kernel ,
+        double dist ,
+        gsl_interp_accel* acc ,
+        Covar_stats* stats ,
+        int* gsl_error ,
+        double* value
+        )
+/* GW covariance function for 'dist' >= eps */
+{
+    const Gw_params* params = &kernel->params ;
+    if ( dist >= params->rnge ) {
+
+        *value = 0 ;
+        return GW_OK ;
+    }
+    if ( kernel->table.n > 0 ) {
+
+        const Gw_table* table = kernel->base.type != GW_BASE_NONE
+            ? &kernel->product : &kernel->table ;
+        *value = params->sill * gw_table_eval( table, dist / params->rnge,
+                acc ) ;
+        return GW_OK ;
+    }
+
+    Wendland_result result ;
+    wendland( &result, dist / params->rnge, params->mu, params->smoothness,
+            params->abstol, params->reltol ) ;
+    if ( stats != NULL && stats->enabled ) {
+
+        stats_record( stats, &result ) ;
+    }
+    int error = wendland_error( &result ) ;
+    if ( error != 0 ) {
+
+        if ( gsl_error != NULL ) {
+
+            *gsl_error = error ;
+        }
+        return result.error != 0 ? GW_EINTEG : GW_EBETA ;
+    }
+    double base = 1 ;
+    if ( kernel->base.type != GW_BASE_NONE ) {
+
+        int ret = base_value( &kernel->base, dist, gsl_error, &base ) ;
+        if ( ret != GW_OK ) {
+
+            return ret ;
+        }
+    }
+    *value = params->sill * result.result * base ;
+    return GW_OK ;
+}
+
+static size_t
+chunk_size (
+
+        const Gw_kernel* kernel ,
+        size_t total
+        )
+/* number of values calculated between two calls of the progress callback */
+{
+    if ( kernel->progress == NULL || kernel->chunk == 0
+            || kernel->chunk > total ) {
+
+        return total > 0 ? total : 1 ;
+    }
+    return kernel->chunk ;
+}
+
+static int
+progress (
+
+        const Gw_kernel* kernel ,
+        size_t done ,
+        size_t total
+        )
+/* calls the progress callback after a chunk; 'GW_ECANCEL' if the
+ * calculation should stop */
+{
+    if ( kernel->progress == NULL ) {
+
+        return GW_OK ;
+    }
+    return kernel->progress( done, total, kernel->progress_ctx ) != 0
+        ? GW_ECANCEL : GW_OK ;
+}
+
+static gsl_interp_accel*
+accel_alloc (
+
+        const Gw_kernel* kernel ,
+        int* ret
+        )
+/* accelerator for the table lookups of one call ('NULL' for kernels
+ * without table) */
+{
+    *ret = GW_OK ;
+    if ( kernel->table.n == 0 ) {
+
+        return NULL ;
+    }
+    gsl_interp_accel* acc = gsl_interp_accel_alloc() ;
+    if ( acc == NULL ) {
+
+        *ret = GW_ENOMEM ;
+    }
+    return acc ;
+}
+
+static size_t
+index_get (
+
+        const void* indices ,
+        int wide ,
+        size_t k
+        )
+/* 'k'-th spam index of 'indices', which are 'int' or, if 'wide', 'double'
+ * (spam64) */
+{
+    if ( wide ) {
+
+        return (size_t) ( (const double*) indices )[k] ;
+    }
+    return (size_t) ( (const int*) indices )[k] ;
+}
+
+static void
+index_set (
+
+        void* indices ,
+        int wide ,
+        size_t k ,
+        size_t value
+        )
+/* sets the 'k'-th spam index of 'indices', see 'index_get(...)' */
+{
+    if ( wide ) {
+
+        ( (double*) indices )[k] = (double) value ;
+    } else {
+
+        ( (int*) indices )[k] = (int) value ;
+    }
+}
+
+static int
+eval_compact (
+
+        const Gw_kernel* kernel ,
+        const double* dist ,
+        const void* colindices ,
+        const void* rowpointers ,
+        int wide ,
+        size_t nrow ,
+        double* out ,
+        void* out_colindices ,
+        void* out_rowpointers ,
+        size_t* nnz ,
+        Covar_stats* stats ,
+        int* gsl_error
+        )
+/* 'gw_eval_compact(...)' for 'int' and 'double' indices */
+{
+    const Gw_params* params = &kernel->params ;
+    size_t pos = 0 ;
+    int ret ;
+    gsl_interp_accel* acc = accel_alloc( kernel, &ret ) ;
+
+    size_t total = index_get( rowpointers, wide, nrow ) - 1 ;
+    size_t chunk = chunk_size( kernel, total ) ;
+    size_t next = chunk ;
+
+    for ( size_t i = 0 ; i < nrow && ret == GW_OK ; i++ ) {
+
+        size_t first = index_get( rowpointers, wide, i ) - 1 ;
+        size_t last = index_get( rowpointers, wide, i+1 ) - 1 ;
+        if ( first >= next ) {
+            /* 'first' entries have been read */
+
+            ret = progress( kernel, first, total ) ;
+            next = first + chunk ;
+            if ( ret != GW_OK ) {
+
+                break ;
+            }
+        }
+        index_set( out_rowpointers, wide, i, pos + 1 ) ;
+        for ( size_t k = first ; k < last && ret == GW_OK ; k++ ) {
+
+            double d = dist[k] ;
+            if ( d >= params->rnge ) {
+                /* NaN is kept, the callers count the entries with the same
+                 * test */
+
+                continue ;
+            }
+            if ( isnan( d ) ) {
+
+                out[pos] = d ;
+            } else if ( d < params->eps ) {
+
+                out[pos] = params->sill + params->nugget ;
+            } else {
+
+                ret = kernel_value( kernel, d, acc, stats, gsl_error,
+                        &out[pos] ) ;
+            }
+            index_set( out_colindices, wide, pos,
+                    index_get( colindices, wide, k ) ) ;
+            pos++ ;
+        }
+    }
+    index_set( out_rowpointers, wide, nrow, pos + 1 ) ;
+    *nnz = pos ;
+    if ( acc != NULL ) {
+
+        gsl_interp_accel_free( acc ) ;
+    }
+    return ret ;
+}
+
+
+
+static void
+tile_box (
+
+        const double* coords ,
+        size_t n ,
+        int dim ,
+        size_t first ,
+        size_t count ,
+        double* lo ,
+        double* hi
+        )
+/* bounding box of the locations first, ..., first+count-1 */
+{
+    for ( int l = 0 ; l < dim ; l++ ) {
+
+        const double* x = coords + (size_t) l * n + first ;
+        lo[l] = x[0] ;
+        hi[l] = x[0] ;
+        for ( size_t a = 1 ; a < count ; a++ ) {
+
+            lo[l] = fmin( lo[l], x[a] ) ;
+            hi[l] = fmax( hi[l], x[a] ) ;
+        }
+    }
+}
+
+static double
+box_gap (
+
+        const double* lo1 ,
+        const double* hi1 ,
+        const double* lo2 ,
+        const double* hi2 ,
+        int dim
+        )
+/* squared distance between two bounding boxes (0 if they overlap) */
+{
+    double gap = 0 ;
+    for ( int l = 0 ; l < dim ; l++ ) {
+
+        double d = fmax( 0, fmax( lo1[l] - hi2[l], lo2[l] - hi1[l] ) ) ;
+        gap += d * d ;
+    }
+    return gap ;
+}
+
+static void
+tile_dist (
+
+        const double* coords ,
+        size_t n ,
+        int dim ,
+        size_t i0 ,
+        size_t ni ,
+        size_t j0 ,
+        size_t nj ,
+        double* block
+        )
+/* Euclidean distances between the locations i0, ..., i0+ni-1 and j0, ...,
+ * j0+nj-1; 'block[a + b*GW_TILE]' is the distance between i0+a and j0+b.
+ * The innermost loop runs over contiguous coordinates, so that it is
+ * vectorised. */
+{
+    for ( size_t b = 0 ; b < nj ; b++ ) {
+
+        double* col = block + b * GW_TILE ;
+        for ( size_t a = 0 ; a < ni ; a++ ) {
+
+            col[a] = 0 ;
+        }
+    }
+    for ( int l = 0 ; l < dim ; l++ ) {
+
+        const double* xi = coords + (size_t) l * n + i0 ;
+        const double* xj = coords + (size_t) l * n + j0 ;
+        for ( size_t b = 0 ; b < nj ; b++ ) {
+
+            double* col = block + b * GW_TILE ;
+            double x = xj[b] ;
+#ifdef _OPENMP
+            #pragma omp simd
+#endif
+            for ( size_t a = 0 ; a < ni ; a++ ) {
+
+                double d = xi[a] - x ;
+                col[a] += d * d ;
+            }
+        }
+    }
+    for ( size_t b = 0 ; b < nj ; b++ ) {
+
+        double* col = block + b * GW_TILE ;
+#ifdef _OPENMP
+        #pragma omp simd
+#endif
+        for ( size_t a = 0 ; a < ni ; a++ ) {
+
+            col[a] = sqrt( col[a] ) ;
+        }
+    }
+}
+
+
+
+static int
+multi_block (
+
+        const Gw_kernel* const* kernels ,
+        size_t p ,
+        double dist ,
+        gsl_interp_accel** acc ,
+        Covar_stats* stats ,
+        int* gsl_error ,
+        double* block
+        )
+/* p x p block of the multivariate covariance function at 'dist' (column
+ * major); 'kernels[a + b*(b+1)/2]' belongs to the variables a <= b */
+{
+    for ( size_t b = 0 ; b < p ; b++ ) {
+
+        for ( size_t a = 0 ; a <= b ; a++ ) {
+
+            size_t k = a + b * ( b + 1 ) / 2 ;
+            const Gw_params* params = &kernels[k]->params ;
+            double value = params->sill + params->nugget ;
+            if ( dist != 0 && dist >= params->eps ) {
+
+                int ret = kernel_value( kernels[k], dist, acc[k], stats,
+                        gsl_error, &value ) ;
+                if ( ret != GW_OK ) {
+
+                    return ret ;
+                }
+            }
+            block[a + b*p] = value ;
+            block[b + a*p] = value ;
+        }
+    }
+    return GW_OK ;
+}
+
+static gsl_interp_accel**
+multi_accel_alloc (
+
+        const Gw_kernel* const* kernels ,
+        size_t nkernels ,
+        int* ret
+        )
+/* accelerators of the kernels of a multivariate covariance function */
+{
+    gsl_interp_accel** acc = scratch_alloc( nkernels
+            * sizeof(gsl_interp_accel*) ) ;
+    *ret = acc == NULL ? GW_ENOMEM : GW_OK ;
+    for ( size_t k = 0 ; acc != NULL && k < nkernels ; k++ ) {
+
+        acc[k] = NULL ;
+    }
+    for ( size_t k = 0 ; k < nkernels && *ret == GW_OK ; k++ ) {
+
+        acc[k] = accel_alloc( kernels[k], ret ) ;
+    }
+    return acc ;
+}
+
+static void
+multi_accel_free (
+
+        gsl_interp_accel** acc ,
+        size_t nkernels
+        )
+{
+    for ( size_t k = 0 ; acc != NULL && k < nkernels ; k++ ) {
+
+        if ( acc[k] != NULL ) {
+
+            gsl_interp_accel_free( acc[k] ) ;
+        }
+    }
+    scratch_free( acc ) ;
+}
+
+
+
+static void
+fold_range (
+
+        size_t n ,
+        int thread ,
+        int nthreads ,
+        size_t* lo ,
+        size_t* hi
+        )
+/* columns of 'thread' in the parallel functions: [lo, hi) of the first
+ * half and the mirrored columns n-1-k. Column j of the upper triangle has
+ * j+1 entries, so each pair (k, n-1-k) has the same work and every thread
+ * gets the same number of columns and of entries. */
+{
+    size_t half = ( n + 1 ) / 2 ;
+    *lo = half * (size_t) thread / (size_t) nthreads ;
+    *hi = half * (size_t) ( thread + 1 ) / (size_t) nthreads ;
+}
+
+static int
+thread_count (
+
+        int nthreads
+        )
+/* number of threads used for 'nthreads' (<= 0: default of OpenMP) */
+{
+#ifdef _OPENMP
+    return nthreads > 0 ? nthreads : omp_get_max_threads() ;
+#else
+    (void) nthreads ;
+    return 1 ;
+#endif
+}
+
+static int
+thread_id (
+
+        void
+        )
+{
+#ifdef _OPENMP
+    return omp_get_thread_num() ;
+#else
+    return 0 ;
+#endif
+}
+
+static int
+point_value (
+
+        const Gw_kernel* kernel ,
+        double dist ,
+        gsl_interp_accel* acc ,
+        int* gsl_error ,
+        double* value
+        )
+/* GW covariance function for any distance, with sill + nugget below eps */
+{
+    const Gw_params* params = &kernel->params ;
+    if ( dist == 0 || dist < params->eps ) {
+
+        *value = params->sill + params->nugget ;
+        return GW_OK ;
+    }
+    return kernel_value( kernel, dist, acc, NULL, gsl_error, value ) ;
+}
+
+static double
+point_dist (
+
+        const double* x ,
+        size_t stride_x ,
+        const double* y ,
+        size_t stride_y ,
+        int dim
+        )
+/* Euclidean distance between the points x[0], x[stride_x], ... and y[0],
+ * y[stride_y], ... */
+{
+    double sum = 0 ;
+    for ( int l = 0 ; l < dim ; l++ ) {
+
+        double d = x[l * stride_x] - y[l * stride_y] ;
+        sum += d * d ;
+    }
+    return sqrt( sum ) ;
+}
+
+static void
+box_points (
+
+        const double* lower ,
+        const double* upper ,
+        size_t stride ,
+        int dim ,
+        size_t m ,
+        double* points
+        )
+/* midpoints of the m^dim cells of the box [lower, upper] (coordinates read
+ * with 'stride'); 'points[k*dim + l]' is coordinate l of point k */
+{
+    size_t count = 1 ;
+    for ( int l = 0 ; l < dim ; l++ ) {
+
+        count *= m ;
+    }
+    for ( size_t k = 0 ; k < count ; k++ ) {
+
+        size_t rest = k ;
+        for ( int l = 0 ; l < dim ; l++ ) {
+
+            double lo = lower[l * stride] ;
+            double hi = upper[l * stride] ;
+            points[k*dim + l] = lo + ( (double) ( rest % m ) + 0.5 )
+                * ( hi - lo ) / (double) m ;
+            rest /= m ;
+        }
+    }
+}
+
+static int
+box_average (
+
+        const Gw_kernel* kernel ,
+        const double* lower_a ,
+        const double* upper_a ,
+        const double* lower_b ,
+        const double* upper_b ,
+        size_t stride ,
+        int dim ,
+        double tol ,
+        size_t max_points ,
+        double* points_a ,
+        double* points_b ,
+        gsl_interp_accel* acc ,
+        int* gsl_error ,
+        double* value
+        )
+/* mean of the covariance function over the pairs of points of the boxes a
+ * and b: midpoint rule with m^dim points per box, doubling m until two
+ * successive means agree within 'tol' (relative, absolute below 1e-3 of the
+ * sill) or the next rule would need more than 'max_points' points */
+{
+    double min_var = 1e-3 * kernel->params.sill ;
+    double previous = 0 ;
+    for ( size_t m = 1 ; ; m *= 2 ) {
+
+        size_t count = 1 ;
+        for ( int l = 0 ; l < dim ; l++ ) {
+
+            count *= m ;
+        }
+        box_points( lower_a, upper_a, stride, dim, m, points_a ) ;
+        box_points( lower_b, upper_b, stride, dim, m, points_b ) ;
+        double sum = 0 ;
+        for ( size_t i = 0 ; i < count ; i++ ) {
+
+            for ( size_t j = 0 ; j < count ; j++ ) {
+
+                double v ;
+                int ret = point_value( kernel, point_dist( points_a + i*dim,
+                            1, points_b + j*dim, 1, dim ), acc, gsl_error,
+                        &v ) ;
+                if ( ret != GW_OK ) {
+
+                    return ret ;
+                }
+                sum += v ;
+            }
+        }
+        *value = sum / ( (double) count * (double) count ) ;
+
+        size_t next = 1 ;
+        for ( int l = 0 ; l < dim ; l++ ) {
+
+            next *= 2 * m ;
+        }
+        if ( ( m > 1 && fabs( *value - previous )
+                    <= tol * fmax( fabs( *value ), min_var ) )
+                || next > max_points ) {
+
+            return GW_OK ;
+        }
+        previous = *value ;
+    }
+}
+
+static int
+compare_shape (
+
+        const void* a ,
+        const void* b
+        )
+/* comparison function for 'qsort': lexicographic order of the extents */
+{
+    const Box_shape* sa = a ;
+    const Box_shape* sb = b ;
+    for ( int l = 0 ; l < sa->dim ; l++ ) {
+
+        double ea = sa->upper[l * sa->stride] - sa->lower[l * sa->stride] ;
+        double eb = sb->upper[l * sb->stride] - sb->lower[l * sb->stride] ;
+        if ( ea != eb ) {
+
+            return ( ea > eb ) - ( ea < eb ) ;
+        }
+    }
+    return 0 ;
+}
+
+
+
+/* **********************
+ * ** public functions **
+ * *********************/
+
+int
+gw_kernel_new (
+
+        Gw_kernel** kernel ,
+        const Gw_params* params ,
+        size_t n_interpol ,
+        Covar_stats* stats ,
+        int* gsl_error
+        )
+{
+    *kernel = NULL ;
+    if ( !check_params( params, n_interpol ) ) {
+
+        return GW_EINVAL ;
+    }
+    Gw_kernel* k = kernel_alloc( params ) ;
+    if ( k == NULL ) {
+
+        return GW_ENOMEM ;
+    }
+
+    gsl_set_error_handler_off() ;
+    if ( n_interpol > 0 ) {
+
+        int ret = gw_table_build( &k->table, n_interpol, params->mu,
+                params->smoothness, params->abstol, params->reltol, stats ) ;
+        if ( ret != TABLE_OK ) {
+            /* the codes of 'table.h' agree with the ones of 'gwcovar.h' */
+
+            if ( gsl_error != NULL ) {
+
+                *gsl_error = k->table.gsl_error ;
+            }
+            scratch_free( k ) ;
+            return ret ;
+        }
+    }
+    *kernel = k ;
+    return GW_OK ;
+}
+
+int
+gw_kernel_wrap (
+
+        Gw_kernel** kernel ,
+        const Gw_params* params ,
+        size_t n_interpol ,
+        const double* values
+        )
+{
+    *kernel = NULL ;
+    if ( !check_params( params, n_interpol ) || n_interpol == 0 ) {
+
+        return GW_EINVAL ;
+    }
+    Gw_kernel* k = kernel_alloc( params ) ;
+    if ( k == NULL ) {
+
+        return GW_ENOMEM ;
+    }
+    if ( gw_table_wrap( &k->table, n_interpol, values ) != TABLE_OK ) {
+
+        scratch_free( k ) ;
+        return GW_ENOMEM ;
+    }
+    *kernel = k ;
+    return GW_OK ;
+}
+
+int
+gw_kernel_adopt (
+
+        Gw_kernel** kernel ,
+        const Gw_params* params ,
+        size_t n_interpol ,
+        double* values
+        )
+{
+    int ret = gw_kernel_wrap( kernel, params, n_interpol, values ) ;
+    if ( ret != GW_OK ) {
+
+        scratch_free( values ) ;
+        return ret ;
+    }
+    (*kernel)->table.borrowed = 0 ;
+    /* the values belong to the table */
+    return GW_OK ;
+}
+
+int
+gw_kernel_base (
+
+        Gw_kernel* kernel ,
+        const Gw_base* base ,
+        int* gsl_error
+        )
+{
+    gw_table_free( &kernel->product ) ;
+    kernel->base.type = GW_BASE_NONE ;
+    if ( base->type == GW_BASE_NONE ) {
+
+        return GW_OK ;
+    }
+    if ( ( base->type != GW_BASE_EXPONENTIAL && base->type != GW_BASE_MATERN )
+            || !( base->rnge > 0 )
+            || ( base->type == GW_BASE_MATERN && !( base->smoothness > 0 ) ) ) {
+
+        return GW_EINVAL ;
+    }
+    if ( kernel->table.n == 0 ) {
+
+        kernel->base = *base ;
+        return GW_OK ;
+    }
+
+    size_t n = kernel->table.n ;
+    double* values = scratch_alloc( n * sizeof(double) ) ;
+    if ( values == NULL ) {
+
+        return GW_ENOMEM ;
+    }
+    gsl_set_error_handler_off() ;
+    for ( size_t i = 0 ; i < n ; i++ ) {
+
+        double b ;
+        int ret = base_value( base, kernel->table.points[i]
+                * kernel->params.rnge, gsl_error, &b ) ;
+        if ( ret != GW_OK ) {
+
+            scratch_free( values ) ;
+            return ret ;
+        }
+        values[i] = b * kernel->table.values[i] ;
+    }
+    if ( gw_table_wrap( &kernel->product, n, values ) != TABLE_OK ) {
+
+        scratch_free( values ) ;
+        return GW_ENOMEM ;
+    }
+    kernel->product.borrowed = 0 ;
+    /* the values belong to the table */
+    kernel->base = *base ;
+    return GW_OK ;
+}
+
+void
+gw_kernel_progress (
+
+        Gw_kernel* kernel ,
+        Gw_progress progress ,
+        void* ctx ,
+        size_t chunk
+        )
+{
+    kernel->progress = progress ;
+    kernel->progress_ctx = ctx ;
+    kernel->chunk = chunk ;
+}
+
+const double*
+gw_kernel_table (
+
+        const Gw_kernel* kernel ,
+        size_t* n_interpol
+        )
+{
+    *n_interpol = kernel->table.n ;
+    return kernel->table.values ;
+}
+
+const Gw_params*
+gw_kernel_params (
+
+        const Gw_kernel* kernel
+        )
+{
+    return &kernel->params ;
+}
+
+void
+gw_kernel_free (
+
+        Gw_kernel* kernel
+        )
+{
+    if ( kernel != NULL ) {
+
+        gw_table_free( &kernel->table ) ;
+        gw_table_free( &kernel->product ) ;
+        scratch_free( kernel ) ;
+    }
+}
+
+int
+gw_eval (
+
+        const Gw_kernel* kernel ,
+        const double* dist ,
+        double* out ,
+        size_t length ,
+        Covar_stats* stats ,
+        int* gsl_error
+        )
+{
+    const Gw_params* params = &kernel->params ;
+    int ret ;
+    gsl_interp_accel* acc = accel_alloc( kernel, &ret ) ;
+
+    size_t chunk = chunk_size( kernel, length ) ;
+
+    for ( size_t start = 0 ; start < length && ret == GW_OK ;
+            start += chunk ) {
+
+        size_t end = length - start < chunk ? length : start + chunk ;
+        for ( size_t i = start ; i < end && ret == GW_OK ; i++ ) {
+
+            if ( dist[i] < params->eps ) {
+
+                out[i] = params->sill + params->nugget ;
+            } else {
+
+                ret = kernel_value( kernel, dist[i], acc, stats, gsl_error,
+                        &out[i] ) ;
+            }
+        }
+        if ( ret == GW_OK && end < length ) {
+
+            ret = progress( kernel, end, length ) ;
+        }
+    }
+    if ( acc != NULL ) {
+
+        gsl_interp_accel_free( acc ) ;
+    }
+    return ret ;
+}
+
+int
+gw_eval_matrix (
+
+        const Gw_kernel* kernel ,
+        const double* dist ,
+        double* out ,
+        size_t nrow ,
+        size_t ncol ,
+        Covar_stats* stats ,
+        int* gsl_error
+        )
+{
+    const Gw_params* params = &kernel->params ;
+    double at_zero = params->sill + params->nugget ;
+    int ret ;
+    gsl_interp_accel* acc = accel_alloc( kernel, &ret ) ;
+
+    if ( nrow == ncol ) {
+        /* upper triangle, the lower one by symmetry; the progress is
+         * reported after the row in which a chunk is completed */
+
+        size_t total = nrow * ( nrow - 1 ) / 2 ;
+        size_t chunk = chunk_size( kernel, total ) ;
+        size_t done = 0 ;
+        size_t next = chunk ;
+        for ( size_t i = 0 ; i < nrow && ret == GW_OK ; i++ ) {
+
+            out[i + i*nrow] = at_zero ;
+            for ( size_t j = i+1 ; j < ncol && ret == GW_OK ; j++ ) {
+
+                double d = dist[i + j*nrow] ;
+                double value = at_zero ;
+                if ( d != 0 ) {
+
+                    ret = kernel_value( kernel, d, acc, stats, gsl_error,
+                            &value ) ;
+                }
+                out[i + j*nrow] = value ;
+                out[j + i*nrow] = value ;
+            }
+            done += nrow - i - 1 ;
+            if ( ret == GW_OK && done >= next && done < total ) {
+
+                ret = progress( kernel, done, total ) ;
+                next = done + chunk ;
+            }
+        }
+    } else {
+
+        size_t total = nrow * ncol ;
+        size_t chunk = chunk_size( kernel, total ) ;
+        for ( size_t start = 0 ; start < total && ret == GW_OK ;
+                start += chunk ) {
+
+            size_t end = total - start < chunk ? total : start + chunk ;
+            for ( size_t k = start ; k < end && ret == GW_OK ; k++ ) {
+
+                if ( dist[k] == 0 ) {
+
+                    out[k] = at_zero ;
+                } else {
+
+                    ret = kernel_value( kernel, dist[k], acc, stats,
+                            gsl_error, &out[k] ) ;
+                }
+            }
+            if ( ret == GW_OK && end < total ) {
+
+                ret = progress( kernel, end, total ) ;
+            }
+        }
+    }
+    if ( acc != NULL ) {
+
+        gsl_interp_accel_free( acc ) ;
+    }
+    return ret ;
+}
+
+int
+gw_eval_matrix_parallel (
+
+        const Gw_kernel* kernel ,
+        const double* dist ,
+        double* out ,
+        size_t n ,
+        int nthreads ,
+        int* gsl_error
+        )
+{
+    const Gw_params* params = &kernel->params ;
+    double at_zero = params->sill + params->nugget ;
+    int nt = thread_count( nthreads ) ;
+    int status = GW_OK ;
+
+    #pragma omp parallel num_threads(nt)
+    {
+        size_t lo, hi ;
+        int ret ;
+        int gsl = 0 ;
+        fold_range( n, thread_id(), nt, &lo, &hi ) ;
+        gsl_interp_accel* acc = accel_alloc( kernel, &ret ) ;
+
+        /* first touch: the pages of the own columns are placed on the
+         * NUMA node of this thread */
+        for ( size_t k = lo ; k < hi ; k++ ) {
+
+            for ( int side = 0 ; side < 2 ; side++ ) {
+
+                size_t j = side == 0 ? k : n - 1 - k ;
+                if ( side == 1 && j <= k ) {
+
+                    break ;
+                }
+                for ( size_t i = 0 ; i < n ; i += GW_PAGE_DOUBLES ) {
+
+                    out[i + j*n] = 0 ;
+                }
+            }
+        }
+
+        /* upper triangle of the own columns */
+        for ( size_t k = lo ; k < hi && ret == GW_OK ; k++ ) {
+
+            for ( int side = 0 ; side < 2 && ret == GW_OK ; side++ ) {
+
+                size_t j = side == 0 ? k : n - 1 - k ;
+                if ( side == 1 && j <= k ) {
+
+                    break ;
+                }
+                for ( size_t i = 0 ; i < j && ret == GW_OK ; i++ ) {
+
+                    double d = dist[i + j*n] ;
+                    double value = at_zero ;
+                    if ( d != 0 && d >= params->eps ) {
+
+                        ret = kernel_value( kernel, d, acc, NULL, &gsl,
+                                &value ) ;
+                    }
+                    out[i + j*n] = value ;
+                }
+                out[j + j*n] = at_zero ;
+            }
+        }
+        if ( ret != GW_OK ) {
+
+            #pragma omp critical (gw_parallel_error)
+            {
+                if ( status == GW_OK ) {
+
+                    status = ret ;
+                    *gsl_error = gsl ;
+                }
+            }
+        }
+        if ( acc != NULL ) {
+
+            gsl_interp_accel_free( acc ) ;
+        }
+
+        /* lower triangle of the own columns from the upper one */
+        #pragma omp barrier
+        for ( size_t k = lo ; k < hi ; k++ ) {
+
+            for ( int side = 0 ; side < 2 ; side++ ) {
+
+                size_t j = side == 0 ? k : n - 1 - k ;
+                if ( side == 1 && j <= k ) {
+
+                    break ;
+                }
+                for ( size_t i = j + 1 ; i < n ; i++ ) {
+
+                    out[i + j*n] = out[j + i*n] ;
+                }
+            }
+        }
+    }
+    return status ;
+}
+
+void
+gw_matvec_parallel (
+
+        const double* a ,
+        size_t n ,
+        const double* v ,
+        double* y ,
+        int nthreads
+        )
+{
+    int nt = thread_count( nthreads ) ;
+
+    #pragma omp parallel num_threads(nt)
+    {
+        size_t lo, hi ;
+        fold_range( n, thread_id(), nt, &lo, &hi ) ;
+
+        /* y[j] = a[,j] . v, since 'a' is symmetric */
+        for ( size_t k = lo ; k < hi ; k++ ) {
+
+            for ( int side = 0 ; side < 2 ; side++ ) {
+
+                size_t j = side == 0 ? k : n - 1 - k ;
+                if ( side == 1 && j <= k ) {
+
+                    break ;
+                }
+                const double* col = a + j*n ;
+                double sum = 0 ;
+                #pragma omp simd reduction(+:sum)
+                for ( size_t i = 0 ; i < n ; i++ ) {
+
+                    sum += col[i] * v[i] ;
+                }
+                y[j] = sum ;
+            }
+        }
+    }
+}
+
+int
+gw_eval_coords (
+
+        const Gw_kernel* kernel ,
+        const double* coords ,
+        size_t n ,
+        int dim ,
+        double* out ,
+        Covar_stats* stats ,
+        int* gsl_error
+        )
+{
+    const Gw_params* params = &kernel->params ;
+    double at_zero = params->sill + params->nugget ;
+    double range2 = params->rnge * params->rnge ;
+    size_t ntiles = ( n + GW_TILE - 1 ) / GW_TILE ;
+
+    if ( dim < 1 ) {
+
+        return GW_EINVAL ;
+    }
+    int ret ;
+    gsl_interp_accel* acc = accel_alloc( kernel, &ret ) ;
+    double* lo = scratch_alloc( ntiles * dim * sizeof(double) ) ;
+    double* hi = scratch_alloc( ntiles * dim * sizeof(double) ) ;
+    double* block = scratch_alloc( GW_TILE * GW_TILE * sizeof(double) ) ;
+    if ( ret == GW_OK && ( lo == NULL || hi == NULL || block == NULL ) ) {
+
+        ret = GW_ENOMEM ;
+    }
+    for ( size_t t = 0 ; t < ntiles && ret == GW_OK ; t++ ) {
+
+        size_t first = t * GW_TILE ;
+        tile_box( coords, n, dim, first,
+                n - first < GW_TILE ? n - first : GW_TILE,
+                lo + t * dim, hi + t * dim ) ;
+    }
+
+    /* upper triangle of tiles, the lower one by symmetry; the progress is
+     * reported after the row of tiles in which a chunk is completed */
+    size_t total = n * ( n + 1 ) / 2 ;
+    size_t chunk = chunk_size( kernel, total ) ;
+    size_t done = 0 ;
+    size_t next = chunk ;
+    for ( size_t ti = 0 ; ti < ntiles && ret == GW_OK ; ti++ ) {
+
+        size_t i0 = ti * GW_TILE ;
+        size_t ni = n - i0 < GW_TILE ? n - i0 : GW_TILE ;
+        for ( size_t tj = ti ; tj < ntiles && ret == GW_OK ; tj++ ) {
+
+            size_t j0 = tj * GW_TILE ;
+            size_t nj = n - j0 < GW_TILE ? n - j0 : GW_TILE ;
+            if ( box_gap( lo + ti * dim, hi + ti * dim, lo + tj * dim,
+                        hi + tj * dim, dim ) >= range2 ) {
+                /* all locations of the two tiles are beyond the range */
+
+                for ( size_t b = 0 ; b < nj ; b++ ) {
+
+                    double* col = out + i0 + ( j0 + b ) * n ;
+                    for ( size_t a = 0 ; a < ni ; a++ ) {
+
+                        col[a] = 0 ;
+                    }
+                }
+                for ( size_t a = 0 ; a < ni ; a++ ) {
+
+                    double* col = out + j0 + ( i0 + a ) * n ;
+                    for ( size_t b = 0 ; b < nj ; b++ ) {
+
+                        col[b] = 0 ;
+                    }
+                }
+                continue ;
+            }
+
+            tile_dist( coords, n, dim, i0, ni, j0, nj, block ) ;
+            for ( size_t b = 0 ; b < nj && ret == GW_OK ; b++ ) {
+
+                size_t j = j0 + b ;
+                size_t last = ti == tj ? b + 1 : ni ;
+                for ( size_t a = 0 ; a < last && ret == GW_OK ; a++ ) {
+
+                    size_t i = i0 + a ;
+                    double d = block[a + b * GW_TILE] ;
+                    double value = at_zero ;
+                    if ( d != 0 && d >= params->eps ) {
+
+                        ret = kernel_value( kernel, d, acc, stats, gsl_error,
+                                &value ) ;
+                    }
+                    out[i + j*n] = value ;
+                    out[j + i*n] = value ;
+                }
+            }
+        }
+        done += ni * ( n - i0 ) - ni * ( ni - 1 ) / 2 ;
+        if ( ret == GW_OK && done >= next && done < total ) {
+
+            ret = progress( kernel, done, total ) ;
+            next = done + chunk ;
+        }
+    }
+
+    scratch_free( lo ) ;
+    scratch_free( hi ) ;
+    scratch_free( block ) ;
+    if ( acc != NULL ) {
+
+        gsl_interp_accel_free( acc ) ;
+    }
+    return ret ;
+}
+
+int
+gw_eval_multi_matrix (
+
+        const Gw_kernel* const* kernels ,
+        size_t p ,
+        const double* dist ,
+        size_t n ,
+        double* out ,
+        Covar_stats* stats ,
+        int* gsl_error
+        )
+{
+    size_t nkernels = p * ( p + 1 ) / 2 ;
+    size_t np = n * p ;
+    int ret ;
+    gsl_interp_accel** acc = multi_accel_alloc( kernels, nkernels, &ret ) ;
+    double* block = scratch_alloc( p * p * sizeof(double) ) ;
+    if ( ret == GW_OK && block == NULL ) {
+
+        ret = GW_ENOMEM ;
+    }
+
+    /* upper triangle of the locations, the lower one by symmetry; the
+     * progress of 'kernels[0]' is reported as in 'gw_eval_matrix(...)' */
+    size_t total = n * ( n + 1 ) / 2 ;
+    size_t chunk = ret == GW_OK ? chunk_size( kernels[0], total ) : 1 ;
+    size_t done = 0 ;
+    size_t next = chunk ;
+    for ( size_t i = 0 ; i < n && ret == GW_OK ; i++ ) {
+
+        for ( size_t j = i ; j < n && ret == GW_OK ; j++ ) {
+
+            ret = multi_block( kernels, p, i == j ? 0 : dist[i + j*n], acc,
+                    stats, gsl_error, block ) ;
+            for ( size_t b = 0 ; b < p && ret == GW_OK ; b++ ) {
+
+                for ( size_t a = 0 ; a < p ; a++ ) {
+
+                    out[( i*p + a ) + ( j*p + b ) * np] = block[a + b*p] ;
+                    out[( j*p + b ) + ( i*p + a ) * np] = block[a + b*p] ;
+                }
+            }
+        }
+        done += n - i ;
+        if ( ret == GW_OK && done >= next && done < total ) {
+
+            ret = progress( kernels[0], done, total ) ;
+            next = done + chunk ;
+        }
+    }
+
+    scratch_free( block ) ;
+    multi_accel_free( acc, nkernels ) ;
+    return ret ;
+}
+
+int
+gw_eval_multi_spam (
+
+        const Gw_kernel* const* kernels ,
+        size_t p ,
+        const double* dist ,
+        const int* colindices ,
+        const int* rowpointers ,
+        size_t nrow ,
+        double* out ,
+        int* out_colindices ,
+        int* out_rowpointers ,
+        Covar_stats* stats ,
+        int* gsl_error
+        )
+{
+    size_t nkernels = p * ( p + 1 ) / 2 ;
+    int ret ;
+    gsl_interp_accel** acc = multi_accel_alloc( kernels, nkernels, &ret ) ;
+    double* block = scratch_alloc( p * p * sizeof(double) ) ;
+    if ( ret == GW_OK && block == NULL ) {
+
+        ret = GW_ENOMEM ;
+    }
+
+    size_t total = (size_t) ( rowpointers[nrow] - 1 ) ;
+    size_t chunk = ret == GW_OK ? chunk_size( kernels[0], total ) : 1 ;
+    size_t next = chunk ;
+    size_t pos = 0 ;
+    out_rowpointers[0] = 1 ;
+    for ( size_t i = 0 ; i < nrow && ret == GW_OK ; i++ ) {
+
+        size_t first = (size_t) ( rowpointers[i] - 1 ) ;
+        size_t last = (size_t) ( rowpointers[i+1] - 1 ) ;
+        size_t width = ( last - first ) * p ;
+        if ( first >= next ) {
+
+            ret = progress( kernels[0], first, total ) ;
+            next = first + chunk ;
+            if ( ret != GW_OK ) {
+
+                break ;
+            }
+        }
+
+        /* row i*p + a of the output contains the blocks of all entries of
+         * row i of the input, so the column indices stay sorted */
+        for ( size_t k = first ; k < last && ret == GW_OK ; k++ ) {
+
+            ret = multi_block( kernels, p, dist[k], acc, stats, gsl_error,
+                    block ) ;
+            for ( size_t a = 0 ; a < p && ret == GW_OK ; a++ ) {
+
+                size_t row_pos = pos + a * width + ( k - first ) * p ;
+                for ( size_t b = 0 ; b < p ; b++ ) {
+
+                    out[row_pos + b] = block[a + b*p] ;
+                    out_colindices[row_pos + b] =
+                        (int) ( ( colindices[k] - 1 ) * p + b ) + 1 ;
+                }
+            }
+        }
+        for ( size_t a = 0 ; a < p ; a++ ) {
+
+            pos += width ;
+            out_rowpointers[i*p + a + 1] = (int) pos + 1 ;
+        }
+    }
+
+    scratch_free( block ) ;
+    multi_accel_free( acc, nkernels ) ;
+    return ret ;
+}
+
+int
+gw_eval_blocks (
+
+        const Gw_kernel* kernel ,
+        const double* coords ,
+        size_t n ,
+        int dim ,
+        const size_t* starts ,
+        size_t nblocks ,
+        double* out ,
+        int nthreads ,
+        int* gsl_error
+        )
+{
+    double rnge2 = kernel->params.rnge * kernel->params.rnge ;
+    int nt = thread_count( nthreads ) ;
+    int status = GW_OK ;
+
+    /* bounding boxes of the blocks */
+    double* lo = scratch_alloc( ( nblocks > 0 ? nblocks : 1 ) * dim
+            * sizeof(double) ) ;
+    double* hi = scratch_alloc( ( nblocks > 0 ? nblocks : 1 ) * dim
+            * sizeof(double) ) ;
+    if ( lo == NULL || hi == NULL ) {
+
+        scratch_free( lo ) ;
+        scratch_free( hi ) ;
+        return GW_ENOMEM ;
+    }
+    for ( size_t b = 0 ; b < nblocks ; b++ ) {
+
+        tile_box( coords, n, dim, starts[b], starts[b+1] - starts[b],
+                lo + b*dim, hi + b*dim ) ;
+    }
+
+    #pragma omp parallel num_threads(nt)
+    {
+        int ret ;
+        int gsl = 0 ;
+        gsl_interp_accel* acc = accel_alloc( kernel, &ret ) ;
+
+        #pragma omp for schedule(dynamic, 1)
+        for ( size_t b = 0 ; b < nblocks ; b++ ) {
+
+            for ( size_t a = 0 ; a <= b && ret == GW_OK ; a++ ) {
+
+                size_t na = starts[a+1] - starts[a] ;
+                size_t nb = starts[b+1] - starts[b] ;
+                double sum = 0 ;
+                if ( na == 0 || nb == 0
+                        || box_gap( lo + a*dim, hi + a*dim, lo + b*dim,
+                            hi + b*dim, dim ) >= rnge2 ) {
+                    /* no pair within the range */
+
+                    out[a + b*nblocks] = 0 ;
+                    continue ;
+                }
+                for ( size_t i = starts[a] ; i < starts[a+1] ; i++ ) {
+
+                    for ( size_t j = starts[b] ; j < starts[b+1] ; j++ ) {
+
+                        double v ;
+                        ret = point_value( kernel, point_dist( coords + i, n,
+                                    coords + j, n, dim ), acc, &gsl, &v ) ;
+                        if ( ret != GW_OK ) {
+
+                            break ;
+                        }
+                        sum += v ;
+                    }
+                    if ( ret != GW_OK ) {
+
+                        break ;
+                    }
+                }
+                out[a + b*nblocks] = sum / ( (double) na * (double) nb ) ;
+            }
+        }
+        if ( ret != GW_OK ) {
+
+            #pragma omp critical (gw_parallel_error)
+            {
+                if ( status == GW_OK ) {
+
+                    status = ret ;
+                    *gsl_error = gsl ;
+                }
+            }
+        }
+        if ( acc != NULL ) {
+
+            gsl_interp_accel_free( acc ) ;
+        }
+    }
+
+    for ( size_t b = 0 ; b < nblocks ; b++ ) {
+
+        for ( size_t a = b + 1 ; a < nblocks ; a++ ) {
+
+            out[a + b*nblocks] = out[b + a*nblocks] ;
+        }
+    }
+    scratch_free( lo ) ;
+    scratch_free( hi ) ;
+    return status ;
+}
+
+int
+gw_eval_boxes (
+
+        const Gw_kernel* kernel ,
+        const double* lower ,
+        const double* upper ,
+        size_t nblocks ,
+        int dim ,
+        double tol ,
+        size_t max_points ,
+        double* out ,
+        int nthreads ,
+        int* gsl_error
+        )
+{
+    double rnge2 = kernel->params.rnge * kernel->params.rnge ;
+    int nt = thread_count( nthreads ) ;
+    int status = GW_OK ;
+    size_t nshapes = 0 ;
+
+    if ( dim < 1 || max_points < 1 ) {
+
+        return GW_EINVAL ;
+    }
+
+    /* boxes of the same shape have the same self-covariance: sorted by
+     * shape, the first box of each shape is calculated ('leader') */
+    Box_shape* shapes = scratch_alloc( ( nblocks > 0 ? nblocks : 1 )
+            * sizeof(Box_shape) ) ;
+    size_t* leader = scratch_alloc( ( nblocks > 0 ? nblocks : 1 )
+            * sizeof(size_t) ) ;
+    if ( shapes == NULL || leader == NULL ) {
+
+        scratch_free( shapes ) ;
+        scratch_free( leader ) ;
+        return GW_ENOMEM ;
+    }
+    for ( size_t b = 0 ; b < nblocks ; b++ ) {
+
+        shapes[b] = (Box_shape) { lower + b, upper + b, nblocks, dim, b } ;
+    }
+    qsort( shapes, nblocks, sizeof(Box_shape), compare_shape ) ;
+    for ( size_t k = 0 ; k < nblocks ; k++ ) {
+
+        if ( k == 0 || compare_shape( shapes + k - 1, shapes + k ) != 0 ) {
+
+            leader[nshapes++] = k ;
+        }
+    }
+
+    #pragma omp parallel num_threads(nt)
+    {
+        int ret ;
+        int gsl = 0 ;
+        gsl_interp_accel* acc = accel_alloc( kernel, &ret ) ;
+        double* points_a = scratch_alloc( 2 * max_points * dim
+                * sizeof(double) ) ;
+        double* points_b = points_a + max_points * dim ;
+        if ( points_a == NULL ) {
+
+            ret = GW_ENOMEM ;
+        }
+
+        /* self-covariances, one per shape */
+        #pragma omp for schedule(dynamic, 1)
+        for ( size_t s = 0 ; s < nshapes ; s++ ) {
+
+            if ( ret != GW_OK ) {
+
+                continue ;
+            }
+            size_t first = leader[s] ;
+            size_t last = s + 1 < nshapes ? leader[s+1] : nblocks ;
+            size_t b = shapes[first].index ;
+            double value ;
+            ret = box_average( kernel, lower + b, upper + b, lower + b,
+                    upper + b, nblocks, dim, tol, max_points, points_a,
+                    points_b, acc, &gsl, &value ) ;
+            for ( size_t k = first ; k < last ; k++ ) {
+
+                size_t c = shapes[k].index ;
+                out[c + c*nblocks] = value ;
+            }
+        }
+
+        /* pairs of different boxes */
+        #pragma omp for schedule(dynamic, 1)
+        for ( size_t b = 0 ; b < nblocks ; b++ ) {
+
+            for ( size_t a = 0 ; a < b && ret == GW_OK ; a++ ) {
+
+                double gap = 0 ;
+                for ( int l = 0 ; l < dim ; l++ ) {
+
+                    double d = fmax( 0, fmax(
+                                lower[a + l*nblocks] - upper[b + l*nblocks],
+                                lower[b + l*nblocks] - upper[a + l*nblocks] ) ) ;
+                    gap += d * d ;
+                }
+                if ( gap >= rnge2 ) {
+
+                    out[a + b*nblocks] = 0 ;
+                    continue ;
+                }
+                ret = box_average( kernel, lower + a, upper + a, lower + b,
+                        upper + b, nblocks, dim, tol, max_points, points_a,
+                        points_b, acc, &gsl, out + a + b*nblocks ) ;
+            }
+        }
+        if ( ret != GW_OK ) {
+
+            #pragma omp critical (gw_parallel_error)
+            {
+                if ( status == GW_OK ) {
+
+                    status = ret ;
+                    *gsl_error = gsl ;
+                }
+            }
+        }
+        scratch_free( points_a ) ;
+        if ( acc != NULL ) {
+
+            gsl_interp_accel_free( acc ) ;
+        }
+    }
+
+    for ( size_t b = 0 ; b < nblocks ; b++ ) {
+
+        for ( size_t a = b + 1 ; a < nblocks ; a++ ) {
+
+            out[a + b*nblocks] = out[b + a*nblocks] ;
+        }
+    }
+    scratch_free( shapes ) ;
+    scratch_free( leader ) ;
+    return status ;
+}
+
+int
+gw_eval_compact (
+
+        const Gw_kernel* kernel ,
+        const double* dist ,
+        const int* colindices ,
+        const int* rowpointers ,
+        size_t nrow ,
+        double* out ,
+        int* out_colindices ,
+        int* out_rowpointers ,
+        size_t* nnz ,
+        Covar_stats* stats ,
+        int* gsl_error
+        )
+{
+    return eval_compact( kernel, dist, colindices, rowpointers, 0, nrow, out,
+            out_colindices, out_rowpointers, nnz, stats, gsl_error ) ;
+}
+
+int
+gw_eval_compact64 (
+
+        const Gw_kernel* kernel ,
+        const double* dist ,
+        const double* colindices ,
+        const double* rowpointers ,
+        size_t nrow ,
+        double* out ,
+        double* out_colindices ,
+        double* out_rowpointers ,
+        size_t* nnz ,
+        Covar_stats* stats ,
+        int* gsl_error
+        )
+{
+    return eval_compact( kernel, dist, colindices, rowpointers, 1, nrow, out,
+            out_colindices, out_rowpointers, nnz, stats, gsl_error ) ;
+}
+
+const char*
+gw_strerror (
+
+        int status
+        )
+{
+    switch ( status ) {
+
+        case GW_OK: return "success" ;
+        case GW_ENOMEM: return "out of memory" ;
+        case GW_EINTEG: return "numerical integration failed" ;
+        case GW_EBETA: return "calculation of the beta function failed" ;
+        case GW_EINVAL: return "invalid argument" ;
+        case GW_EIO: return "input/output error" ;
+        case GW_ENOTPD: return "matrix not positive definite" ;
+        case GW_EBESSEL: return "calculation of the Bessel function failed" ;
+        case GW_ECANCEL: return "calculation cancelled" ;
+        default: return "unknown error" ;
+    }
+}
@@ -0,0 +1,551 @@
+/* This file is part of the R-package 'GWcovar'
+ *
+ * Copyright (C) 2019 Josef Stocker <josef@josefstocker.ch>
+ *
+ * 'GWcovar' is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <https://www.gnu.org/licenses/>.
+ * */
+
+#ifndef GWCOVAR_H_
+#define GWCOVAR_H_
+
+/* ****************************************************************************
+ * Plain C interface of 'libgwcovar', the part of 'GWcovar' that does not
+ * depend on R. It can be built as shared library with
+ *
+ *      make libgwcovar.so
+ *
+ * and used from C or C++ programs by including this header (together with
+ * 'wendland.h' and 'stats.h') and linking with '-lgwcovar -lgsl -lgslcblas
+ * -lm'. The R package itself is a thin wrapper around these functions.
+ *
+ * A kernel ('Gw_kernel') holds the parameters of the GW covariance function
+ * and, optionally, an interpolation table. Only 'gw_kernel_base(...)' and
+ * 'gw_kernel_progress(...)' change a kernel after it has been created; they
+ * have to be called before the kernel is used, and not at all while another
+ * thread evaluates it. Otherwise the evaluation functions only read the
+ * kernel, so one kernel without a progress callback can be used by many
+ * threads at the same time.
+ * The functions report errors by their return value; nothing is printed.
+ * Their scratch buffers (tables, kernels, workspaces) can be taken from a
+ * pool that keeps them for the next call, see 'scratch_use(...)' in
+ * 'scratch.h'.
+ * ***************************************************************************/
+
+
+/* ****************************************************************************
+ * ** Include directives  *****************************************************
+ * ***************************************************************************/
+
+#include "stddef.h" /* for type size_t */
+
+#include "wendland.h"
+#include "stats.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+
+/* ***************************************************************************
+ * ** Public data structures *************************************************
+ * **************************************************************************/
+
+#define GW_OK 0
+#define GW_ENOMEM 1
+#define GW_EINTEG 2
+#define GW_EBETA 3
+#define GW_EINVAL 4
+#define GW_EIO 5
+#define GW_ENOTPD 6
+#define GW_EBESSEL 7
+#define GW_ECANCEL 8
+/* return values of the functions in 'gwcovar.c': success, out of memory,
+ * numerical integration failed, beta function failed, invalid argument,
+ * input/output error, matrix not positive definite, Bessel function failed,
+ * cancelled by the progress callback */
+
+typedef struct Gw_kernel Gw_kernel ;
+/* GW covariance function with fixed parameters (opaque) */
+
+typedef int (*Gw_progress) (
+/* ***************************************************************************
+ * Progress callback, see 'gw_kernel_progress(...)'. It gets the number of
+ * values calculated so far ('done') out of 'total' and the pointer 'ctx'
+ * given to 'gw_kernel_progress(...)'. A non-zero return value cancels the
+ * calculation.
+ * **************************************************************************/
+        size_t done ,
+        size_t total ,
+        void* ctx
+        ) ;
+
+#define GW_BASE_NONE 0
+#define GW_BASE_EXPONENTIAL 1
+#define GW_BASE_MATERN 2
+/* types of base correlation functions */
+
+typedef struct {
+/* ***************************************************************************
+ * Correlation function that is tapered by the GW function, see
+ * 'gw_kernel_base(...)'. With x = dist / rnge the exponential correlation is
+ * exp(-x) and the Matern correlation 2^(1-nu) / Gamma(nu) x^nu K_nu(x), where
+ * nu is 'smoothness' and K_nu the modified Bessel function of the second
+ * kind (the parametrisation of 'cov.mat' in 'spam').
+ * **************************************************************************/
+    int type ;
+    /* 'GW_BASE_NONE', 'GW_BASE_EXPONENTIAL' or 'GW_BASE_MATERN' */
+
+    double rnge ;
+    /* range (scale) parameter, positive */
+
+    double smoothness ;
+    /* smoothness of the Matern correlation, positive */
+} Gw_base ;
+
+
+
+/* ***************************************************************************
+ * ***************************************************************************
+ * ** Public functions  ******************************************************
+ * ***************************************************************************
+ * **************************************************************************/
+
+int
+gw_kernel_new (
+/* ***************************************************************************
+ * The function 'int gw_kernel_new(...)' creates a kernel with the parameters
+ * 'params' (the parameter 'eps' only matters for 'gw_eval(...)').
+ *
+ *
+ *  ****************
+ *  ** Arguments: **
+ *  ****************
+ *
+ *  -> Gw_kernel** kernel:  the new kernel is returned here ('NULL' on
+ *                          error).
+ *
+ *  -> const Gw_params* params:
+ *                          parameters; 'rnge' and 'mu' have to be positive,
+ *                          'smoothness' not negative.
+ *
+ *  -> size_t n_interpol:   '0' to calculate every value by numerical
+ *                          integration, otherwise the number of equidistant
+ *                          points (at least 3) of a table from which the
+ *                          values are interpolated with cubic splines. The
+ *                          table is calculated here.
+ *
+ *  -> Covar_stats* stats:  statistics the integrations for the table are
+ *                          recorded in, or 'NULL'.
+ *
+ *  -> int* gsl_error:      the GSL error code is written here if the
+ *                          calculation of the table fails; may be 'NULL'.
+ *
+ *  ******************
+ *  ** Return value **
+ *  ******************
+ *
+ *  'GW_OK', 'GW_EINVAL', 'GW_ENOMEM', 'GW_EINTEG' or 'GW_EBETA'.
+ *
+ * **************************************************************************/
+        Gw_kernel** kernel ,
+        const Gw_params* params ,
+        size_t n_interpol ,
+        Covar_stats* stats ,
+        int* gsl_error
+        ) ;
+
+
+int
+gw_kernel_wrap (
+/* ***************************************************************************
+ * The function 'int gw_kernel_wrap(...)' creates a kernel which interpolates
+ * the existing table 'values' of the GW correlation function in the
+ * 'n_interpol' points i / (n_interpol-1) of the normalised distance, e.g. a
+ * table from the table store ('store.h') or from 'gw_kernel_table(...)'. The
+ * values are not copied and have to stay valid until the kernel is freed.
+ * Returns 'GW_OK', 'GW_EINVAL' or 'GW_ENOMEM'.
+ * **************************************************************************/
+        Gw_kernel** kernel ,
+        const Gw_params* params ,
+        size_t n_interpol ,
+        const double* values
+        ) ;
+
+
+int
+gw_kernel_adopt (
+/* ***************************************************************************
+ * Same as 'gw_kernel_wrap(...)', but the kernel takes over 'values', which
+ * have to be allocated with 'scratch_alloc(...)' (see 'scratch.h'), e.g. a
+ * table interpolated from a surface ('surface.h'). The values are freed
+ * with the kernel, and also if an error is returned.
+ * **************************************************************************/
+        Gw_kernel** kernel ,
+        const Gw_params* params ,
+        size_t n_interpol ,
+        double* values
+        ) ;
+
+
+int
+gw_kernel_base (
+/* ***************************************************************************
+ * The function 'int gw_kernel_base(...)' turns 'kernel' into a taper: after
+ * the call the kernel evaluates
+ *
+ *      sill * B(dist) * GW(dist)          for eps <= dist < range ,
+ *
+ * where B is the correlation function 'base' and GW the GW correlation
+ * function, in the same pass over the distances. For a kernel with an
+ * interpolation table the product B * GW is tabulated in the points of the
+ * GW table, so each distance needs a single interpolation; the GW table
+ * itself (see 'gw_kernel_table(...)') is not changed. A base of type
+ * 'GW_BASE_NONE' removes the taper again. The function has to be called
+ * before the kernel is shared between threads. Returns 'GW_OK', 'GW_EINVAL',
+ * 'GW_ENOMEM' or 'GW_EBESSEL' (with the GSL error code in 'gsl_error', which
+ * may be 'NULL').
+ * **************************************************************************/
+        Gw_kernel* kernel ,
+        const Gw_base* base ,
+        int* gsl_error
+        ) ;
+
+
+void
+gw_kernel_progress (
+/* ***************************************************************************
+ * The function 'void gw_kernel_progress(...)' makes 'gw_eval(...)',
+ * 'gw_eval_matrix(...)' and 'gw_eval_compact(...)' work in chunks of (about)
+ * 'chunk' values and call 'progress' after every chunk, e.g. to report the
+ * progress or to check whether the user wants to stop. If the callback
+ * returns a non-zero value, the function stops after the current chunk and
+ * returns 'GW_ECANCEL'; the output is only partially written then, but all
+ * memory allocated by the function has been released. 'progress' is called
+ * by the thread that evaluates the kernel, so a kernel with a callback
+ * should not be shared between threads. 'NULL' removes the callback. Like
+ * 'gw_kernel_base(...)' this has to be done before the kernel is used.
+ * **************************************************************************/
+        Gw_kernel* kernel ,
+        Gw_progress progress ,
+        void* ctx ,
+        size_t chunk
+        ) ;
+
+
+const double*
+gw_kernel_table (
+/* ***************************************************************************
+ * Returns the interpolation table of 'kernel' and writes its size to
+ * 'n_interpol'. Returns 'NULL' (and size 0) for a kernel without table.
+ * **************************************************************************/
+        const Gw_kernel* kernel ,
+        size_t* n_interpol
+        ) ;
+
+
+const Gw_params*
+gw_kernel_params (
+/* ***************************************************************************
+ * Returns the parameters of 'kernel'.
+ * **************************************************************************/
+        const Gw_kernel* kernel
+        ) ;
+
+
+void
+gw_kernel_free (
+/* ***************************************************************************
+ * Releases 'kernel'. 'kernel' may be 'NULL'.
+ * **************************************************************************/
+        Gw_kernel* kernel
+        ) ;
+
+
+int
+gw_eval (
+/* ***************************************************************************
+ * The function 'int gw_eval(...)' calculates the GW covariance function for
+ * the 'length' distances in 'dist' and writes them to the caller's buffer
+ * 'out', which may be 'dist' itself. Distances below 'params.eps' get sill +
+ * nugget, distances >= range get 0. The integrations are recorded in 'stats'
+ * if it is not 'NULL' and enabled; threads calling 'gw_eval(...)' at the
+ * same time have to use different 'stats'. Returns 'GW_OK', 'GW_EINTEG' or
+ * 'GW_EBETA' (with the GSL error code in 'gsl_error', which may be 'NULL')
+ * or 'GW_ENOMEM'. On error 'out' is only partially written.
+ * **************************************************************************/
+        const Gw_kernel* kernel ,
+        const double* dist ,
+        double* out ,
+        size_t length ,
+        Covar_stats* stats ,
+        int* gsl_error
+        ) ;
+
+
+int
+gw_eval_matrix (
+/* ***************************************************************************
+ * The function 'int gw_eval_matrix(...)' calculates the GW covariance matrix
+ * for the 'nrow' x 'ncol' distance matrix 'dist' (column-major) and writes
+ * it to 'out' (column-major, may be 'dist'). Distances of exactly 0 get sill
+ * + nugget. For square matrices only the upper triangle is calculated; the
+ * lower triangle is filled by symmetry and the diagonal is sill + nugget.
+ * The other arguments and the return value are the same as for
+ * 'gw_eval(...)'.
+ * **************************************************************************/
+        const Gw_kernel* kernel ,
+        const double* dist ,
+        double* out ,
+        size_t nrow ,
+        size_t ncol ,
+        Covar_stats* stats ,
+        int* gsl_error
+        ) ;
+
+
+int
+gw_eval_matrix_parallel (
+/* ***************************************************************************
+ * The function 'int gw_eval_matrix_parallel(...)' calculates the symmetric
+ * n x n GW covariance matrix like 'gw_eval_matrix(...)' with 'nthreads'
+ * OpenMP threads (<= 0: the default number). Each thread owns the columns
+ * k and n-1-k for a range of k, which balances the work of the upper
+ * triangle; it first touches the pages of its columns, so that they are
+ * placed on its NUMA node if 'out' has not been touched before (e.g.
+ * memory from 'mem_alloc(...)' in 'mem.h' or a large vector just allocated
+ * by R), calculates their upper triangle and, after all threads are done,
+ * copies the lower triangle. 'gw_matvec_parallel(...)' uses the same
+ * partition. No statistics are recorded and the progress callback is not
+ * called. See 'gw_eval(...)' for the return value.
+ * **************************************************************************/
+        const Gw_kernel* kernel ,
+        const double* dist ,
+        double* out ,
+        size_t n ,
+        int nthreads ,
+        int* gsl_error
+        ) ;
+
+
+void
+gw_matvec_parallel (
+/* ***************************************************************************
+ * The function 'void gw_matvec_parallel(...)' calculates y = a v for the
+ * symmetric n x n matrix 'a' (column major) with 'nthreads' OpenMP threads,
+ * each reading the columns that it owns in
+ * 'gw_eval_matrix_parallel(...)', i.e. memory on its own NUMA node.
+ * **************************************************************************/
+        const double* a ,
+        size_t n ,
+        const double* v ,
+        double* y ,
+        int nthreads
+        ) ;
+
+
+int
+gw_eval_coords (
+/* ***************************************************************************
+ * The function 'int gw_eval_coords(...)' calculates the dense n x n GW
+ * covariance matrix of the 'n' locations 'coords' (n x dim, column major)
+ * without a distance matrix: the distances are calculated in tiles of 64 x
+ * 64 locations together with the covariances. Only the upper triangle is
+ * calculated and tiles whose bounding boxes are farther apart than the range
+ * are set to 0 without calculating their distances. Locations closer than
+ * 'params.eps' (or at the same place) get sill + nugget. 'out' is n x n,
+ * column major. See 'gw_eval(...)' for the other arguments and the return
+ * value; 'GW_EINVAL' if dim < 1.
+ * **************************************************************************/
+        const Gw_kernel* kernel ,
+        const double* coords ,
+        size_t n ,
+        int dim ,
+        double* out ,
+        Covar_stats* stats ,
+        int* gsl_error
+        ) ;
+
+
+int
+gw_eval_multi_matrix (
+/* ***************************************************************************
+ * The function 'int gw_eval_multi_matrix(...)' calculates the covariance
+ * matrix of 'p' variables at 'n' locations from the n x n distance matrix
+ * 'dist' in a single pass. 'kernels' holds the p(p+1)/2 GW covariance
+ * functions of the pairs of variables a <= b (0-based) at position
+ * a + b(b+1)/2; the sill of a cross-covariance (a < b) is the covariance of
+ * the two variables at the same location. The output 'out' (np x np,
+ * column major) is interleaved by location: row i*p + a belongs to
+ * location i and variable a. Distances 0 (and below 'eps' of the kernel)
+ * get sill + nugget. The validity of the multivariate model is not checked.
+ * The progress callback of 'kernels[0]' is used; see 'gw_eval(...)' for
+ * the other arguments and the return value.
+ * **************************************************************************/
+        const Gw_kernel* const* kernels ,
+        size_t p ,
+        const double* dist ,
+        size_t n ,
+        double* out ,
+        Covar_stats* stats ,
+        int* gsl_error
+        ) ;
+
+
+int
+gw_eval_multi_spam (
+/* ***************************************************************************
+ * Same as 'gw_eval_multi_matrix(...)' for a sparse distance matrix with
+ * 'nrow' rows in the compressed row format of 'spam'. Every entry of the
+ * distance matrix becomes a dense p x p block, so 'out' and
+ * 'out_colindices' have p^2 times as many entries as 'dist' and
+ * 'out_rowpointers' has nrow*p + 1 entries. The column indices are sorted
+ * within each row, as 'spam' requires.
+ * **************************************************************************/
+        const Gw_kernel* const* kernels ,
+        size_t p ,
+        const double* dist ,
+        const int* colindices ,
+        const int* rowpointers ,
+        size_t nrow ,
+        double* out ,
+        int* out_colindices ,
+        int* out_rowpointers ,
+        Covar_stats* stats ,
+        int* gsl_error
+        ) ;
+
+
+int
+gw_eval_blocks (
+/* ***************************************************************************
+ * The function 'int gw_eval_blocks(...)' calculates the block-averaged GW
+ * covariances of 'nblocks' blocks given by points, e.g. samples within
+ * polygons: block b consists of the locations starts[b], ...,
+ * starts[b+1]-1 of 'coords' (n x dim, column-major as in R), so 'starts'
+ * has nblocks+1 entries and starts[nblocks] <= n. Entry (a,b) of 'out'
+ * (nblocks x nblocks, column-major) is the mean of the covariance function
+ * over all pairs of points of the blocks a and b; pairs closer than
+ * 'params.eps' get sill + nugget. Blocks whose bounding boxes are at least
+ * the range apart are skipped. The columns are distributed over 'nthreads'
+ * OpenMP threads (see 'gw_eval_matrix_parallel(...)'). Returns the same
+ * codes as 'gw_eval(...)'.
+ * **************************************************************************/
+        const Gw_kernel* kernel ,
+        const double* coords ,
+        size_t n ,
+        int dim ,
+        const size_t* starts ,
+        size_t nblocks ,
+        double* out ,
+        int nthreads ,
+        int* gsl_error
+        ) ;
+
+
+int
+gw_eval_boxes (
+/* ***************************************************************************
+ * The function 'int gw_eval_boxes(...)' calculates the block-averaged GW
+ * covariances of 'nblocks' axis-aligned boxes with the corners 'lower' and
+ * 'upper' (nblocks x dim, column-major). The mean over the pairs of points
+ * of two boxes is approximated by the midpoint rule with m^dim points per
+ * box, where m = 1, 2, 4, ... is doubled until two successive rules differ
+ * by at most 'tol' relative to the value (or to 1e-3 times the sill for
+ * small values) or the next rule would need more than 'max_points' points
+ * per box. Boxes at least the range apart are skipped, and the
+ * self-covariance is calculated once for all boxes of the same shape (the
+ * usual case for a grid of cells). Since the nugget has measure zero within
+ * a box, the kernel should normally be created with nugget 0. 'out' and
+ * 'nthreads' are as in 'gw_eval_blocks(...)'. Returns the same codes as
+ * 'gw_eval(...)' and 'GW_EINVAL' if dim < 1 or max_points < 1.
+ * **************************************************************************/
+        const Gw_kernel* kernel ,
+        const double* lower ,
+        const double* upper ,
+        size_t nblocks ,
+        int dim ,
+        double tol ,
+        size_t max_points ,
+        double* out ,
+        int nthreads ,
+        int* gsl_error
+        ) ;
+
+
+int
+gw_eval_compact (
+/* ***************************************************************************
+ * The function 'int gw_eval_compact(...)' calculates the GW covariance
+ * function for the entries 'dist' of a sparse distance matrix with 'nrow'
+ * rows in the compressed row format of 'spam' (indices starting at 1) and
+ * drops the entries whose distance is at least the range, which would only
+ * be stored zeros. The values and the column indices of the remaining
+ * entries are written to 'out' and 'out_colindices', the new row pointers to
+ * 'out_rowpointers' (nrow+1) and their number to 'nnz'. The output arrays
+ * may be the input arrays themselves, since an entry is never written
+ * behind the position it is read from. Distances below 'params.eps' get
+ * sill + nugget as in 'gw_eval(...)', which also describes the other
+ * arguments and the return value. Missing distances (NaN) are kept and get
+ * the covariance NaN, so the number of entries written is the number of
+ * distances for which !( dist >= rnge ).
+ * **************************************************************************/
+        const Gw_kernel* kernel ,
+        const double* dist ,
+        const int* colindices ,
+        const int* rowpointers ,
+        size_t nrow ,
+        double* out ,
+        int* out_colindices ,
+        int* out_rowpointers ,
+        size_t* nnz ,
+        Covar_stats* stats ,
+        int* gsl_error
+        ) ;
+
+
+int
+gw_eval_compact64 (
+/* ***************************************************************************
+ * Same as 'gw_eval_compact(...)' for the 64-bit format of 'spam' ("spam64"),
+ * which stores the column indices and the row pointers as doubles so that a
+ * matrix can have more than 2^31 - 1 entries.
+ * **************************************************************************/
+        const Gw_kernel* kernel ,
+        const double* dist ,
+        const double* colindices ,
+        const double* rowpointers ,
+        size_t nrow ,
+        double* out ,
+        double* out_colindices ,
+        double* out_rowpointers ,
+        size_t* nnz ,
+        Covar_stats* stats ,
+        int* gsl_error
+        ) ;
+
+
+const char*
+gw_strerror (
+/* ***************************************************************************
+ * Returns a description of the return code 'status'.
+ * **************************************************************************/
+        int status
+        ) ;
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  /* #ifndef GWCOVAR_H_ */
@@ -0,0 +1,135 @@
+/* This file is part of the R-package 'GWcovar'
+ *
+ * Copyright (C) 2019 Josef Stocker <josef@josefstocker.ch>
+ *
+ * 'GWcovar' is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <https://www.gnu.org/licenses/>.
+ * */
+
+
+/* ***************************************************************************
+ * ** Include directives  ****************************************************
+ * **************************************************************************/
+
+#include "mem.h"
+
+#include "stdint.h"
+#include "unistd.h"
+#include "sys/mman.h"
+
+/* ***************************************************************************
+ * ** Private data structures ************************************************
+ * **************************************************************************/
+
+#define MEM_HUGE_PAGE ( (size_t) 2 << 20 )
+/* size of a huge page (x86-64 and arm64 with 4 KiB base pages) */
+
+
+
+/* ***************************************************************************
+ * ** Functions **************************************************************
+ * **************************************************************************/
+
+
+/* **********************
+ * ** public functions **
+ * *********************/
+
+int
+mem_alloc (
+
+        Mem_block* block ,
+        size_t bytes ,
+        int pages
+        )
+{
+    /* whole huge pages, so that the last one can be backed as well */
+    size_t size = pages == MEM_PAGES_NONE ? bytes
+        : ( bytes + MEM_HUGE_PAGE - 1 ) / MEM_HUGE_PAGE * MEM_HUGE_PAGE ;
+    if ( size == 0 ) {
+
+        size = 1 ;
+    }
+    void* ptr = MAP_FAILED ;
+
+#ifdef MAP_HUGETLB
+    if ( pages == MEM_PAGES_EXPLICIT ) {
+
+        ptr = mmap( NULL, size, PROT_READ | PROT_WRITE,
+                MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0 ) ;
+    }
+#endif
+    if ( ptr != MAP_FAILED ) {
+
+        block->pages = MEM_PAGES_EXPLICIT ;
+    } else {
+
+        ptr = mmap( NULL, size, PROT_READ | PROT_WRITE,
+                MAP_PRIVATE | MAP_ANONYMOUS, -1, 0 ) ;
+        if ( ptr == MAP_FAILED ) {
+
+            block->ptr = NULL ;
+            block->size = 0 ;
+            return -1 ;
+        }
+        block->pages = pages == MEM_PAGES_NONE
+            ? MEM_PAGES_NONE : MEM_PAGES_TRANSPARENT ;
+        mem_advise( ptr, size, block->pages ) ;
+    }
+    block->ptr = ptr ;
+    block->size = size ;
+    return 0 ;
+}
+
+void
+mem_advise (
+
+        void* ptr ,
+        size_t bytes ,
+        int pages
+        )
+{
+#ifdef MADV_HUGEPAGE
+    if ( pages == MEM_PAGES_NONE || bytes < MEM_HUGE_PAGE ) {
+
+        return ;
+    }
+    uintptr_t first = ( (uintptr_t) ptr + MEM_HUGE_PAGE - 1 )
+        / MEM_HUGE_PAGE * MEM_HUGE_PAGE ;
+    uintptr_t last = ( (uintptr_t) ptr + bytes ) / MEM_HUGE_PAGE
+        * MEM_HUGE_PAGE ;
+    if ( last > first ) {
+        /* only a hint, errors are ignored */
+
+        madvise( (void*) first, last - first, MADV_HUGEPAGE ) ;
+    }
+#else
+    (void) ptr ;
+    (void) bytes ;
+    (void) pages ;
+#endif
+}
+
+void
+mem_free (
+
+        Mem_block* block
+        )
+{
+    if ( block->ptr != NULL ) {
+
+        munmap( block->ptr, block->size ) ;
+    }
+    block->ptr = NULL ;
+    block->size = 0 ;
+}
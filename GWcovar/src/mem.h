@@ -0,0 +1,113 @@
+/* This file is part of the R-package 'GWcovar'
+ *
+ * Copyright (C) 2019 Josef Stocker <josef@josefstocker.ch>
+ *
+ * 'GWcovar' is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <https://www.gnu.org/licenses/>.
+ * */
+
+#ifndef MEM_H_
+#define MEM_H_
+
+
+/* ****************************************************************************
+ * ** Include directives  *****************************************************
+ * ***************************************************************************/
+
+#include "stddef.h" /* for type size_t */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+
+/* ***************************************************************************
+ * ** Public data structures *************************************************
+ * **************************************************************************/
+
+#define MEM_PAGES_NONE 0
+/* normal pages */
+
+#define MEM_PAGES_TRANSPARENT 1
+/* transparent huge pages: the kernel is asked to back the memory with huge
+ * pages where it can ('madvise(MADV_HUGEPAGE)') */
+
+#define MEM_PAGES_EXPLICIT 2
+/* explicit huge pages from the pool of the system ('MAP_HUGETLB', see
+ * /proc/sys/vm/nr_hugepages); falls back to transparent huge pages if the
+ * pool is too small */
+
+typedef struct {
+/* ***************************************************************************
+ * Memory mapped with 'mem_alloc(...)'. The pages are not touched, so they
+ * are placed on the NUMA node of the thread that writes them first.
+ * **************************************************************************/
+    void* ptr ;
+    /* start of the memory */
+
+    size_t size ;
+    /* size of the mapping in bytes */
+
+    int pages ;
+    /* kind of pages actually used */
+} Mem_block ;
+
+
+
+/* ***************************************************************************
+ * ***************************************************************************
+ * ** Public functions  ******************************************************
+ * ***************************************************************************
+ * **************************************************************************/
+
+int
+mem_alloc (
+/* ***************************************************************************
+ * The function 'int mem_alloc(...)' maps 'bytes' of anonymous memory with
+ * the kind of pages 'pages' (one of 'MEM_PAGES_*') and describes it in
+ * 'block'. Returns '0' on success and '-1' if no memory could be mapped.
+ * **************************************************************************/
+        Mem_block* block ,
+        size_t bytes ,
+        int pages
+        ) ;
+
+
+void
+mem_advise (
+/* ***************************************************************************
+ * Asks for transparent huge pages for the part of the memory [ptr, ptr +
+ * bytes) that consists of whole huge pages, e.g. for a large vector
+ * allocated by R whose pages have not been touched yet. Does nothing for
+ * 'pages == MEM_PAGES_NONE' or where 'madvise' is not available.
+ * **************************************************************************/
+        void* ptr ,
+        size_t bytes ,
+        int pages
+        ) ;
+
+
+void
+mem_free (
+/* ***************************************************************************
+ * Unmaps the memory of 'block'.
+ * **************************************************************************/
+        Mem_block* block
+        ) ;
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  /* #ifndef MEM_H_ */
@@ -0,0 +1,862 @@
+/* This file is part of the R-package 'GWcovar'
+ *
+ * Copyright (C) 2019 Josef Stocker <josef@josefstocker.ch>
+ *
+ * 'GWcovar' is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <https://www.gnu.org/licenses/>.
+ * */
+
+
+/* ***************************************************************************
+ * ** Include directives  ****************************************************
+ * **************************************************************************/
+
+#include "gwmpi.h"
+
+#include "stdlib.h"
+#include "string.h"
+#include "limits.h"
+#include "math.h"
+
+#include "grid_index.h"
+
+/* ***************************************************************************
+ * ** Private data structures ************************************************
+ * **************************************************************************/
+
+#define GWMPI_SAMPLES 16
+/* samples per rank and slab to find the bounds of the slabs */
+
+typedef struct {
+    /* sample of the coordinate along the split axis, standing for 'weight'
+     * locations */
+    double value ;
+    double weight ;
+} Sample ;
+
+typedef struct {
+    /* neighbour of a location: local index, global index and distance */
+    size_t index ;
+    uint64_t global ;
+    double dist ;
+} Neighbour ;
+
+typedef struct {
+    /* neighbours of the current row, filled by 'row_visit(...)' */
+    Neighbour* nb ;
+    size_t n ;
+    size_t size ;
+    const uint64_t* global ;    /* global indices of the own locations */
+    const uint64_t* halo ;      /* global indices of the halo */
+    size_t n_local ;
+    int error ;
+} Row ;
+
+
+
+/* ***************************************************************************
+ * ** Functions **************************************************************
+ * **************************************************************************/
+
+
+/* ***********************
+ * ** private functions **
+ * **********************/
+
+static int
+agree (
+
+        MPI_Comm comm ,
+        int ret
+        )
+/* largest return value of all ranks, so that all ranks take the same
+ * branch after an error on one of them */
+{
+    int all = ret ;
+    MPI_Allreduce( &ret, &all, 1, MPI_INT, MPI_MAX, comm ) ;
+    return all ;
+}
+
+static int
+compare_sample (
+
+        const void* a ,
+        const void* b
+        )
+/* comparison function for 'qsort' */
+{
+    double va = ((const Sample*) a)->value ;
+    double vb = ((const Sample*) b)->value ;
+    return ( va > vb ) - ( va < vb ) ;
+}
+
+static int
+compare_double (
+
+        const void* a ,
+        const void* b
+        )
+/* comparison function for 'qsort' */
+{
+    double va = *(const double*) a ;
+    double vb = *(const double*) b ;
+    return ( va > vb ) - ( va < vb ) ;
+}
+
+static int
+compare_neighbour (
+
+        const void* a ,
+        const void* b
+        )
+/* comparison function for 'qsort' */
+{
+    uint64_t ga = ((const Neighbour*) a)->global ;
+    uint64_t gb = ((const Neighbour*) b)->global ;
+    return ( ga > gb ) - ( ga < gb ) ;
+}
+
+static int
+slab_owner (
+
+        const double* slabs ,
+        int size ,
+        double x
+        )
+/* rank whose slab [slabs[r], slabs[r+1]) contains 'x' */
+{
+    int lo = 0 ;
+    int hi = size - 1 ;
+    while ( lo < hi ) {
+
+        int mid = ( lo + hi + 1 ) / 2 ;
+        if ( slabs[mid] <= x ) {
+
+            lo = mid ;
+        } else {
+
+            hi = mid - 1 ;
+        }
+    }
+    return lo ;
+}
+
+static void
+row_visit (
+
+        size_t index ,
+        double dist ,
+        void* ctx
+        )
+/* callback of 'grid_index_query(...)': appends the neighbour to the row */
+{
+    Row* row = ctx ;
+    if ( row->n == row->size ) {
+
+        size_t size = row->size > 0 ? 2 * row->size : 64 ;
+        Neighbour* nb = realloc( row->nb, size * sizeof(Neighbour) ) ;
+        if ( nb == NULL ) {
+
+            row->error = GW_ENOMEM ;
+            return ;
+        }
+        row->nb = nb ;
+        row->size = size ;
+    }
+    row->nb[row->n].index = index ;
+    row->nb[row->n].global = index < row->n_local ? row->global[index]
+        : row->halo[index - row->n_local] ;
+    row->nb[row->n].dist = dist ;
+    row->n++ ;
+}
+
+static int
+find_slabs (
+
+        Gw_mpi_matrix* matrix ,
+        const double* coords ,
+        size_t n
+        )
+/* chooses the split axis and the bounds of the slabs, so that each rank
+ * gets about the same number of locations (collective) */
+{
+    int dim = matrix->dim ;
+    int size = matrix->size ;
+    double* lower = malloc( 2 * dim * sizeof(double) ) ;
+    double* axis_values = malloc( ( n > 0 ? n : 1 ) * sizeof(double) ) ;
+    int* counts = malloc( 2 * size * sizeof(int) ) ;
+    int ret = lower != NULL && axis_values != NULL && counts != NULL
+        ? GW_OK : GW_ENOMEM ;
+    if ( agree( matrix->comm, ret ) != GW_OK ) {
+
+        free( lower ) ;
+        free( axis_values ) ;
+        free( counts ) ;
+        return GW_ENOMEM ;
+    }
+
+    /* global bounding box: lower corner and negated upper corner */
+    double* upper = lower + dim ;
+    for ( int d = 0 ; d < dim ; d++ ) {
+
+        lower[d] = INFINITY ;
+        upper[d] = INFINITY ;
+        for ( size_t i = 0 ; i < n ; i++ ) {
+
+            lower[d] = fmin( lower[d], coords[i + d*n] ) ;
+            upper[d] = fmin( upper[d], -coords[i + d*n] ) ;
+        }
+    }
+    MPI_Allreduce( MPI_IN_PLACE, lower, 2 * dim, MPI_DOUBLE, MPI_MIN,
+            matrix->comm ) ;
+    matrix->axis = 0 ;
+    for ( int d = 1 ; d < dim ; d++ ) {
+
+        if ( -upper[d] - lower[d]
+                > -upper[matrix->axis] - lower[matrix->axis] ) {
+
+            matrix->axis = d ;
+        }
+    }
+
+    /* weighted regular samples of the sorted coordinates */
+    for ( size_t i = 0 ; i < n ; i++ ) {
+
+        axis_values[i] = coords[i + matrix->axis * n] ;
+    }
+    qsort( axis_values, n, sizeof(double), compare_double ) ;
+    size_t wanted = (size_t) GWMPI_SAMPLES * size ;
+    int nsamples = (int) ( n < wanted ? n : wanted ) ;
+    Sample* own = malloc( ( nsamples > 0 ? nsamples : 1 ) * sizeof(Sample) ) ;
+    ret = own != NULL ? GW_OK : GW_ENOMEM ;
+    for ( int k = 0 ; k < nsamples && own != NULL ; k++ ) {
+
+        own[k].value = axis_values[(size_t) ( ( k + 0.5 ) * n / nsamples )] ;
+        own[k].weight = (double) n / nsamples ;
+    }
+    MPI_Allgather( &nsamples, 1, MPI_INT, counts, 1, MPI_INT, matrix->comm ) ;
+    int* displs = counts + size ;
+    int total = 0 ;
+    for ( int r = 0 ; r < size ; r++ ) {
+
+        displs[r] = total ;
+        total += counts[r] ;
+    }
+    Sample* all = malloc( ( total > 0 ? total : 1 ) * sizeof(Sample) ) ;
+    if ( all == NULL ) {
+
+        ret = GW_ENOMEM ;
+    }
+    if ( agree( matrix->comm, ret ) != GW_OK ) {
+
+        free( own ) ;
+        free( all ) ;
+        free( lower ) ;
+        free( axis_values ) ;
+        free( counts ) ;
+        return GW_ENOMEM ;
+    }
+    MPI_Datatype sample_type ;
+    MPI_Type_contiguous( 2, MPI_DOUBLE, &sample_type ) ;
+    MPI_Type_commit( &sample_type ) ;
+    MPI_Allgatherv( own, nsamples, sample_type, all, counts, displs,
+            sample_type, matrix->comm ) ;
+    MPI_Type_free( &sample_type ) ;
+    qsort( all, total, sizeof(Sample), compare_sample ) ;
+
+    /* the bound of slab r is the first sample at the r-th quantile */
+    double sum = 0 ;
+    for ( int k = 0 ; k < total ; k++ ) {
+
+        sum += all[k].weight ;
+    }
+    matrix->slabs[0] = -INFINITY ;
+    matrix->slabs[size] = INFINITY ;
+    double cum = 0 ;
+    for ( int r = 1, k = 0 ; r < size ; r++ ) {
+
+        while ( k < total && cum + all[k].weight <= r * sum / size ) {
+
+            cum += all[k].weight ;
+            k++ ;
+        }
+        matrix->slabs[r] = k < total ? all[k].value : INFINITY ;
+    }
+
+    free( own ) ;
+    free( all ) ;
+    free( lower ) ;
+    free( axis_values ) ;
+    free( counts ) ;
+    return GW_OK ;
+}
+
+static int
+exchange (
+
+        MPI_Comm comm ,
+        int size ,
+        int dim ,
+        const double* coords ,
+        const uint64_t* global ,
+        size_t n ,
+        const size_t* index ,
+        const int* send_counts ,
+        const int* send_displs ,
+        int* recv_counts ,
+        int* recv_displs ,
+        double** recv_coords ,
+        uint64_t** recv_global ,
+        size_t* n_recv
+        )
+/* sends the locations 'index' (ordered by destination, 'send_counts' per
+ * rank) and receives the locations of the other ranks, ordered by source,
+ * in site-major order (collective) */
+{
+    MPI_Alltoall( send_counts, 1, MPI_INT, recv_counts, 1, MPI_INT, comm ) ;
+    size_t n_send = 0 ;
+    *n_recv = 0 ;
+    for ( int r = 0 ; r < size ; r++ ) {
+
+        recv_displs[r] = (int) *n_recv ;
+        n_send += send_counts[r] ;
+        *n_recv += recv_counts[r] ;
+    }
+
+    int* counts = malloc( 4 * size * sizeof(int) ) ;
+    double* send_coords = malloc( ( n_send > 0 ? n_send : 1 ) * dim
+            * sizeof(double) ) ;
+    uint64_t* send_global = malloc( ( n_send > 0 ? n_send : 1 )
+            * sizeof(uint64_t) ) ;
+    *recv_coords = malloc( ( *n_recv > 0 ? *n_recv : 1 ) * dim
+            * sizeof(double) ) ;
+    *recv_global = malloc( ( *n_recv > 0 ? *n_recv : 1 )
+            * sizeof(uint64_t) ) ;
+    int ret = counts != NULL && send_coords != NULL && send_global != NULL
+        && *recv_coords != NULL && *recv_global != NULL ? GW_OK : GW_ENOMEM ;
+    if ( *n_recv * dim > INT_MAX || n_send * dim > INT_MAX ) {
+        /* the counts of MPI are 'int' */
+
+        ret = GW_EINVAL ;
+    }
+    ret = agree( comm, ret ) ;
+
+    if ( ret == GW_OK ) {
+
+        for ( size_t k = 0 ; k < n_send ; k++ ) {
+
+            size_t i = index[k] ;
+            for ( int d = 0 ; d < dim ; d++ ) {
+
+                send_coords[k*dim + d] = coords[i + d*n] ;
+            }
+            send_global[k] = global[i] ;
+        }
+        int* coord_send = counts ;
+        int* coord_sdispl = counts + size ;
+        int* coord_recv = counts + 2*size ;
+        int* coord_rdispl = counts + 3*size ;
+        for ( int r = 0 ; r < size ; r++ ) {
+
+            coord_send[r] = send_counts[r] * dim ;
+            coord_sdispl[r] = send_displs[r] * dim ;
+            coord_recv[r] = recv_counts[r] * dim ;
+            coord_rdispl[r] = recv_displs[r] * dim ;
+        }
+        MPI_Alltoallv( send_coords, coord_send, coord_sdispl, MPI_DOUBLE,
+                *recv_coords, coord_recv, coord_rdispl, MPI_DOUBLE, comm ) ;
+        MPI_Alltoallv( send_global, send_counts, send_displs, MPI_UINT64_T,
+                *recv_global, recv_counts, recv_displs, MPI_UINT64_T, comm ) ;
+    } else {
+
+        free( *recv_coords ) ;
+        free( *recv_global ) ;
+        *recv_coords = NULL ;
+        *recv_global = NULL ;
+    }
+    free( counts ) ;
+    free( send_coords ) ;
+    free( send_global ) ;
+    return ret ;
+}
+
+static int
+plan_sends (
+
+        int size ,
+        const size_t* dest_lo ,
+        const size_t* dest_hi ,
+        size_t n ,
+        int skip ,
+        int* send_counts ,
+        int* send_displs ,
+        size_t** index
+        )
+/* lists the locations by destination: location i goes to the ranks
+ * dest_lo[i], ..., dest_hi[i] except 'skip' */
+{
+    for ( int r = 0 ; r < size ; r++ ) {
+
+        send_counts[r] = 0 ;
+    }
+    size_t total = 0 ;
+    for ( size_t i = 0 ; i < n ; i++ ) {
+
+        for ( size_t r = dest_lo[i] ; r <= dest_hi[i] ; r++ ) {
+
+            if ( (int) r != skip ) {
+
+                send_counts[r]++ ;
+                total++ ;
+            }
+        }
+    }
+    if ( total > INT_MAX ) {
+
+        return GW_EINVAL ;
+    }
+    *index = malloc( ( total > 0 ? total : 1 ) * sizeof(size_t) ) ;
+    if ( *index == NULL ) {
+
+        return GW_ENOMEM ;
+    }
+    int offset = 0 ;
+    for ( int r = 0 ; r < size ; r++ ) {
+
+        send_displs[r] = offset ;
+        offset += send_counts[r] ;
+    }
+    int* fill = malloc( size * sizeof(int) ) ;
+    if ( fill == NULL ) {
+
+        free( *index ) ;
+        *index = NULL ;
+        return GW_ENOMEM ;
+    }
+    memcpy( fill, send_displs, size * sizeof(int) ) ;
+    for ( size_t i = 0 ; i < n ; i++ ) {
+
+        for ( size_t r = dest_lo[i] ; r <= dest_hi[i] ; r++ ) {
+
+            if ( (int) r != skip ) {
+
+                (*index)[fill[r]++] = i ;
+            }
+        }
+    }
+    free( fill ) ;
+    return GW_OK ;
+}
+
+static int
+build_rows (
+
+        Gw_mpi_matrix* matrix ,
+        const Gw_kernel* kernel ,
+        int* gsl_error
+        )
+/* calculates the rows of the own locations from the coordinates of the own
+ * locations and the halo */
+{
+    size_t n_all = matrix->n_local + matrix->n_halo ;
+    double rnge = gw_kernel_params( kernel )->rnge ;
+    Grid_index index ;
+    Row row = { NULL, 0, 0, matrix->global, matrix->halo_global,
+        matrix->n_local, GW_OK } ;
+    size_t nnz = 0 ;
+    size_t size = 0 ;
+    double* dist = NULL ;
+    size_t dist_size = 0 ;
+
+    matrix->rowpointers = malloc( ( matrix->n_local + 1 ) * sizeof(size_t) ) ;
+    if ( matrix->rowpointers == NULL || grid_index_build( &index,
+                matrix->coords, n_all, matrix->dim, rnge ) != 0 ) {
+
+        return GW_ENOMEM ;
+    }
+    matrix->rowpointers[0] = 0 ;
+
+    int ret = GW_OK ;
+    for ( size_t i = 0 ; i < matrix->n_local && ret == GW_OK ; i++ ) {
+
+        row.n = 0 ;
+        grid_index_query( &index, matrix->coords + i, n_all, rnge,
+                row_visit, &row ) ;
+        if ( row.error != GW_OK ) {
+
+            ret = row.error ;
+            break ;
+        }
+        qsort( row.nb, row.n, sizeof(Neighbour), compare_neighbour ) ;
+
+        if ( nnz + row.n > size ) {
+
+            size_t grow = size > 0 ? 2 * size : 1024 ;
+            while ( grow < nnz + row.n ) {
+
+                grow *= 2 ;
+            }
+            size_t* col = realloc( matrix->colindices, grow * sizeof(size_t) ) ;
+            if ( col != NULL ) {
+
+                matrix->colindices = col ;
+            }
+            double* val = realloc( matrix->entries, grow * sizeof(double) ) ;
+            if ( val != NULL ) {
+
+                matrix->entries = val ;
+            }
+            if ( col == NULL || val == NULL ) {
+
+                ret = GW_ENOMEM ;
+                break ;
+            }
+            size = grow ;
+        }
+        if ( row.n > dist_size ) {
+
+            double* d = realloc( dist, row.size * sizeof(double) ) ;
+            if ( d == NULL ) {
+
+                ret = GW_ENOMEM ;
+                break ;
+            }
+            dist = d ;
+            dist_size = row.size ;
+        }
+        for ( size_t k = 0 ; k < row.n ; k++ ) {
+
+            matrix->colindices[nnz + k] = row.nb[k].index ;
+            dist[k] = row.nb[k].dist ;
+        }
+        ret = gw_eval( kernel, dist, matrix->entries + nnz, row.n, NULL,
+                gsl_error ) ;
+        nnz += row.n ;
+        matrix->rowpointers[i+1] = nnz ;
+    }
+    free( row.nb ) ;
+    free( dist ) ;
+    grid_index_free( &index ) ;
+    return ret ;
+}
+
+
+
+/* **********************
+ * ** public functions **
+ * *********************/
+
+int
+gw_mpi_kernel_new (
+
+        Gw_mpi_kernel* kernel ,
+        MPI_Comm comm ,
+        const Gw_params* params ,
+        size_t n_interpol ,
+        int* gsl_error
+        )
+{
+    int rank ;
+    int gsl = 0 ;
+    int ret = GW_OK ;
+    MPI_Comm_rank( comm, &rank ) ;
+    kernel->kernel = NULL ;
+    kernel->values = NULL ;
+
+    if ( rank == 0 || n_interpol == 0 ) {
+
+        ret = gw_kernel_new( &kernel->kernel, params, n_interpol, NULL, &gsl ) ;
+    } else {
+
+        kernel->values = malloc( n_interpol * sizeof(double) ) ;
+        ret = kernel->values != NULL ? GW_OK : GW_ENOMEM ;
+    }
+    if ( n_interpol > INT_MAX ) {
+
+        ret = GW_EINVAL ;
+    }
+    ret = agree( comm, ret ) ;
+    if ( gsl_error != NULL ) {
+
+        MPI_Allreduce( &gsl, gsl_error, 1, MPI_INT, MPI_MAX, comm ) ;
+    }
+    if ( ret != GW_OK ) {
+
+        gw_mpi_kernel_free( kernel ) ;
+        return ret ;
+    }
+    if ( n_interpol == 0 ) {
+
+        return GW_OK ;
+    }
+
+    /* the table of rank 0 */
+    size_t n ;
+    double* values = rank == 0
+        ? (double*) gw_kernel_table( kernel->kernel, &n ) : kernel->values ;
+    MPI_Bcast( values, (int) n_interpol, MPI_DOUBLE, 0, comm ) ;
+    if ( rank != 0 ) {
+
+        ret = gw_kernel_wrap( &kernel->kernel, params, n_interpol,
+                kernel->values ) ;
+    }
+    ret = agree( comm, ret ) ;
+    if ( ret != GW_OK ) {
+
+        gw_mpi_kernel_free( kernel ) ;
+    }
+    return ret ;
+}
+
+void
+gw_mpi_kernel_free (
+
+        Gw_mpi_kernel* kernel
+        )
+{
+    gw_kernel_free( kernel->kernel ) ;
+    free( kernel->values ) ;
+    kernel->kernel = NULL ;
+    kernel->values = NULL ;
+}
+
+int
+gw_mpi_assemble (
+
+        Gw_mpi_matrix* matrix ,
+        MPI_Comm comm ,
+        const Gw_kernel* kernel ,
+        const double* coords ,
+        const uint64_t* global ,
+        size_t n ,
+        int dim ,
+        int* gsl_error
+        )
+{
+    memset( matrix, 0, sizeof(Gw_mpi_matrix) ) ;
+    matrix->comm = comm ;
+    matrix->dim = dim ;
+    MPI_Comm_rank( comm, &matrix->rank ) ;
+    MPI_Comm_size( comm, &matrix->size ) ;
+    int size = matrix->size ;
+    double rnge = gw_kernel_params( kernel )->rnge ;
+    int gsl = 0 ;
+
+    matrix->slabs = malloc( ( size + 1 ) * sizeof(double) ) ;
+    matrix->send_counts = malloc( size * sizeof(int) ) ;
+    matrix->send_displs = malloc( size * sizeof(int) ) ;
+    matrix->recv_counts = malloc( size * sizeof(int) ) ;
+    matrix->recv_displs = malloc( size * sizeof(int) ) ;
+    size_t* dest_lo = malloc( ( n > 0 ? n : 1 ) * sizeof(size_t) ) ;
+    size_t* dest_hi = malloc( ( n > 0 ? n : 1 ) * sizeof(size_t) ) ;
+    size_t* index = NULL ;
+    double* own = NULL ;
+    int ret = matrix->slabs != NULL && matrix->send_counts != NULL
+        && matrix->send_displs != NULL && matrix->recv_counts != NULL
+        && matrix->recv_displs != NULL && dest_lo != NULL && dest_hi != NULL
+        ? GW_OK : GW_ENOMEM ;
+    if ( dim < 1 ) {
+
+        ret = GW_EINVAL ;
+    }
+    ret = agree( comm, ret ) ;
+
+    /* 1. slabs and redistribution of the locations to their owners */
+    if ( ret == GW_OK ) {
+
+        ret = find_slabs( matrix, coords, n ) ;
+    }
+    if ( ret == GW_OK ) {
+
+        for ( size_t i = 0 ; i < n ; i++ ) {
+
+            int r = slab_owner( matrix->slabs, size,
+                    coords[i + matrix->axis * n] ) ;
+            dest_lo[i] = (size_t) r ;
+            dest_hi[i] = (size_t) r ;
+        }
+        ret = agree( comm, plan_sends( size, dest_lo, dest_hi, n, -1,
+                    matrix->send_counts, matrix->send_displs, &index ) ) ;
+    }
+    if ( ret == GW_OK ) {
+
+        ret = exchange( comm, size, dim, coords, global, n, index,
+                matrix->send_counts, matrix->send_displs, matrix->recv_counts,
+                matrix->recv_displs, &own, &matrix->global,
+                &matrix->n_local ) ;
+    }
+    free( index ) ;
+    index = NULL ;
+
+    /* 2. halo: the own locations closer than the range to another slab */
+    size_t n_local = matrix->n_local ;
+    double* halo = NULL ;
+    if ( ret == GW_OK ) {
+
+        size_t* lo = realloc( dest_lo, ( n_local > 0 ? n_local : 1 )
+                * sizeof(size_t) ) ;
+        dest_lo = lo != NULL ? lo : dest_lo ;
+        size_t* hi = realloc( dest_hi, ( n_local > 0 ? n_local : 1 )
+                * sizeof(size_t) ) ;
+        dest_hi = hi != NULL ? hi : dest_hi ;
+        ret = lo != NULL && hi != NULL ? GW_OK : GW_ENOMEM ;
+        for ( size_t i = 0 ; i < n_local && ret == GW_OK ; i++ ) {
+
+            double x = own[i*dim + matrix->axis] ;
+            dest_lo[i] = (size_t) slab_owner( matrix->slabs, size, x - rnge ) ;
+            dest_hi[i] = (size_t) slab_owner( matrix->slabs, size, x + rnge ) ;
+        }
+        if ( ret == GW_OK ) {
+
+            ret = plan_sends( size, dest_lo, dest_hi, n_local, matrix->rank,
+                    matrix->send_counts, matrix->send_displs,
+                    &matrix->send_index ) ;
+        }
+        ret = agree( comm, ret ) ;
+    }
+    if ( ret == GW_OK ) {
+
+        /* the own locations in column major order */
+        matrix->coords = malloc( ( n_local > 0 ? n_local : 1 ) * dim
+                * sizeof(double) ) ;
+        ret = agree( comm, matrix->coords != NULL ? GW_OK : GW_ENOMEM ) ;
+    }
+    if ( ret == GW_OK ) {
+
+        for ( size_t i = 0 ; i < n_local ; i++ ) {
+
+            for ( int d = 0 ; d < dim ; d++ ) {
+
+                matrix->coords[i + d*n_local] = own[i*dim + d] ;
+            }
+        }
+        ret = exchange( comm, size, dim, matrix->coords, matrix->global,
+                n_local, matrix->send_index, matrix->send_counts,
+                matrix->send_displs, matrix->recv_counts, matrix->recv_displs,
+                &halo, &matrix->halo_global, &matrix->n_halo ) ;
+    }
+
+    /* 3. coordinates of the own locations and the halo, rows */
+    if ( ret == GW_OK ) {
+
+        size_t n_all = n_local + matrix->n_halo ;
+        double* all = realloc( matrix->coords, ( n_all > 0 ? n_all : 1 ) * dim
+                * sizeof(double) ) ;
+        if ( all != NULL ) {
+
+            matrix->coords = all ;
+            for ( int d = dim - 1 ; d >= 0 ; d-- ) {
+                /* spread the columns from the back */
+
+                for ( size_t i = n_local ; i-- > 0 ; ) {
+
+                    all[i + d*n_all] = all[i + d*n_local] ;
+                }
+                for ( size_t k = 0 ; k < matrix->n_halo ; k++ ) {
+
+                    all[n_local + k + d*n_all] = halo[k*dim + d] ;
+                }
+            }
+        }
+        ret = agree( comm, all != NULL ? GW_OK : GW_ENOMEM ) ;
+    }
+    if ( ret == GW_OK ) {
+
+        ret = agree( comm, build_rows( matrix, kernel, &gsl ) ) ;
+        if ( gsl_error != NULL ) {
+
+            MPI_Allreduce( &gsl, gsl_error, 1, MPI_INT, MPI_MAX, comm ) ;
+        }
+    }
+
+    free( dest_lo ) ;
+    free( dest_hi ) ;
+    free( own ) ;
+    free( halo ) ;
+    if ( ret != GW_OK ) {
+
+        gw_mpi_free( matrix ) ;
+    }
+    return ret ;
+}
+
+int
+gw_mpi_matvec (
+
+        const Gw_mpi_matrix* matrix ,
+        const double* x ,
+        double* y
+        )
+{
+    int size = matrix->size ;
+    size_t n_send = (size_t) matrix->send_displs[size-1]
+        + matrix->send_counts[size-1] ;
+    double* send = malloc( ( n_send > 0 ? n_send : 1 ) * sizeof(double) ) ;
+    double* halo = malloc( ( matrix->n_halo > 0 ? matrix->n_halo : 1 )
+            * sizeof(double) ) ;
+    int ret = agree( matrix->comm, send != NULL && halo != NULL
+            ? GW_OK : GW_ENOMEM ) ;
+    if ( ret != GW_OK ) {
+
+        free( send ) ;
+        free( halo ) ;
+        return ret ;
+    }
+
+    for ( size_t k = 0 ; k < n_send ; k++ ) {
+
+        send[k] = x[matrix->send_index[k]] ;
+    }
+    MPI_Alltoallv( send, matrix->send_counts, matrix->send_displs, MPI_DOUBLE,
+            halo, matrix->recv_counts, matrix->recv_displs, MPI_DOUBLE,
+            matrix->comm ) ;
+
+    for ( size_t i = 0 ; i < matrix->n_local ; i++ ) {
+
+        double sum = 0 ;
+        for ( size_t k = matrix->rowpointers[i] ;
+                k < matrix->rowpointers[i+1] ; k++ ) {
+
+            size_t j = matrix->colindices[k] ;
+            sum += matrix->entries[k]
+                * ( j < matrix->n_local ? x[j] : halo[j - matrix->n_local] ) ;
+        }
+        y[i] = sum ;
+    }
+    free( send ) ;
+    free( halo ) ;
+    return GW_OK ;
+}
+
+void
+gw_mpi_free (
+
+        Gw_mpi_matrix* matrix
+        )
+{
+    free( matrix->slabs ) ;
+    free( matrix->global ) ;
+    free( matrix->coords ) ;
+    free( matrix->halo_global ) ;
+    free( matrix->rowpointers ) ;
+    free( matrix->colindices ) ;
+    free( matrix->entries ) ;
+    free( matrix->send_counts ) ;
+    free( matrix->send_displs ) ;
+    free( matrix->send_index ) ;
+    free( matrix->recv_counts ) ;
+    free( matrix->recv_displs ) ;
+    MPI_Comm comm = matrix->comm ;
+    memset( matrix, 0, sizeof(Gw_mpi_matrix) ) ;
+    matrix->comm = comm ;
+}
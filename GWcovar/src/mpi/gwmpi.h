@@ -0,0 +1,236 @@
+/* This file is part of the R-package 'GWcovar'
+ *
+ * Copyright (C) 2019 Josef Stocker <josef@josefstocker.ch>
+ *
+ * 'GWcovar' is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <https://www.gnu.org/licenses/>.
+ * */
+
+#ifndef GWMPI_H_
+#define GWMPI_H_
+
+/* ****************************************************************************
+ * Distributed assembly of GW covariance matrices with MPI, for problems with
+ * more locations than one node can hold. It is not part of the R package;
+ * it is built with the plain C library (see 'gwcovar.h') by
+ *
+ *      make gwmpi_test
+ *      mpirun -np 4 ./gwmpi_test
+ *
+ * Every rank passes an arbitrary part of the locations together with their
+ * global indices. The locations are redistributed into slabs along the
+ * coordinate with the largest extent, with about the same number of
+ * locations per rank, and each rank receives the locations of the other
+ * ranks that are closer than the range to its slab (the halo). It then
+ * calculates the rows of its own locations as sparse block row. The matrix
+ * is used through the distributed product 'gw_mpi_matvec(...)'.
+ * ***************************************************************************/
+
+
+/* ****************************************************************************
+ * ** Include directives  *****************************************************
+ * ***************************************************************************/
+
+#include "stddef.h" /* for type size_t */
+#include "stdint.h" /* for type uint64_t */
+#include "mpi.h"
+
+#include "gwcovar.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+
+/* ***************************************************************************
+ * ** Public data structures *************************************************
+ * **************************************************************************/
+
+typedef struct {
+/* ***************************************************************************
+ * Kernel that is the same on all ranks: the interpolation table is
+ * calculated once on rank 0 and broadcast, see 'gw_mpi_kernel_new(...)'.
+ * **************************************************************************/
+    Gw_kernel* kernel ;
+    /* kernel of this rank */
+
+    double* values ;
+    /* copy of the table of rank 0 ('NULL' on rank 0 and without table) */
+} Gw_mpi_kernel ;
+
+
+typedef struct {
+/* ***************************************************************************
+ * Block row of a distributed GW covariance matrix. The columns of the rows
+ * refer to the local locations: 0, ..., n_local-1 are the own locations and
+ * n_local, ..., n_local+n_halo-1 the halo. The columns of each row are
+ * sorted by global index.
+ * **************************************************************************/
+    MPI_Comm comm ;
+    int rank ;
+    int size ;
+
+    int dim ;
+    /* dimension of the coordinates */
+
+    int axis ;
+    /* coordinate along which the locations are split into slabs */
+
+    double* slabs ;
+    /* lower bounds of the slabs of all ranks (length size + 1, the first
+     * one is -Inf and the last one +Inf) */
+
+    size_t n_local ;
+    /* number of own locations */
+
+    uint64_t* global ;
+    /* global indices of the own locations */
+
+    double* coords ;
+    /* coordinates of the own locations followed by the halo (column major,
+     * (n_local + n_halo) x dim) */
+
+    size_t n_halo ;
+    /* number of halo locations */
+
+    uint64_t* halo_global ;
+    /* global indices of the halo locations */
+
+    size_t* rowpointers ;
+    size_t* colindices ;
+    double* entries ;
+    /* rows of the own locations (CSR, 0-based) */
+
+    int* send_counts ;
+    int* send_displs ;
+    size_t* send_index ;
+    int* recv_counts ;
+    int* recv_displs ;
+    /* exchange of the halo: the own locations 'send_index' are sent to the
+     * other ranks (counts and offsets per rank) and the halo is received
+     * ordered by rank */
+} Gw_mpi_matrix ;
+
+
+
+/* ***************************************************************************
+ * ***************************************************************************
+ * ** Public functions  ******************************************************
+ * ***************************************************************************
+ * **************************************************************************/
+
+int
+gw_mpi_kernel_new (
+/* ***************************************************************************
+ * The function 'int gw_mpi_kernel_new(...)' creates the kernel with the
+ * parameters 'params' on all ranks of 'comm' (collective). With an
+ * interpolation table ('n_interpol' > 0) the table is only calculated on
+ * rank 0 and broadcast. Returns the same code on all ranks, see
+ * 'gw_kernel_new(...)'.
+ * **************************************************************************/
+        Gw_mpi_kernel* kernel ,
+        MPI_Comm comm ,
+        const Gw_params* params ,
+        size_t n_interpol ,
+        int* gsl_error
+        ) ;
+
+
+void
+gw_mpi_kernel_free (
+/* ***************************************************************************
+ * Releases the memory held by 'kernel'.
+ * **************************************************************************/
+        Gw_mpi_kernel* kernel
+        ) ;
+
+
+int
+gw_mpi_assemble (
+/* ***************************************************************************
+ * The function 'int gw_mpi_assemble(...)' redistributes the locations and
+ * calculates the block row of this rank of the GW covariance matrix with
+ * 'kernel' (collective). The memory needed per rank grows with the number of
+ * own and halo locations and the number of their pairs within the range.
+ * Returns 'GW_OK' on all ranks or the same error code on all ranks
+ * ('GW_ENOMEM', 'GW_EINVAL', 'GW_EINTEG', 'GW_EBETA'); on error 'matrix' is
+ * freed.
+ *
+ *
+ *  ****************
+ *  ** Arguments: **
+ *  ****************
+ *
+ *  -> Gw_mpi_matrix* matrix:
+ *                      block row of this rank (released with
+ *                      'gw_mpi_free(...)')
+ *
+ *  -> MPI_Comm comm:   communicator of the ranks
+ *
+ *  -> const Gw_kernel* kernel:
+ *                      GW covariance function (the same on all ranks)
+ *
+ *  -> const double* coords:
+ *                      coordinates of the locations passed by this rank
+ *                      (column major, n x dim)
+ *
+ *  -> const uint64_t* global:
+ *                      their global indices (each index on one rank only)
+ *
+ *  -> size_t n:        number of locations passed by this rank (may be 0)
+ *
+ *  -> int dim:         dimension of the coordinates (the same on all ranks)
+ *
+ *  -> int* gsl_error:  GSL error code if an integration failed (may be
+ *                      'NULL')
+ *
+ * **************************************************************************/
+        Gw_mpi_matrix* matrix ,
+        MPI_Comm comm ,
+        const Gw_kernel* kernel ,
+        const double* coords ,
+        const uint64_t* global ,
+        size_t n ,
+        int dim ,
+        int* gsl_error
+        ) ;
+
+
+int
+gw_mpi_matvec (
+/* ***************************************************************************
+ * The function 'int gw_mpi_matvec(...)' calculates y = C x (collective). 'x'
+ * and 'y' hold the values of the own locations of this rank in the order of
+ * 'matrix->global'. The values of the halo are exchanged before the product.
+ * Returns 'GW_OK' or 'GW_ENOMEM' (on all ranks).
+ * **************************************************************************/
+        const Gw_mpi_matrix* matrix ,
+        const double* x ,
+        double* y
+        ) ;
+
+
+void
+gw_mpi_free (
+/* ***************************************************************************
+ * Releases the memory held by 'matrix'.
+ * **************************************************************************/
+        Gw_mpi_matrix* matrix
+        ) ;
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  /* #ifndef GWMPI_H_ */
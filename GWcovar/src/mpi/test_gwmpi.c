@@ -0,0 +1,237 @@
+/* This file is part of the R-package 'GWcovar'
+ *
+ * Copyright (C) 2019 Josef Stocker <josef@josefstocker.ch>
+ *
+ * 'GWcovar' is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <https://www.gnu.org/licenses/>.
+ * */
+
+
+/* ***************************************************************************
+ * Test of the distributed assembly: the rows and the product of every rank
+ * are compared with a serial calculation from all locations.
+ *
+ *      make gwmpi_test
+ *      mpirun -np 4 ./gwmpi_test
+ *
+ * Exits with status 1 (on all ranks) if a difference is too large.
+ * **************************************************************************/
+
+#include "stdio.h"
+#include "stdlib.h"
+#include "math.h"
+
+#include "gwmpi.h"
+
+static double
+uniform (
+
+        uint64_t* state
+        )
+/* uniform random number in [0,1), the same sequence on all ranks */
+{
+    *state = *state * 6364136223846793005ULL + 1442695040888963407ULL ;
+    return (double) ( *state >> 11 ) / 9007199254740992.0 ;
+}
+
+static int
+check (
+
+        const char* name ,
+        size_t n ,
+        int dim ,
+        const double* extent ,
+        int scatter ,
+        size_t n_interpol
+        )
+/* assembles the matrix of 'n' random locations in [0,extent] (with some
+ * duplicated locations), passed round-robin ('scatter') or all from rank
+ * 0, and compares it with the serial calculation. Returns the number of
+ * failures on all ranks. */
+{
+    int rank, size ;
+    MPI_Comm_rank( MPI_COMM_WORLD, &rank ) ;
+    MPI_Comm_size( MPI_COMM_WORLD, &size ) ;
+
+    /* all locations (column major) */
+    double* all = malloc( n * dim * sizeof(double) ) ;
+    uint64_t state = 42 ;
+    for ( size_t i = 0 ; i < n ; i++ ) {
+
+        for ( int d = 0 ; d < dim ; d++ ) {
+
+            all[i + d*n] = i % 50 == 1 ? all[i - 1 + d*n]
+                : extent[d] * uniform( &state ) ;
+        }
+    }
+
+    /* the part of this rank */
+    size_t n_own = 0 ;
+    double* coords = malloc( n * dim * sizeof(double) ) ;
+    uint64_t* global = malloc( n * sizeof(uint64_t) ) ;
+    for ( size_t i = 0 ; i < n ; i++ ) {
+
+        if ( scatter ? (int) ( i % size ) == rank : rank == 0 ) {
+
+            global[n_own++] = i ;
+        }
+    }
+    for ( size_t k = 0 ; k < n_own ; k++ ) {
+
+        for ( int d = 0 ; d < dim ; d++ ) {
+
+            coords[k + d*n_own] = all[global[k] + d*n] ;
+        }
+    }
+
+    Gw_params params = { 3.5, 1.5, 2.0, 0.15, 0.1, 1e-8, 1e-6, 1e-10 } ;
+    Gw_mpi_kernel kernel ;
+    Gw_mpi_matrix matrix ;
+    int gsl_error = 0 ;
+    int failures = 0 ;
+    if ( gw_mpi_kernel_new( &kernel, MPI_COMM_WORLD, &params, n_interpol,
+                &gsl_error ) != GW_OK
+            || gw_mpi_assemble( &matrix, MPI_COMM_WORLD, kernel.kernel,
+                coords, global, n_own, dim, &gsl_error ) != GW_OK ) {
+
+        failures = 1 ;
+    }
+
+    /* rows of the own locations */
+    double* dist = malloc( n * sizeof(double) ) ;
+    double* row = malloc( n * sizeof(double) ) ;
+    double* x = malloc( ( n > 0 ? n : 1 ) * sizeof(double) ) ;
+    double* y = malloc( ( n > 0 ? n : 1 ) * sizeof(double) ) ;
+    double worst = 0 ;
+    size_t nnz = 0 ;
+    for ( size_t i = 0 ; i < matrix.n_local && !failures ; i++ ) {
+
+        uint64_t g = matrix.global[i] ;
+        size_t expected = 0 ;
+        for ( size_t j = 0 ; j < n ; j++ ) {
+
+            double sum = 0 ;
+            for ( int d = 0 ; d < dim ; d++ ) {
+
+                double diff = all[g + d*n] - all[j + d*n] ;
+                sum += diff * diff ;
+            }
+            dist[j] = sqrt( sum ) ;
+            expected += dist[j] < params.rnge ;
+        }
+        gw_eval( kernel.kernel, dist, row, n, NULL, &gsl_error ) ;
+
+        size_t start = matrix.rowpointers[i] ;
+        size_t end = matrix.rowpointers[i+1] ;
+        failures += end - start != expected ;
+        for ( size_t k = start ; k < end ; k++ ) {
+
+            size_t c = matrix.colindices[k] ;
+            uint64_t j = c < matrix.n_local ? matrix.global[c]
+                : matrix.halo_global[c - matrix.n_local] ;
+            worst = fmax( worst, fabs( matrix.entries[k] - row[j] ) ) ;
+            failures += k > start
+                && j <= ( matrix.colindices[k-1] < matrix.n_local
+                    ? matrix.global[matrix.colindices[k-1]]
+                    : matrix.halo_global[matrix.colindices[k-1]
+                        - matrix.n_local] ) ;
+        }
+        nnz += end - start ;
+    }
+
+    /* product with x_j = sin(j) */
+    MPI_Allreduce( MPI_IN_PLACE, &failures, 1, MPI_INT, MPI_SUM,
+            MPI_COMM_WORLD ) ;
+    double worst_mv = 0 ;
+    if ( failures == 0 ) {
+
+        for ( size_t i = 0 ; i < matrix.n_local ; i++ ) {
+
+            x[i] = sin( (double) matrix.global[i] ) ;
+        }
+        if ( gw_mpi_matvec( &matrix, x, y ) != GW_OK ) {
+
+            failures = 1 ;
+        }
+        for ( size_t i = 0 ; i < matrix.n_local && !failures ; i++ ) {
+
+            uint64_t g = matrix.global[i] ;
+            for ( size_t j = 0 ; j < n ; j++ ) {
+
+                double sum = 0 ;
+                for ( int d = 0 ; d < dim ; d++ ) {
+
+                    double diff = all[g + d*n] - all[j + d*n] ;
+                    sum += diff * diff ;
+                }
+                dist[j] = sqrt( sum ) ;
+            }
+            gw_eval( kernel.kernel, dist, row, n, NULL, &gsl_error ) ;
+            double ref = 0 ;
+            for ( size_t j = 0 ; j < n ; j++ ) {
+
+                ref += row[j] * sin( (double) j ) ;
+            }
+            worst_mv = fmax( worst_mv, fabs( y[i] - ref ) ) ;
+        }
+    }
+
+    unsigned long local[2] = { matrix.n_local, nnz } ;
+    unsigned long total[2] ;
+    MPI_Allreduce( local, total, 2, MPI_UNSIGNED_LONG, MPI_SUM,
+            MPI_COMM_WORLD ) ;
+    MPI_Allreduce( MPI_IN_PLACE, &worst, 1, MPI_DOUBLE, MPI_MAX,
+            MPI_COMM_WORLD ) ;
+    MPI_Allreduce( MPI_IN_PLACE, &worst_mv, 1, MPI_DOUBLE, MPI_MAX,
+            MPI_COMM_WORLD ) ;
+    failures += total[0] != n || worst > 1e-12 || worst_mv > 1e-10 ;
+    MPI_Allreduce( MPI_IN_PLACE, &failures, 1, MPI_INT, MPI_MAX,
+            MPI_COMM_WORLD ) ;
+    if ( rank == 0 ) {
+
+        printf( "[%s] %d ranks, %lu locations, %lu entries, max. difference "
+                "%.2e (rows) %.2e (product): %s\n", name, size, total[0],
+                total[1], worst, worst_mv, failures ? "FAILED" : "ok" ) ;
+    }
+
+    gw_mpi_free( &matrix ) ;
+    gw_mpi_kernel_free( &kernel ) ;
+    free( all ) ;
+    free( coords ) ;
+    free( global ) ;
+    free( dist ) ;
+    free( row ) ;
+    free( x ) ;
+    free( y ) ;
+    return failures ;
+}
+
+int
+main (
+
+        int argc ,
+        char** argv
+        )
+{
+    MPI_Init( &argc, &argv ) ;
+
+    const double flat[2] = { 1.0, 3.0 } ;
+    const double cube[3] = { 2.0, 1.0, 1.0 } ;
+    int failures = 0 ;
+    failures += check( "2d scattered", 1000, 2, flat, 1, 0 ) ;
+    failures += check( "3d from rank 0", 800, 3, cube, 0, 400 ) ;
+    failures += check( "few locations", 3, 2, flat, 1, 0 ) ;
+
+    MPI_Finalize() ;
+    return failures > 0 ;
+}
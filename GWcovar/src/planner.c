@@ -0,0 +1,486 @@
+/* This file is part of the R-package 'GWcovar'
+ *
+ * Copyright (C) 2019 Josef Stocker <josef@josefstocker.ch>
+ *
+ * 'GWcovar' is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <https://www.gnu.org/licenses/>.
+ * */
+
+
+/* ***************************************************************************
+ * ** Include directives  ****************************************************
+ * **************************************************************************/
+
+#include "planner.h"
+
+#include "stdio.h"
+#include "stdlib.h"
+#include "math.h"
+#include "gsl/gsl_errno.h"
+
+#include "table.h"
+#include "gwcovar.h"
+#include "scratch.h"
+
+/* ***************************************************************************
+ * ** Private data structures ************************************************
+ * **************************************************************************/
+
+#define PLAN_MIN_ENTRIES 64
+/* below this number of distances every distance is integrated */
+
+#define PLAN_TABLE_START 33
+/* size of the first table; refining doubles the number of intervals */
+
+#define PLAN_TABLE_MAX 16385
+/* largest table that is tried */
+
+#define PLAN_TABLE_CHECKS 32
+/* number of intervals in which the accuracy of a table is checked */
+
+#define PLAN_DEDUP_MAX ( (size_t) 1 << 24 )
+/* largest number of distances that are sorted to find the unique ones */
+
+#define PLAN_COST_SORT 0.002
+/* cost of sorting one distance per comparison level (log2), relative to
+ * one numerical integration */
+
+typedef struct {
+    /* distance together with its position in the input */
+    double dist ;
+    size_t index ;
+} Dist_pair ;
+
+
+
+/* ***************************************************************************
+ * ** Functions **************************************************************
+ * **************************************************************************/
+
+
+/* ***********************
+ * ** private functions **
+ * **********************/
+
+static int
+compare_dist (
+
+        const void* a ,
+        const void* b
+        )
+/* comparison function for 'qsort' */
+{
+    double da = ((const Dist_pair*) a)->dist ;
+    double db = ((const Dist_pair*) b)->dist ;
+    return ( da > db ) - ( da < db ) ;
+}
+
+static int
+kernel_value (
+
+        const Gw_params* params ,
+        double r ,
+        Covar_stats* stats ,
+        int* gsl_error ,
+        double* value
+        )
+/* GW correlation function in the normalised distance 'r' by numerical
+ * integration. Returns 'GW_OK' on success; on error the GSL error code is
+ * written to 'gsl_error' and 'GW_EINTEG' or 'GW_EBETA' is returned. */
+{
+    Wendland_result result ;
+    wendland( &result, r, params->mu, params->smoothness, params->abstol,
+            params->reltol ) ;
+    if ( stats != NULL && stats->enabled ) {
+
+        stats_record( stats, &result ) ;
+    }
+    *gsl_error = wendland_error( &result ) ;
+    if ( *gsl_error != 0 ) {
+
+        return result.error != 0 ? GW_EINTEG : GW_EBETA ;
+    }
+    *value = result.result ;
+    return GW_OK ;
+}
+
+static int
+cached_table (
+
+        Gw_table* table ,
+        const Plan_cache* cache ,
+        const Gw_params* params ,
+        Covar_stats* stats ,
+        size_t* used ,
+        double* table_error
+        )
+/* looks for tables of the sizes built by 'plan_fill(...)' in 'cache' and
+ * wraps the first one that reaches the tolerance in 'table' ('table->points'
+ * stays 'NULL' if there is none). The checks are added to 'used'. Returns
+ * 'TABLE_OK' or an error code of 'table.h'; after a failed check the table
+ * is not freed, so that its GSL error code can be read. */
+{
+    for ( size_t n = PLAN_TABLE_START ; n <= PLAN_TABLE_MAX ; n = 2 * n - 1 ) {
+
+        const double* values = cache->lookup( cache->ctx, params, n ) ;
+        if ( values == NULL ) {
+
+            continue ;
+        }
+        int error = gw_table_wrap( table, n, values ) ;
+        if ( error != TABLE_OK ) {
+
+            return error ;
+        }
+        *table_error = gw_table_check( table, params->mu, params->smoothness,
+                params->abstol, params->reltol, PLAN_TABLE_CHECKS, stats,
+                &error ) ;
+        *used += PLAN_TABLE_CHECKS ;
+        if ( error != TABLE_OK || *table_error <= 1 ) {
+
+            return error ;
+        }
+        gw_table_free( table ) ;
+    }
+    return TABLE_OK ;
+}
+
+static double
+lap (
+
+        Covar_stats* stats ,
+        Stats_phase phase ,
+        double t0
+        )
+/* attributes the time since 't0' to 'phase' and returns the current time */
+{
+    if ( stats == NULL || !stats->enabled ) {
+
+        return 0 ;
+    }
+    double t1 = stats_clock() ;
+    stats->time[phase] += t1 - t0 ;
+    return t1 ;
+}
+
+static void
+fill_outside (
+
+        const double* dist ,
+        double* out ,
+        size_t length ,
+        const Gw_params* params
+        )
+/* writes the values of all distances outside of [eps, range); the others
+ * are not touched */
+{
+    for ( size_t i = 0 ; i < length ; i++ ) {
+
+        if ( dist[i] < params->eps ) {
+
+            out[i] = params->sill + params->nugget ;
+        } else if ( dist[i] >= params->rnge ) {
+
+            out[i] = 0 ;
+        }
+    }
+}
+
+
+
+/* **********************
+ * ** public functions **
+ * *********************/
+
+const char*
+plan_strategy_name (
+
+        Plan_strategy strategy
+        )
+{
+    switch ( strategy ) {
+
+        case PLAN_CLOSED_FORM: return "closed form" ;
+        case PLAN_TABLE: return "table" ;
+        case PLAN_DEDUP: return "dedup" ;
+        default: return "direct" ;
+    }
+}
+
+int
+plan_fill (
+
+        Plan* plan ,
+        const double* dist ,
+        double* out ,
+        size_t length ,
+        const Gw_params* params ,
+        const Plan_cache* cache ,
+        Covar_stats* stats
+        )
+{
+    double t0 = ( stats != NULL && stats->enabled ) ? stats_clock() : 0 ;
+    Wendland_result result ;
+
+    plan->entries = 0 ;
+    plan->unique = 0 ;
+    plan->n_interpol = 0 ;
+    plan->table_error = 0 ;
+    plan->gsl_error = 0 ;
+    for ( size_t i = 0 ; i < length ; i++ ) {
+
+        plan->entries += dist[i] >= params->eps && dist[i] < params->rnge ;
+    }
+    gsl_set_error_handler_off() ;
+
+    /* 1. closed form */
+    if ( wendland_closed_form( &result, 0, params->mu, params->smoothness ) ) {
+
+        plan->strategy = PLAN_CLOSED_FORM ;
+        snprintf( plan->reason, sizeof(plan->reason),
+                "kappa = %g has a closed form", params->smoothness ) ;
+
+        for ( size_t i = 0 ; i < length ; i++ ) {
+
+            if ( dist[i] < params->eps ) {
+
+                out[i] = params->sill + params->nugget ;
+            } else if ( dist[i] < params->rnge ) {
+
+                wendland_closed_form( &result, dist[i] / params->rnge,
+                        params->mu, params->smoothness ) ;
+                out[i] = params->sill * result.result ;
+            } else {
+
+                out[i] = 0 ;
+            }
+        }
+        lap( stats, STATS_KERNEL, t0 ) ;
+        return GW_OK ;
+    }
+
+    /* 2. few distances: integrate each of them */
+    if ( plan->entries <= PLAN_MIN_ENTRIES ) {
+
+        plan->strategy = PLAN_DIRECT ;
+        snprintf( plan->reason, sizeof(plan->reason),
+                "only %zu distances within the range", plan->entries ) ;
+    } else {
+
+        /* count the unique distances, unless there are too many to sort */
+        Dist_pair* pairs = NULL ;
+        double sort_cost = PLAN_COST_SORT * (double) plan->entries
+            * log2( (double) plan->entries ) ;
+        if ( plan->entries <= PLAN_DEDUP_MAX ) {
+
+            pairs = scratch_alloc( plan->entries * sizeof(Dist_pair) ) ;
+        }
+        if ( pairs != NULL ) {
+
+            for ( size_t i = 0, k = 0 ; i < length ; i++ ) {
+
+                if ( dist[i] >= params->eps && dist[i] < params->rnge ) {
+
+                    pairs[k].dist = dist[i] ;
+                    pairs[k].index = i ;
+                    k++ ;
+                }
+            }
+            qsort( pairs, plan->entries, sizeof(Dist_pair), compare_dist ) ;
+            plan->unique = 1 ;
+            for ( size_t k = 1 ; k < plan->entries ; k++ ) {
+
+                plan->unique += pairs[k].dist != pairs[k-1].dist ;
+            }
+        }
+
+        /* 3. table from the cache or built and refined until it is
+         * accurate enough or more expensive than integrating each (unique)
+         * distance */
+        size_t budget = plan->entries / 2 ;
+        size_t used = 0 ;
+        int error = TABLE_OK ;
+        int cached = 0 ;
+        Gw_table table = { 0, NULL, NULL, NULL, 0, 0 } ;
+
+        if ( pairs != NULL && plan->unique < budget ) {
+
+            budget = plan->unique ;
+        }
+        if ( cache != NULL && PLAN_TABLE_CHECKS <= budget ) {
+
+            error = cached_table( &table, cache, params, stats, &used,
+                    &plan->table_error ) ;
+            cached = error == TABLE_OK && table.points != NULL ;
+            if ( stats != NULL && stats->enabled ) {
+
+                stats->cache_hits += cached ;
+                stats->cache_misses += !cached ;
+            }
+        }
+        if ( error == TABLE_OK && !cached
+                && used + PLAN_TABLE_START + PLAN_TABLE_CHECKS <= budget ) {
+
+            error = gw_table_build( &table, PLAN_TABLE_START, params->mu,
+                    params->smoothness, params->abstol, params->reltol,
+                    stats ) ;
+            used += PLAN_TABLE_START ;
+            while ( error == TABLE_OK ) {
+
+                plan->table_error = gw_table_check( &table, params->mu,
+                        params->smoothness, params->abstol, params->reltol,
+                        PLAN_TABLE_CHECKS, stats, &error ) ;
+                used += PLAN_TABLE_CHECKS ;
+
+                if ( error != TABLE_OK || plan->table_error <= 1 ) {
+
+                    break ;
+                }
+                if ( table.n >= PLAN_TABLE_MAX
+                        || used + table.n + PLAN_TABLE_CHECKS > budget ) {
+                    /* refining would be too expensive */
+
+                    gw_table_free( &table ) ;
+                    break ;
+                }
+                error = gw_table_refine( &table, params->mu,
+                        params->smoothness, params->abstol, params->reltol,
+                        stats ) ;
+                used += table.n / 2 ;
+            }
+            if ( error == TABLE_OK && table.points != NULL && cache != NULL
+                    && cache->add != NULL ) {
+
+                cache->add( cache->ctx, params, table.n, table.values ) ;
+            }
+        }
+        if ( error != TABLE_OK ) {
+            /* the codes of 'table.h' agree with the ones of 'gwcovar.h' */
+
+            plan->gsl_error = table.gsl_error ;
+            gw_table_free( &table ) ;
+            scratch_free( pairs ) ;
+            return error ;
+        }
+        if ( used > 0 ) {
+
+            t0 = lap( stats, STATS_TABLE, t0 ) ;
+        }
+
+        if ( table.points != NULL ) {
+
+            plan->strategy = PLAN_TABLE ;
+            plan->n_interpol = table.n ;
+            snprintf( plan->reason, sizeof(plan->reason),
+                    "%s of %zu points reaches the tolerance "
+                    "(max. error %.2g of the tolerance) with %zu "
+                    "integrations for %zu distances",
+                    cached ? "cached table" : "table", table.n,
+                    plan->table_error, used, plan->entries ) ;
+
+            for ( size_t i = 0 ; i < length ; i++ ) {
+
+                if ( dist[i] < params->eps ) {
+
+                    out[i] = params->sill + params->nugget ;
+                } else if ( dist[i] < params->rnge ) {
+
+                    out[i] = params->sill * gw_table_eval( &table,
+                            dist[i] / params->rnge, NULL ) ;
+                } else {
+
+                    out[i] = 0 ;
+                }
+            }
+            gw_table_free( &table ) ;
+            scratch_free( pairs ) ;
+            lap( stats, STATS_OUTPUT, t0 ) ;
+            return GW_OK ;
+        }
+
+        /* 4. one integration per unique distance */
+        if ( pairs != NULL
+                && (double) plan->unique + sort_cost < (double) plan->entries ) {
+
+            plan->strategy = PLAN_DEDUP ;
+            snprintf( plan->reason, sizeof(plan->reason),
+                    "no table reaches the tolerance with fewer integrations "
+                    "than the %zu unique among %zu distances",
+                    plan->unique, plan->entries ) ;
+
+            /* the distances within the range are in 'pairs' now, so the
+             * others can be written first even if 'out' is 'dist' */
+            fill_outside( dist, out, length, params ) ;
+            size_t k = 0 ;
+            while ( k < plan->entries ) {
+
+                double value ;
+                int ret = kernel_value( params, pairs[k].dist / params->rnge,
+                        stats, &plan->gsl_error, &value ) ;
+                if ( ret != GW_OK ) {
+
+                    scratch_free( pairs ) ;
+                    return ret ;
+                }
+                double d = pairs[k].dist ;
+                for ( ; k < plan->entries && pairs[k].dist == d ; k++ ) {
+
+                    out[pairs[k].index] = params->sill * value ;
+                }
+            }
+            scratch_free( pairs ) ;
+            lap( stats, STATS_KERNEL, t0 ) ;
+            return GW_OK ;
+        }
+        scratch_free( pairs ) ;
+
+        plan->strategy = PLAN_DIRECT ;
+        if ( plan->unique > 0 ) {
+
+            snprintf( plan->reason, sizeof(plan->reason),
+                    "no table reaches the tolerance within %zu integrations "
+                    "and %zu of %zu distances are unique",
+                    budget, plan->unique, plan->entries ) ;
+        } else {
+
+            snprintf( plan->reason, sizeof(plan->reason),
+                    "no table reaches the tolerance within %zu integrations "
+                    "and %zu distances are too many to sort",
+                    budget, plan->entries ) ;
+        }
+    }
+
+    /* direct integration of every distance */
+    for ( size_t i = 0 ; i < length ; i++ ) {
+
+        if ( dist[i] < params->eps ) {
+
+            out[i] = params->sill + params->nugget ;
+        } else if ( dist[i] < params->rnge ) {
+
+            double value ;
+            int ret = kernel_value( params, dist[i] / params->rnge, stats,
+                    &plan->gsl_error, &value ) ;
+            if ( ret != GW_OK ) {
+
+                return ret ;
+            }
+            out[i] = params->sill * value ;
+        } else {
+
+            out[i] = 0 ;
+        }
+    }
+    lap( stats, STATS_KERNEL, t0 ) ;
+    return GW_OK ;
+}
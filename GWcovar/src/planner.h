@@ -0,0 +1,159 @@
+/* This file is part of the R-package 'GWcovar'
+ *
+ * Copyright (C) 2019 Josef Stocker <josef@josefstocker.ch>
+ *
+ * 'GWcovar' is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <https://www.gnu.org/licenses/>.
+ * */
+
+#ifndef PLANNER_H_
+#define PLANNER_H_
+
+
+/* ****************************************************************************
+ * ** Include directives  *****************************************************
+ * ***************************************************************************/
+
+#include "stddef.h" /* for type size_t */
+
+#include "wendland.h"
+#include "stats.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+
+/* ***************************************************************************
+ * ** Public data structures *************************************************
+ * **************************************************************************/
+
+typedef enum {
+/* ***************************************************************************
+ * Strategies to evaluate the GW covariance function for many distances.
+ * **************************************************************************/
+    PLAN_CLOSED_FORM = 0,
+    /* closed form of the GW function (smoothness 0, 1, 2 or 3) */
+
+    PLAN_TABLE = 1,
+    /* cubic spline through a table whose accuracy has been checked */
+
+    PLAN_DEDUP = 2,
+    /* one numerical integration per unique distance */
+
+    PLAN_DIRECT = 3
+    /* one numerical integration per distance */
+} Plan_strategy ;
+
+
+typedef struct {
+/* ***************************************************************************
+ * The strategy chosen by 'plan_fill(...)' and the figures it was based on.
+ * **************************************************************************/
+    Plan_strategy strategy ;
+
+    size_t entries ;
+    /* number of distances in [eps, range) that need the GW function */
+
+    size_t unique ;
+    /* number of unique distances among them ('0' if they were not counted) */
+
+    size_t n_interpol ;
+    /* size of the table ('0' if no table was built) */
+
+    double table_error ;
+    /* largest interpolation error of the table relative to the tolerance */
+
+    char reason[256] ;
+    /* human readable explanation of the choice */
+
+    int gsl_error ;
+    /* GSL error code if an integration failed */
+} Plan ;
+
+
+typedef struct {
+/* ***************************************************************************
+ * Tables kept between calls of 'plan_fill(...)', e.g. in the table store
+ * (see 'store.h'). 'lookup' returns the 'n' values of the table with the
+ * parameters 'params' or 'NULL'; the values have to stay valid until the
+ * next call of 'lookup' or 'add'. 'add' is called with every table that has
+ * been built and reaches the tolerance and may be 'NULL'. 'ctx' is passed
+ * to both.
+ * **************************************************************************/
+    const double* (*lookup)( void* ctx, const Gw_params* params, size_t n ) ;
+
+    void (*add)( void* ctx, const Gw_params* params, size_t n,
+            const double* values ) ;
+
+    void* ctx ;
+} Plan_cache ;
+
+
+
+/* ***************************************************************************
+ * ***************************************************************************
+ * ** Public functions  ******************************************************
+ * ***************************************************************************
+ * **************************************************************************/
+
+int
+plan_fill (
+/* ***************************************************************************
+ * The function 'int plan_fill(...)' calculates the GW covariance function
+ * for the 'length' distances in 'dist' and writes the values to 'out' (which
+ * may be 'dist' itself). The evaluation strategy is chosen as follows:
+ *
+ *  1.  If there is a closed form for the smoothness parameter, it is used.
+ *  2.  If only few distances are within the range, each one is integrated.
+ *  3.  Otherwise a table is used: if 'cache' is not 'NULL' and contains a
+ *      table of one of the sizes tried below whose interpolation error at
+ *      check points is below the tolerance of the numerical integration,
+ *      that table; else a table is built and refined until it reaches the
+ *      tolerance, as long as the table needs less than half as many
+ *      integrations as the distances (and added to 'cache').
+ *  4.  If no table is accurate enough within this budget, the distances are
+ *      sorted and each unique distance is integrated once, if that is
+ *      cheaper than integrating each distance.
+ *
+ * The choice and the reason are written to 'plan'. The integrations and
+ * the tables found in 'cache' are recorded in 'stats' if it is not 'NULL'
+ * and enabled. Returns 'GW_OK' (0) on
+ * success and 'GW_EINTEG', 'GW_EBETA' (with the GSL error code in
+ * 'plan->gsl_error') or 'GW_ENOMEM' on error (see 'gwcovar.h').
+ * **************************************************************************/
+        Plan* plan ,
+        const double* dist ,
+        double* out ,
+        size_t length ,
+        const Gw_params* params ,
+        const Plan_cache* cache ,
+        Covar_stats* stats
+        ) ;
+
+
+const char*
+plan_strategy_name (
+/* ***************************************************************************
+ * Returns a short name of 'strategy' ("closed form", "table", "dedup" or
+ * "direct").
+ * **************************************************************************/
+        Plan_strategy strategy
+        ) ;
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  /* #ifndef PLANNER_H_ */
@@ -0,0 +1,278 @@
+/* This file is part of the R-package 'GWcovar'
+ *
+ * Copyright (C) 2019 Josef Stocker <josef@josefstocker.ch>
+ *
+ * 'GWcovar' is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <https://www.gnu.org/licenses/>.
+ * */
+
+
+/* ***************************************************************************
+ * ** Include directives  ****************************************************
+ * **************************************************************************/
+
+#include "scratch.h"
+
+#include "stdlib.h"
+#include "pthread.h"
+
+/* ***************************************************************************
+ * ** Private data structures ************************************************
+ * **************************************************************************/
+
+#define SCRATCH_MIN_SHIFT 6
+/* the smallest size class holds 2^6 = 64 bytes */
+
+#define SCRATCH_LARGE_SLACK 8
+/* a kept large buffer is handed out for requests that are at most 1/8
+ * smaller than it */
+
+typedef union Scratch_header {
+    /* header in front of each buffer; the union keeps the buffer aligned
+     * like memory from 'malloc' */
+    struct {
+        union Scratch_header* next ;    /* next buffer in the free list */
+        size_t size ;                   /* usable size in bytes */
+        int cls ;                       /* size class or -1 (large) */
+    } h ;
+    long double align_ld ;
+    void* align_p ;
+    char pad[32] ;
+} Scratch_header ;
+
+static Scratch* scratch_pool = NULL ;
+
+static pthread_mutex_t scratch_lock = PTHREAD_MUTEX_INITIALIZER ;
+/* protects the pool; a mutex rather than an OpenMP critical section, since
+ * buffers are also taken on threads that OpenMP does not know (see
+ * 'async.h') */
+
+
+
+/* ***************************************************************************
+ * ** Functions **************************************************************
+ * **************************************************************************/
+
+
+/* ***********************
+ * ** private functions **
+ * **********************/
+
+static int
+size_class (
+
+        size_t bytes
+        )
+/* smallest size class that holds 'bytes' or -1 if the buffer is too large */
+{
+    int cls = 0 ;
+    while ( cls < SCRATCH_CLASSES
+            && ( (size_t) 1 << ( cls + SCRATCH_MIN_SHIFT ) ) < bytes ) {
+
+        cls++ ;
+    }
+    return cls < SCRATCH_CLASSES ? cls : -1 ;
+}
+
+static Scratch_header*
+take_large (
+
+        Scratch* pool ,
+        size_t bytes
+        )
+/* removes the smallest kept large buffer that holds 'bytes' with little
+ * waste from the free list and returns it, or 'NULL'; the caller holds the
+ * lock */
+{
+    Scratch_header* best = NULL ;
+    Scratch_header* best_prev = NULL ;
+    Scratch_header* prev = NULL ;
+    for ( Scratch_header* header = pool->large ; header != NULL ;
+            header = header->h.next ) {
+
+        size_t size = header->h.size ;
+        if ( size >= bytes && size - bytes <= bytes / SCRATCH_LARGE_SLACK
+                && ( best == NULL || size < best->h.size ) ) {
+
+            best = header ;
+            best_prev = prev ;
+        }
+        prev = header ;
+    }
+    if ( best == NULL ) {
+
+        return NULL ;
+    }
+    if ( best_prev == NULL ) {
+
+        pool->large = best->h.next ;
+    } else {
+
+        best_prev->h.next = best->h.next ;
+    }
+    return best ;
+}
+
+
+
+/* **********************
+ * ** public functions **
+ * *********************/
+
+void
+scratch_use (
+
+        Scratch* pool
+        )
+{
+    scratch_pool = pool ;
+}
+
+void*
+scratch_alloc (
+
+        size_t bytes
+        )
+{
+    int cls = size_class( bytes ) ;
+    size_t size = cls >= 0 ? (size_t) 1 << ( cls + SCRATCH_MIN_SHIFT ) : bytes ;
+    Scratch_header* header = NULL ;
+    Scratch* pool = scratch_pool ;
+
+    if ( pool != NULL ) {
+
+        pthread_mutex_lock( &scratch_lock ) ;
+        if ( cls < 0 ) {
+
+            header = take_large( pool, bytes ) ;
+        } else if ( pool->free[cls] != NULL ) {
+
+            header = pool->free[cls] ;
+            pool->free[cls] = header->h.next ;
+        }
+        if ( header != NULL ) {
+
+            size = header->h.size ;
+            pool->cached -= size ;
+            pool->reuses++ ;
+            pool->in_use += size ;
+            if ( pool->in_use > pool->high_water ) {
+
+                pool->high_water = pool->in_use ;
+            }
+        }
+        pthread_mutex_unlock( &scratch_lock ) ;
+    }
+    if ( header == NULL ) {
+        /* counted only once the allocation has succeeded */
+
+        header = malloc( sizeof(Scratch_header) + size ) ;
+        if ( header == NULL ) {
+
+            return NULL ;
+        }
+        header->h.size = size ;
+        header->h.cls = cls ;
+        if ( pool != NULL ) {
+
+            pthread_mutex_lock( &scratch_lock ) ;
+            pool->allocations++ ;
+            pool->in_use += size ;
+            if ( pool->in_use > pool->high_water ) {
+
+                pool->high_water = pool->in_use ;
+            }
+            pthread_mutex_unlock( &scratch_lock ) ;
+        }
+    }
+    header->h.next = NULL ;
+    return header + 1 ;
+}
+
+void
+scratch_free (
+
+        void* ptr
+        )
+{
+    if ( ptr == NULL ) {
+
+        return ;
+    }
+    Scratch_header* header = (Scratch_header*) ptr - 1 ;
+    Scratch* pool = scratch_pool ;
+    int kept = 0 ;
+
+    if ( pool != NULL ) {
+
+        pthread_mutex_lock( &scratch_lock ) ;
+        pool->in_use -= header->h.size ;
+        if ( pool->cached + header->h.size <= SCRATCH_CACHE_MAX ) {
+
+            void** head = header->h.cls >= 0 ? &pool->free[header->h.cls]
+                : &pool->large ;
+            header->h.next = *head ;
+            *head = header ;
+            pool->cached += header->h.size ;
+            kept = 1 ;
+        }
+        pthread_mutex_unlock( &scratch_lock ) ;
+    }
+    if ( !kept ) {
+
+        free( header ) ;
+    }
+}
+
+void
+scratch_release (
+
+        Scratch* pool
+        )
+{
+    pthread_mutex_lock( &scratch_lock ) ;
+    for ( int cls = 0 ; cls < SCRATCH_CLASSES ; cls++ ) {
+
+        Scratch_header* header = pool->free[cls] ;
+        while ( header != NULL ) {
+
+            Scratch_header* next = header->h.next ;
+            free( header ) ;
+            header = next ;
+        }
+        pool->free[cls] = NULL ;
+    }
+    Scratch_header* header = pool->large ;
+    while ( header != NULL ) {
+
+        Scratch_header* next = header->h.next ;
+        free( header ) ;
+        header = next ;
+    }
+    pool->large = NULL ;
+    pool->cached = 0 ;
+    pthread_mutex_unlock( &scratch_lock ) ;
+}
+
+void
+scratch_reset_peak (
+
+        Scratch* pool
+        )
+{
+    pthread_mutex_lock( &scratch_lock ) ;
+    pool->high_water = pool->in_use ;
+    pool->allocations = 0 ;
+    pool->reuses = 0 ;
+    pthread_mutex_unlock( &scratch_lock ) ;
+}
@@ -0,0 +1,141 @@
+/* This file is part of the R-package 'GWcovar'
+ *
+ * Copyright (C) 2019 Josef Stocker <josef@josefstocker.ch>
+ *
+ * 'GWcovar' is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <https://www.gnu.org/licenses/>.
+ * */
+
+#ifndef SCRATCH_H_
+#define SCRATCH_H_
+
+
+/* ****************************************************************************
+ * ** Include directives  *****************************************************
+ * ***************************************************************************/
+
+#include "stddef.h" /* for type size_t */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+
+/* ***************************************************************************
+ * ** Public data structures *************************************************
+ * **************************************************************************/
+
+#define SCRATCH_CLASSES 15
+/* number of size classes: powers of two from 64 bytes to 1 MiB; larger
+ * buffers are allocated with their exact size, so that rounding up does not
+ * nearly double the memory of large tables and workspaces */
+
+#define SCRATCH_CACHE_MAX ( (size_t) 256 << 20 )
+/* at most this many bytes are kept in the free lists */
+
+typedef struct {
+/* ***************************************************************************
+ * Pool for the scratch buffers of the library (interpolation tables, kernels
+ * and workspaces). Released buffers are kept in one free list per size
+ * class (and the larger ones in a list of their own) and handed out again, so that repeated calls with the same sizes
+ * (e.g. in a likelihood optimisation) do not allocate any memory. The pool
+ * that is used is set with 'scratch_use(...)'; without a pool the buffers are
+ * allocated and freed as usual.
+ * **************************************************************************/
+    void* free[SCRATCH_CLASSES] ;
+    /* heads of the free lists */
+
+    void* large ;
+    /* head of the free list of the buffers larger than the size classes */
+
+    size_t in_use ;
+    /* bytes currently handed out */
+
+    size_t high_water ;
+    /* largest value of 'in_use' since the last 'scratch_reset_peak(...)' */
+
+    size_t cached ;
+    /* bytes kept in the free lists */
+
+    size_t allocations ;
+    /* number of buffers that had to be allocated from the system */
+
+    size_t reuses ;
+    /* number of buffers that were taken from the free lists */
+} Scratch ;
+
+
+
+/* ***************************************************************************
+ * ***************************************************************************
+ * ** Public functions  ******************************************************
+ * ***************************************************************************
+ * **************************************************************************/
+
+void
+scratch_use (
+/* ***************************************************************************
+ * Makes 'pool' the pool of 'scratch_alloc(...)' and 'scratch_free(...)'
+ * ('NULL' for none). The pool has to be zero-initialised and must not be
+ * changed while buffers are handed out.
+ * **************************************************************************/
+        Scratch* pool
+        ) ;
+
+
+void*
+scratch_alloc (
+/* ***************************************************************************
+ * Returns a buffer of at least 'bytes' bytes from the current pool or 'NULL'
+ * if no memory is available. The buffer has to be released with
+ * 'scratch_free(...)'. Thread-safe.
+ * **************************************************************************/
+        size_t bytes
+        ) ;
+
+
+void
+scratch_free (
+/* ***************************************************************************
+ * Returns a buffer from 'scratch_alloc(...)' to the pool ('NULL' is
+ * ignored). Thread-safe.
+ * **************************************************************************/
+        void* ptr
+        ) ;
+
+
+void
+scratch_release (
+/* ***************************************************************************
+ * Frees the buffers kept in the free lists of 'pool'; the buffers that are
+ * handed out are not affected.
+ * **************************************************************************/
+        Scratch* pool
+        ) ;
+
+
+void
+scratch_reset_peak (
+/* ***************************************************************************
+ * Sets the high-water mark of 'pool' to the bytes currently handed out and
+ * the counters 'allocations' and 'reuses' to zero.
+ * **************************************************************************/
+        Scratch* pool
+        ) ;
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  /* #ifndef SCRATCH_H_ */
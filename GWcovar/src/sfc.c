@@ -0,0 +1,215 @@
+/* This file is part of the R-package 'GWcovar'
+ *
+ * Copyright (C) 2019 Josef Stocker <josef@josefstocker.ch>
+ *
+ * 'GWcovar' is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <https://www.gnu.org/licenses/>.
+ * */
+
+
+/* ***************************************************************************
+ * ** Include directives  ****************************************************
+ * **************************************************************************/
+
+#include "sfc.h"
+
+#include "stdlib.h"
+#include "stdint.h"
+#include "math.h"
+
+#include "gwcovar.h"
+
+/* ***************************************************************************
+ * ** Private data structures ************************************************
+ * **************************************************************************/
+
+typedef struct {
+    /* position of a location on the curve */
+    uint64_t key ;
+    size_t index ;
+} Sfc_pair ;
+
+
+
+/* ***************************************************************************
+ * ** Functions **************************************************************
+ * **************************************************************************/
+
+
+/* ***********************
+ * ** private functions **
+ * **********************/
+
+static int
+compare_pair (
+
+        const void* a ,
+        const void* b
+        )
+/* comparison function for 'qsort', by key and then by index */
+{
+    const Sfc_pair* pa = (const Sfc_pair*) a ;
+    const Sfc_pair* pb = (const Sfc_pair*) b ;
+    if ( pa->key != pb->key ) {
+
+        return pa->key < pb->key ? -1 : 1 ;
+    }
+    return ( pa->index > pb->index ) - ( pa->index < pb->index ) ;
+}
+
+static void
+hilbert_transpose (
+
+        uint64_t* x ,
+        int dim ,
+        int bits
+        )
+/* transforms the cell coordinates 'x' into the "transposed" Hilbert index
+ * (J. Skilling, Programming the Hilbert curve, AIP Conf. Proc. 707, 2004):
+ * interleaving the bits of the result gives the position on the curve */
+{
+    uint64_t m = (uint64_t) 1 << ( bits - 1 ) ;
+
+    /* inverse undo */
+    for ( uint64_t q = m ; q > 1 ; q >>= 1 ) {
+
+        uint64_t p = q - 1 ;
+        for ( int i = 0 ; i < dim ; i++ ) {
+
+            if ( x[i] & q ) {
+
+                x[0] ^= p ;
+            } else {
+
+                uint64_t t = ( x[0] ^ x[i] ) & p ;
+                x[0] ^= t ;
+                x[i] ^= t ;
+            }
+        }
+    }
+
+    /* Gray encode */
+    for ( int i = 1 ; i < dim ; i++ ) {
+
+        x[i] ^= x[i-1] ;
+    }
+    uint64_t t = 0 ;
+    for ( uint64_t q = m ; q > 1 ; q >>= 1 ) {
+
+        if ( x[dim-1] & q ) {
+
+            t ^= q - 1 ;
+        }
+    }
+    for ( int i = 0 ; i < dim ; i++ ) {
+
+        x[i] ^= t ;
+    }
+}
+
+static uint64_t
+interleave (
+
+        const uint64_t* x ,
+        int dim ,
+        int bits
+        )
+/* key with the bits of 'x' interleaved, the highest bit of 'x[0]' first */
+{
+    uint64_t key = 0 ;
+    for ( int b = bits - 1 ; b >= 0 ; b-- ) {
+
+        for ( int i = 0 ; i < dim ; i++ ) {
+
+            key = ( key << 1 ) | ( ( x[i] >> b ) & 1 ) ;
+        }
+    }
+    return key ;
+}
+
+
+
+/* **********************
+ * ** public functions **
+ * *********************/
+
+int
+sfc_order (
+
+        const double* coords ,
+        size_t n ,
+        int dim ,
+        Sfc_curve curve ,
+        size_t* order
+        )
+{
+    if ( dim < 1 || dim > 63 ) {
+
+        return GW_EINVAL ;
+    }
+    int bits = 63 / dim < 32 ? 63 / dim : 32 ;
+    double cells = ldexp( 1, bits ) ;
+
+    Sfc_pair* pairs = malloc( n * sizeof(Sfc_pair) ) ;
+    double* lower = malloc( dim * sizeof(double) ) ;
+    uint64_t* x = malloc( dim * sizeof(uint64_t) ) ;
+    if ( pairs == NULL || lower == NULL || x == NULL ) {
+
+        free( pairs ) ;
+        free( lower ) ;
+        free( x ) ;
+        return GW_ENOMEM ;
+    }
+
+    /* same scale in all dimensions, so that the cells are cubes */
+    double extent = 0 ;
+    for ( int l = 0 ; l < dim ; l++ ) {
+
+        const double* c = coords + (size_t) l * n ;
+        double hi = n > 0 ? c[0] : 0 ;
+        lower[l] = hi ;
+        for ( size_t k = 1 ; k < n ; k++ ) {
+
+            lower[l] = fmin( lower[l], c[k] ) ;
+            hi = fmax( hi, c[k] ) ;
+        }
+        extent = fmax( extent, hi - lower[l] ) ;
+    }
+    double scale = extent > 0 ? cells / extent : 0 ;
+
+    for ( size_t k = 0 ; k < n ; k++ ) {
+
+        for ( int l = 0 ; l < dim ; l++ ) {
+
+            double cell = floor( ( coords[k + (size_t) l * n] - lower[l] )
+                    * scale ) ;
+            x[l] = cell < cells ? (uint64_t) cell : (uint64_t) cells - 1 ;
+        }
+        if ( curve == SFC_HILBERT ) {
+
+            hilbert_transpose( x, dim, bits ) ;
+        }
+        pairs[k].key = interleave( x, dim, bits ) ;
+        pairs[k].index = k ;
+    }
+    qsort( pairs, n, sizeof(Sfc_pair), compare_pair ) ;
+    for ( size_t k = 0 ; k < n ; k++ ) {
+
+        order[k] = pairs[k].index ;
+    }
+
+    free( pairs ) ;
+    free( lower ) ;
+    free( x ) ;
+    return GW_OK ;
+}
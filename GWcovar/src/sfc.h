@@ -0,0 +1,82 @@
+/* This file is part of the R-package 'GWcovar'
+ *
+ * Copyright (C) 2019 Josef Stocker <josef@josefstocker.ch>
+ *
+ * 'GWcovar' is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <https://www.gnu.org/licenses/>.
+ * */
+
+#ifndef SFC_H_
+#define SFC_H_
+
+
+/* ****************************************************************************
+ * ** Include directives  *****************************************************
+ * ***************************************************************************/
+
+#include "stddef.h" /* for type size_t */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+
+/* ***************************************************************************
+ * ** Public data structures *************************************************
+ * **************************************************************************/
+
+typedef enum {
+/* ***************************************************************************
+ * Space-filling curves along which the locations can be ordered.
+ * **************************************************************************/
+    SFC_HILBERT = 0,
+    /* Hilbert curve: consecutive locations are always neighbours */
+
+    SFC_MORTON = 1
+    /* Morton (Z-order) curve: cheaper, but with jumps between quadrants */
+} Sfc_curve ;
+
+
+
+/* ***************************************************************************
+ * ***************************************************************************
+ * ** Public functions  ******************************************************
+ * ***************************************************************************
+ * **************************************************************************/
+
+int
+sfc_order (
+/* ***************************************************************************
+ * The function 'int sfc_order(...)' orders the 'n' locations 'coords' (n x
+ * dim, column major) along the space-filling curve 'curve' and writes the
+ * permutation to 'order': 'order[k]' is the index of the k-th location on
+ * the curve. The coordinates are mapped to a grid of 2^b cells per
+ * dimension, b = min( 63 / dim, 32 ), over the bounding box of the
+ * locations; locations in the same cell keep their order. Nearby locations
+ * get nearby positions, so a covariance matrix in this order is clustered
+ * around the diagonal. Returns 'GW_OK', 'GW_EINVAL' (dim < 1 or dim > 63)
+ * or 'GW_ENOMEM' (see 'gwcovar.h').
+ * **************************************************************************/
+        const double* coords ,
+        size_t n ,
+        int dim ,
+        Sfc_curve curve ,
+        size_t* order
+        ) ;
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  /* #ifndef SFC_H_ */
@@ -0,0 +1,236 @@
+/* This file is part of the R-package 'GWcovar'
+ *
+ * Copyright (C) 2019 Josef Stocker <josef@josefstocker.ch>
+ *
+ * 'GWcovar' is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <https://www.gnu.org/licenses/>.
+ * */
+
+
+/* ***************************************************************************
+ * ** Include directives  ****************************************************
+ * **************************************************************************/
+
+#include "sim.h"
+
+#include "stdlib.h"
+#include "math.h"
+
+#include "gwcovar.h"
+
+/* ***************************************************************************
+ * ** Private data structures ************************************************
+ * **************************************************************************/
+
+#define PHILOX_M0 0xD2511F53u
+#define PHILOX_M1 0xCD9E8D57u
+#define PHILOX_W0 0x9E3779B9u
+#define PHILOX_W1 0xBB67AE85u
+/* constants of Philox4x32 (Salmon et al., 2011) */
+
+
+
+/* ***************************************************************************
+ * ** Functions **************************************************************
+ * **************************************************************************/
+
+
+/* ***********************
+ * ** private functions **
+ * **********************/
+
+static void
+philox (
+
+        uint32_t ctr[4] ,
+        uint64_t seed
+        )
+/* Philox4x32-10: replaces the counter 'ctr' by 4 random numbers */
+{
+    uint32_t k0 = (uint32_t) seed ;
+    uint32_t k1 = (uint32_t) ( seed >> 32 ) ;
+    for ( int round = 0 ; round < 10 ; round++ ) {
+
+        uint64_t p0 = (uint64_t) PHILOX_M0 * ctr[0] ;
+        uint64_t p1 = (uint64_t) PHILOX_M1 * ctr[2] ;
+        uint32_t c0 = (uint32_t) ( p1 >> 32 ) ^ ctr[1] ^ k0 ;
+        uint32_t c2 = (uint32_t) ( p0 >> 32 ) ^ ctr[3] ^ k1 ;
+        ctr[1] = (uint32_t) p1 ;
+        ctr[3] = (uint32_t) p0 ;
+        ctr[0] = c0 ;
+        ctr[2] = c2 ;
+        k0 += PHILOX_W0 ;
+        k1 += PHILOX_W1 ;
+    }
+}
+
+static void
+normal_pair (
+
+        uint64_t seed ,
+        uint64_t replicate ,
+        uint64_t pair ,
+        double* z0 ,
+        double* z1
+        )
+/* two standard normal numbers for the rows 2*pair and 2*pair+1 of the
+ * realisation 'replicate' (Box-Muller) */
+{
+    uint32_t ctr[4] = {
+        (uint32_t) pair, (uint32_t) ( pair >> 32 ),
+        (uint32_t) replicate, (uint32_t) ( replicate >> 32 )
+    } ;
+    philox( ctr, seed ) ;
+
+    /* uniform numbers in (0,1] with 53 random bits */
+    uint64_t a = ( (uint64_t) ctr[0] << 32 ) | ctr[1] ;
+    uint64_t b = ( (uint64_t) ctr[2] << 32 ) | ctr[3] ;
+    double u1 = (double) ( ( a >> 11 ) + 1 ) * 0x1.0p-53 ;
+    double u2 = (double) ( b >> 11 ) * 0x1.0p-53 ;
+
+    double radius = sqrt( -2.0 * log( u1 ) ) ;
+    *z0 = radius * cos( 2.0 * M_PI * u2 ) ;
+    *z1 = radius * sin( 2.0 * M_PI * u2 ) ;
+}
+
+
+
+/* **********************
+ * ** public functions **
+ * *********************/
+
+int
+gw_sim_fill (
+
+        const Gw_factor* factor ,
+        double* out ,
+        size_t first ,
+        size_t count ,
+        uint64_t seed ,
+        size_t block
+        )
+{
+    size_t n = factor->n ;
+    if ( block == 0 ) {
+
+        block = 1 ;
+    }
+    long nblocks = (long) ( ( count + block - 1 ) / block ) ;
+    int error = 0 ;
+
+#pragma omp parallel for schedule(dynamic)
+    for ( long b = 0 ; b < nblocks ; b++ ) {
+
+        size_t r0 = (size_t) b * block ;
+        size_t nb = count - r0 < block ? count - r0 : block ;
+        double* z = malloc( n * nb * sizeof(double) ) ;
+        double* y = calloc( n * nb, sizeof(double) ) ;
+        /* right hand sides and results, the 'nb' values of a row are
+         * stored next to each other */
+
+        if ( z == NULL || y == NULL ) {
+
+            free( z ) ;
+            free( y ) ;
+#pragma omp atomic write
+            error = 1 ;
+            continue ;
+        }
+
+        for ( size_t c = 0 ; c < nb ; c++ ) {
+
+            for ( size_t i = 0 ; i < n ; i += 2 ) {
+
+                double z0, z1 ;
+                normal_pair( seed, first + r0 + c, i / 2, &z0, &z1 ) ;
+                z[i*nb + c] = z0 ;
+                if ( i + 1 < n ) {
+
+                    z[(i+1)*nb + c] = z1 ;
+                }
+            }
+        }
+
+        /* y = R^T z, reading each entry of R once per block */
+        for ( size_t i = 0 ; i < n ; i++ ) {
+
+            const double* zi = z + i*nb ;
+            for ( int k = factor->rowpointers[i] - 1 ;
+                    k < factor->rowpointers[i+1] - 1 ; k++ ) {
+
+                double v = factor->entries[k] ;
+                double* yj = y + (size_t) ( factor->colindices[k] - 1 ) * nb ;
+                for ( size_t c = 0 ; c < nb ; c++ ) {
+
+                    yj[c] += v * zi[c] ;
+                }
+            }
+        }
+
+        for ( size_t c = 0 ; c < nb ; c++ ) {
+
+            double* col = out + ( r0 + c ) * n ;
+            for ( size_t j = 0 ; j < n ; j++ ) {
+
+                size_t row = factor->pivot != NULL
+                    ? (size_t) factor->pivot[j] - 1 : j ;
+                col[row] = y[j*nb + c] ;
+            }
+        }
+        free( z ) ;
+        free( y ) ;
+    }
+    return error ? GW_ENOMEM : GW_OK ;
+}
+
+int
+gw_sim_write (
+
+        const Gw_factor* factor ,
+        FILE* file ,
+        size_t count ,
+        uint64_t seed ,
+        size_t block ,
+        size_t chunk
+        )
+{
+    size_t n = factor->n ;
+    if ( chunk == 0 ) {
+
+        chunk = 1 ;
+    }
+    if ( chunk > count ) {
+
+        chunk = count ;
+    }
+    double* buffer = malloc( n * chunk * sizeof(double) ) ;
+    if ( buffer == NULL && count > 0 ) {
+
+        return GW_ENOMEM ;
+    }
+
+    int ret = GW_OK ;
+    for ( size_t first = 0 ; first < count && ret == GW_OK ;
+            first += chunk ) {
+
+        size_t m = count - first < chunk ? count - first : chunk ;
+        ret = gw_sim_fill( factor, buffer, first, m, seed, block ) ;
+        if ( ret == GW_OK && fwrite( buffer, sizeof(double), n * m, file )
+                != n * m ) {
+
+            ret = GW_EIO ;
+        }
+    }
+    free( buffer ) ;
+    return ret ;
+}
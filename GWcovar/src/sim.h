@@ -0,0 +1,117 @@
+/* This file is part of the R-package 'GWcovar'
+ *
+ * Copyright (C) 2019 Josef Stocker <josef@josefstocker.ch>
+ *
+ * 'GWcovar' is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <https://www.gnu.org/licenses/>.
+ * */
+
+#ifndef SIM_H_
+#define SIM_H_
+
+
+/* ****************************************************************************
+ * ** Include directives  *****************************************************
+ * ***************************************************************************/
+
+#include "stddef.h" /* for type size_t */
+#include "stdint.h" /* for type uint64_t */
+#include "stdio.h"  /* for type FILE */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+
+/* ***************************************************************************
+ * ** Public data structures *************************************************
+ * **************************************************************************/
+
+typedef struct {
+/* ***************************************************************************
+ * Sparse Cholesky factor R of a permuted covariance matrix,
+ * C[pivot,pivot] = R^T R, in the compressed row format of the R package
+ * 'spam' (indices starting at 1), e.g. 'as.spam(chol(C))' with
+ * 'ordering(chol(C))' as pivot. R has to be upper triangular.
+ * **************************************************************************/
+    size_t n ;
+    /* dimension of the matrix */
+
+    const double* entries ;
+    const int* colindices ;
+    const int* rowpointers ;
+    /* non-zero entries of R */
+
+    const int* pivot ;
+    /* permutation of the rows and columns of C ('NULL' for none) */
+} Gw_factor ;
+
+
+
+/* ***************************************************************************
+ * ***************************************************************************
+ * ** Public functions  ******************************************************
+ * ***************************************************************************
+ * **************************************************************************/
+
+int
+gw_sim_fill (
+/* ***************************************************************************
+ * The function 'int gw_sim_fill(...)' draws the realisations 'first', ...,
+ * 'first + count - 1' of a zero mean Gaussian random field with covariance
+ * matrix C and writes them as columns of the n x count matrix 'out'
+ * (column-major).
+ *
+ * Each realisation is x = R^T z (undoing the permutation), where z are
+ * standard normal numbers from the counter-based generator Philox4x32-10
+ * with key 'seed' and the realisation and row as counter. A realisation
+ * therefore only depends on 'seed' and its number, not on the number of
+ * threads or on how the realisations are split between calls. The
+ * realisations are calculated in blocks of 'block' right hand sides, so
+ * every entry of R is read once per block; with OpenMP the blocks are
+ * distributed over the threads.
+ *
+ * Returns 'GW_OK' or 'GW_ENOMEM' (see 'gwcovar.h').
+ * **************************************************************************/
+        const Gw_factor* factor ,
+        double* out ,
+        size_t first ,
+        size_t count ,
+        uint64_t seed ,
+        size_t block
+        ) ;
+
+
+int
+gw_sim_write (
+/* ***************************************************************************
+ * The function 'int gw_sim_write(...)' draws 'count' realisations like
+ * 'gw_sim_fill(...)' (starting with realisation 0) and writes them to 'file'
+ * as raw doubles in the byte order of the machine, one realisation after the
+ * other. Only 'chunk' realisations are held in memory at a time. Returns
+ * 'GW_OK', 'GW_ENOMEM' or 'GW_EIO' if writing failed.
+ * **************************************************************************/
+        const Gw_factor* factor ,
+        FILE* file ,
+        size_t count ,
+        uint64_t seed ,
+        size_t block ,
+        size_t chunk
+        ) ;
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  /* #ifndef SIM_H_ */
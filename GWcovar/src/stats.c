@@ -0,0 +1,140 @@
+/* This file is part of the R-package 'GWcovar'
+ *
+ * Copyright (C) 2019 Josef Stocker <josef@josefstocker.ch>
+ *
+ * 'GWcovar' is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <https://www.gnu.org/licenses/>.
+ * */
+
+
+/* ***************************************************************************
+ * ** Include directives  ****************************************************
+ * **************************************************************************/
+
+#include "stats.h"
+
+#include "time.h"
+#include "math.h"
+
+
+
+/* ***************************************************************************
+ * ** Functions **************************************************************
+ * **************************************************************************/
+
+
+/* ***********************
+ * ** private functions **
+ * **********************/
+
+static void
+count_error (
+
+        Covar_stats* stats ,
+        int code
+        )
+/* counts one GSL error with the code 'code' */
+{
+    if ( code == 0 ) {
+
+        return ;
+    }
+    if ( code < 0 || code >= STATS_MAX_ERRNO ) {
+
+        code = STATS_MAX_ERRNO - 1 ;
+    }
+    stats->errors[code]++ ;
+}
+
+
+
+/* **********************
+ * ** public functions **
+ * *********************/
+
+void
+stats_reset (
+
+        Covar_stats* stats
+        )
+{
+    int enabled = stats->enabled ;
+    *stats = (Covar_stats) { 0 } ;
+    stats->enabled = enabled ;
+}
+
+void
+stats_record (
+
+        Covar_stats* stats ,
+        const Wendland_result* result
+        )
+{
+    count_error( stats, result->error ) ;
+    count_error( stats, result->error_b ) ;
+
+    if ( result->neval == 0 ) {
+
+        return ;
+    }
+    stats->quadratures++ ;
+    stats->neval += result->neval ;
+
+    int bin = 0 ;
+    if ( result->abserr >= 1e-15 ) {
+
+        bin = (int) floor( log10( result->abserr ) ) + 16 ;
+        if ( bin > STATS_ABSERR_BINS - 1 ) {
+
+            bin = STATS_ABSERR_BINS - 1 ;
+        }
+    }
+    stats->abserr_hist[bin]++ ;
+}
+
+void
+stats_merge (
+
+        Covar_stats* to ,
+        const Covar_stats* from
+        )
+{
+    to->calls += from->calls ;
+    to->quadratures += from->quadratures ;
+    to->neval += from->neval ;
+    for ( int k = 0 ; k < STATS_ABSERR_BINS ; k++ ) {
+
+        to->abserr_hist[k] += from->abserr_hist[k] ;
+    }
+    for ( int k = 0 ; k < STATS_MAX_ERRNO ; k++ ) {
+
+        to->errors[k] += from->errors[k] ;
+    }
+    to->cache_hits += from->cache_hits ;
+    to->cache_misses += from->cache_misses ;
+    for ( int k = 0 ; k < 3 ; k++ ) {
+
+        to->time[k] += from->time[k] ;
+    }
+}
+
+double
+stats_clock (
+
+        void
+        )
+{
+    struct timespec ts ;
+    clock_gettime( CLOCK_MONOTONIC, &ts ) ;
+    return (double) ts.tv_sec + 1e-9 * (double) ts.tv_nsec ;
+}
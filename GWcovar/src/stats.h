@@ -0,0 +1,145 @@
+/* This file is part of the R-package 'GWcovar'
+ *
+ * Copyright (C) 2019 Josef Stocker <josef@josefstocker.ch>
+ *
+ * 'GWcovar' is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <https://www.gnu.org/licenses/>.
+ * */
+
+#ifndef STATS_H_
+#define STATS_H_
+
+
+/* ****************************************************************************
+ * ** Include directives  *****************************************************
+ * ***************************************************************************/
+
+#include "stddef.h" /* for type size_t */
+
+#include "wendland.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+
+/* ***************************************************************************
+ * ** Public data structures *************************************************
+ * **************************************************************************/
+
+#define STATS_ABSERR_BINS 14
+/* Number of bins of the histogram of the estimated integration errors. Bin 0
+ * counts errors below 1e-15, bin k (1 <= k <= 12) errors in
+ * [1e-16 * 10^k, 1e-15 * 10^k) and the last bin errors of at least 1e-3. */
+
+#define STATS_MAX_ERRNO 64
+/* GSL error codes are small positive integers; larger codes are counted in
+ * the last element of the error counters. */
+
+typedef enum {
+/* ***************************************************************************
+ * Phases of a covariance calculation the time is attributed to.
+ * **************************************************************************/
+    STATS_TABLE = 0,    /* calculation of interpolation tables */
+    STATS_KERNEL = 1,   /* direct evaluation of the GW function */
+    STATS_OUTPUT = 2    /* writing the output from a table */
+} Stats_phase ;
+
+
+typedef struct {
+/* ***************************************************************************
+ * Statistics about the calculations done by the functions in 'covar.c'.
+ * The collector is not thread-safe; parallel code has to collect into one
+ * struct per thread and combine them with 'stats_merge(...)'.
+ * **************************************************************************/
+    int enabled ;
+    /* statistics are only recorded if 'enabled' is not '0' */
+
+    size_t calls ;
+    /* number of calls of the entry points */
+
+    size_t quadratures ;
+    /* number of numerical integrations */
+
+    size_t neval ;
+    /* total number of evaluations of the integrand */
+
+    size_t abserr_hist[STATS_ABSERR_BINS] ;
+    /* histogram of the estimated absolute integration errors */
+
+    size_t errors[STATS_MAX_ERRNO] ;
+    /* number of GSL errors by error code (integration and beta function) */
+
+    size_t cache_hits ;
+    /* number of tables that could be reused */
+
+    size_t cache_misses ;
+    /* number of tables that had to be calculated */
+
+    double time[3] ;
+    /* wall time in seconds spent in each phase (indexed by 'Stats_phase') */
+} Covar_stats ;
+
+
+
+/* ***************************************************************************
+ * ***************************************************************************
+ * ** Public functions  ******************************************************
+ * ***************************************************************************
+ * **************************************************************************/
+
+void
+stats_reset (
+/* ***************************************************************************
+ * Sets all counters of 'stats' to zero. 'stats->enabled' is not changed.
+ * **************************************************************************/
+        Covar_stats* stats
+        ) ;
+
+
+void
+stats_record (
+/* ***************************************************************************
+ * Records the number of evaluations, the estimated error and the error codes
+ * of one call of 'wendland(...)'. Results with 'neval == 0' (no numerical
+ * integration was necessary) only contribute their error codes.
+ * **************************************************************************/
+        Covar_stats* stats ,
+        const Wendland_result* result
+        ) ;
+
+
+void
+stats_merge (
+/* ***************************************************************************
+ * Adds all counters of 'from' to 'to'.
+ * **************************************************************************/
+        Covar_stats* to ,
+        const Covar_stats* from
+        ) ;
+
+
+double
+stats_clock (
+/* ***************************************************************************
+ * Returns a monotonic wall clock time in seconds.
+ * **************************************************************************/
+        void
+        ) ;
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  /* #ifndef STATS_H_ */
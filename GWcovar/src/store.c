@@ -0,0 +1,447 @@
+/* This file is part of the R-package 'GWcovar'
+ *
+ * Copyright (C) 2019 Josef Stocker <josef@josefstocker.ch>
+ *
+ * 'GWcovar' is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <https://www.gnu.org/licenses/>.
+ * */
+
+
+/* ***************************************************************************
+ * ** Include directives  ****************************************************
+ * **************************************************************************/
+
+#include "store.h"
+
+#include "stdio.h"
+#include "stdlib.h"
+#include "string.h"
+#include "errno.h"
+#include "fcntl.h"
+#include "unistd.h"
+#include "sys/file.h"
+#include "sys/mman.h"
+#include "sys/stat.h"
+
+/* ***************************************************************************
+ * ** Private data structures ************************************************
+ * **************************************************************************/
+
+static const char store_magic[8] = { 'G', 'W', 'C', 'O', 'V', 'T', 'A', 'B' } ;
+
+#define STORE_BYTE_ORDER 0x01020304u
+
+
+
+/* ***************************************************************************
+ * ** Functions **************************************************************
+ * **************************************************************************/
+
+
+/* ***********************
+ * ** private functions **
+ * **********************/
+
+static int
+store_validate (
+
+        const void* map ,
+        size_t size
+        )
+/* checks the header and the directory of a mapped store file */
+{
+    const Store_header* header = map ;
+    if ( size < sizeof(Store_header)
+            || memcmp( header->magic, store_magic, 8 ) != 0 ) {
+
+        return STORE_EFORMAT ;
+    }
+    if ( header->version != STORE_VERSION
+            || header->byte_order != STORE_BYTE_ORDER ) {
+
+        return STORE_EVERSION ;
+    }
+    if ( header->count > ( size - sizeof(Store_header) )
+            / sizeof(Store_entry) ) {
+
+        return STORE_EFORMAT ;
+    }
+
+    const Store_entry* entries = (const Store_entry*) ( header + 1 ) ;
+    for ( uint64_t k = 0 ; k < header->count ; k++ ) {
+
+        if ( entries[k].offset % sizeof(double) != 0
+                || entries[k].offset > size
+                || entries[k].n > ( size - entries[k].offset )
+                    / sizeof(double) ) {
+
+            return STORE_EFORMAT ;
+        }
+    }
+    return STORE_OK ;
+}
+
+static int
+store_map (
+
+        Gw_store* store
+        )
+/* maps the current file at 'store->path' (the previous mapping is kept on
+ * error) */
+{
+    struct stat st ;
+    int fd = open( store->path, O_RDONLY ) ;
+    if ( fd < 0 ) {
+
+        if ( errno != ENOENT ) {
+
+            return STORE_EIO ;
+        }
+        /* no file yet: empty store */
+        if ( store->map != NULL ) {
+
+            munmap( (void*) store->map, store->size ) ;
+        }
+        store->map = NULL ;
+        store->size = 0 ;
+        store->dev = 0 ;
+        store->ino = 0 ;
+        return STORE_OK ;
+    }
+    if ( fstat( fd, &st ) != 0 ) {
+
+        close( fd ) ;
+        return STORE_EIO ;
+    }
+    size_t size = (size_t) st.st_size ;
+    void* map = size > 0
+        ? mmap( NULL, size, PROT_READ, MAP_SHARED, fd, 0 ) : MAP_FAILED ;
+    close( fd ) ;
+    /* the mapping stays valid after closing the file */
+
+    if ( map == MAP_FAILED ) {
+
+        return size > 0 ? STORE_EIO : STORE_EFORMAT ;
+    }
+    int ret = store_validate( map, size ) ;
+    if ( ret != STORE_OK ) {
+
+        munmap( map, size ) ;
+        return ret ;
+    }
+
+    if ( store->map != NULL ) {
+
+        munmap( (void*) store->map, store->size ) ;
+    }
+    store->map = map ;
+    store->size = size ;
+    store->dev = st.st_dev ;
+    store->ino = st.st_ino ;
+    return STORE_OK ;
+}
+
+static int
+store_changed (
+
+        const Gw_store* store
+        )
+/* whether the file at 'store->path' is not the mapped one anymore */
+{
+    struct stat st ;
+    if ( stat( store->path, &st ) != 0 ) {
+
+        return store->map != NULL ;
+    }
+    return store->map == NULL || st.st_dev != store->dev
+        || st.st_ino != store->ino ;
+}
+
+static const double*
+store_find (
+
+        const Gw_store* store ,
+        double mu ,
+        double smoothness ,
+        double abstol ,
+        double reltol ,
+        size_t n
+        )
+/* searches the directory of the mapped file */
+{
+    if ( store->map == NULL ) {
+
+        return NULL ;
+    }
+    const Store_header* header = store->map ;
+    const Store_entry* entries = (const Store_entry*) ( header + 1 ) ;
+    for ( uint64_t k = 0 ; k < header->count ; k++ ) {
+
+        if ( entries[k].mu == mu && entries[k].smoothness == smoothness
+                && entries[k].abstol == abstol && entries[k].reltol == reltol
+                && entries[k].n == n ) {
+
+            return (const double*) ( (const char*) store->map
+                    + entries[k].offset ) ;
+        }
+    }
+    return NULL ;
+}
+
+static int
+store_write (
+
+        const Gw_store* store ,
+        const Store_entry* key ,
+        const double* values
+        )
+/* writes the mapped tables and the new one to a temporary file and renames
+ * it over the store file */
+{
+    const Store_header* old = store->map ;
+    const Store_entry* old_entries =
+        old != NULL ? (const Store_entry*) ( old + 1 ) : NULL ;
+    uint64_t count = ( old != NULL ? old->count : 0 ) + 1 ;
+
+    size_t len = strlen( store->path ) ;
+    char* tmp = malloc( len + 8 ) ;
+    Store_entry* entries = malloc( count * sizeof(Store_entry) ) ;
+    if ( tmp == NULL || entries == NULL ) {
+
+        free( tmp ) ;
+        free( entries ) ;
+        return STORE_ENOMEM ;
+    }
+
+    /* directory of the new file */
+    uint64_t offset = sizeof(Store_header) + count * sizeof(Store_entry) ;
+    for ( uint64_t k = 0 ; k < count ; k++ ) {
+
+        entries[k] = k + 1 < count ? old_entries[k] : *key ;
+        entries[k].offset = offset ;
+        offset += entries[k].n * sizeof(double) ;
+    }
+    Store_header header ;
+    memcpy( header.magic, store_magic, 8 ) ;
+    header.version = STORE_VERSION ;
+    header.byte_order = STORE_BYTE_ORDER ;
+    header.count = count ;
+
+    /* temporary file in the same directory, so 'rename' is atomic */
+    memcpy( tmp, store->path, len ) ;
+    memcpy( tmp + len, ".XXXXXX", 8 ) ;
+    int fd = mkstemp( tmp ) ;
+    FILE* file = fd >= 0 ? fdopen( fd, "wb" ) : NULL ;
+    if ( file == NULL ) {
+
+        if ( fd >= 0 ) {
+
+            close( fd ) ;
+            unlink( tmp ) ;
+        }
+        free( tmp ) ;
+        free( entries ) ;
+        return STORE_EIO ;
+    }
+    fchmod( fd, 0644 ) ;
+    /* 'mkstemp' creates the file only readable by the owner */
+
+    int ok = fwrite( &header, sizeof(Store_header), 1, file ) == 1
+        && fwrite( entries, sizeof(Store_entry), count, file ) == count ;
+    for ( uint64_t k = 0 ; ok && k + 1 < count ; k++ ) {
+
+        ok = fwrite( (const char*) store->map + old_entries[k].offset,
+                sizeof(double), old_entries[k].n, file ) == old_entries[k].n ;
+    }
+    ok = ok && fwrite( values, sizeof(double), key->n, file ) == key->n ;
+    ok = ok && fflush( file ) == 0 && fsync( fd ) == 0 ;
+    ok = ( fclose( file ) == 0 ) && ok ;
+    ok = ok && rename( tmp, store->path ) == 0 ;
+
+    if ( !ok ) {
+
+        unlink( tmp ) ;
+    }
+    free( tmp ) ;
+    free( entries ) ;
+    return ok ? STORE_OK : STORE_EIO ;
+}
+
+
+
+/* **********************
+ * ** public functions **
+ * *********************/
+
+int
+store_open (
+
+        Gw_store* store ,
+        const char* path ,
+        int writable
+        )
+{
+    store->path = malloc( strlen( path ) + 1 ) ;
+    store->writable = writable ;
+    store->map = NULL ;
+    store->size = 0 ;
+    store->dev = 0 ;
+    store->ino = 0 ;
+    if ( store->path == NULL ) {
+
+        return STORE_ENOMEM ;
+    }
+    strcpy( store->path, path ) ;
+
+    int ret = store_map( store ) ;
+    if ( ret != STORE_OK ) {
+
+        store_close( store ) ;
+    }
+    return ret ;
+}
+
+const double*
+store_lookup (
+
+        Gw_store* store ,
+        double mu ,
+        double smoothness ,
+        double abstol ,
+        double reltol ,
+        size_t n
+        )
+{
+    if ( store->path == NULL ) {
+
+        return NULL ;
+    }
+    const double* values = store_find( store, mu, smoothness, abstol,
+            reltol, n ) ;
+    if ( values == NULL && store_changed( store )
+            && store_map( store ) == STORE_OK ) {
+        /* another process has added tables */
+
+        values = store_find( store, mu, smoothness, abstol, reltol, n ) ;
+    }
+    return values ;
+}
+
+int
+store_add (
+
+        Gw_store* store ,
+        double mu ,
+        double smoothness ,
+        double abstol ,
+        double reltol ,
+        size_t n ,
+        const double* values
+        )
+{
+    if ( store->path == NULL || !store->writable ) {
+
+        return STORE_EREADONLY ;
+    }
+
+    /* lock out the other writers */
+    size_t len = strlen( store->path ) ;
+    char* lock_path = malloc( len + 6 ) ;
+    if ( lock_path == NULL ) {
+
+        return STORE_ENOMEM ;
+    }
+    memcpy( lock_path, store->path, len ) ;
+    memcpy( lock_path + len, ".lock", 6 ) ;
+    int lock = open( lock_path, O_RDWR | O_CREAT, 0644 ) ;
+    free( lock_path ) ;
+    if ( lock < 0 || flock( lock, LOCK_EX ) != 0 ) {
+
+        if ( lock >= 0 ) {
+
+            close( lock ) ;
+        }
+        return STORE_EIO ;
+    }
+
+    /* the file may have been replaced while waiting for the lock */
+    int ret = STORE_OK ;
+    if ( store_changed( store ) ) {
+
+        ret = store_map( store ) ;
+    }
+    if ( ret == STORE_OK && store_find( store, mu, smoothness, abstol, reltol,
+                n ) == NULL ) {
+
+        Store_entry key = { mu, smoothness, abstol, reltol, n, 0 } ;
+        ret = store_write( store, &key, values ) ;
+        if ( ret == STORE_OK ) {
+
+            ret = store_map( store ) ;
+        }
+    }
+
+    flock( lock, LOCK_UN ) ;
+    close( lock ) ;
+    return ret ;
+}
+
+size_t
+store_count (
+
+        const Gw_store* store
+        )
+{
+    if ( store->map == NULL ) {
+
+        return 0 ;
+    }
+    return (size_t) ( (const Store_header*) store->map )->count ;
+}
+
+void
+store_close (
+
+        Gw_store* store
+        )
+{
+    if ( store->map != NULL ) {
+
+        munmap( (void*) store->map, store->size ) ;
+    }
+    free( store->path ) ;
+    store->path = NULL ;
+    store->map = NULL ;
+    store->size = 0 ;
+    store->dev = 0 ;
+    store->ino = 0 ;
+}
+
+const char*
+store_strerror (
+
+        int code
+        )
+{
+    switch ( code ) {
+
+        case STORE_OK: return "success" ;
+        case STORE_EIO: return strerror( errno ) ;
+        case STORE_EFORMAT: return "file is not a GWcovar table store" ;
+        case STORE_EVERSION:
+            return "table store was written by another version or machine" ;
+        case STORE_ENOMEM: return "out of memory" ;
+        case STORE_EREADONLY: return "table store is read-only" ;
+        default: return "unknown error" ;
+    }
+}
@@ -0,0 +1,214 @@
+/* This file is part of the R-package 'GWcovar'
+ *
+ * Copyright (C) 2019 Josef Stocker <josef@josefstocker.ch>
+ *
+ * 'GWcovar' is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <https://www.gnu.org/licenses/>.
+ * */
+
+#ifndef STORE_H_
+#define STORE_H_
+
+
+/* ****************************************************************************
+ * ** Include directives  *****************************************************
+ * ***************************************************************************/
+
+#include "stddef.h" /* for type size_t */
+#include "stdint.h"
+#include "sys/types.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+
+/* ***************************************************************************
+ * ** Public data structures *************************************************
+ * **************************************************************************/
+
+#define STORE_OK 0
+#define STORE_EIO 1
+#define STORE_EFORMAT 2
+#define STORE_EVERSION 3
+#define STORE_ENOMEM 4
+#define STORE_EREADONLY 5
+/* return values of the functions in 'store.c' */
+
+#define STORE_VERSION 1
+/* version of the file format; files with another version are not read */
+
+typedef struct {
+/* ***************************************************************************
+ * Header at the beginning of a table store file. All numbers are stored in
+ * the byte order of the machine that wrote the file; 'byte_order' is used to
+ * reject files written on a machine with another byte order.
+ * **************************************************************************/
+    char magic[8] ;
+    /* "GWCOVTAB" */
+
+    uint32_t version ;
+    /* 'STORE_VERSION' */
+
+    uint32_t byte_order ;
+    /* 0x01020304 */
+
+    uint64_t count ;
+    /* number of tables in the file */
+} Store_header ;
+
+
+typedef struct {
+/* ***************************************************************************
+ * Directory entry of one table. The directory follows the header, the values
+ * of the tables follow the directory. A table contains the GW correlation
+ * function in the 'n' points i / (n-1) of the normalised distance, as in
+ * 'Gw_table' (see 'table.h'); it is identified by all parameters that
+ * influence these values.
+ * **************************************************************************/
+    double mu ;
+    double smoothness ;
+    double abstol ;
+    double reltol ;
+    uint64_t n ;
+    /* key of the table */
+
+    uint64_t offset ;
+    /* position of the values in the file (bytes, multiple of 8) */
+} Store_entry ;
+
+
+typedef struct {
+/* ***************************************************************************
+ * An open table store. The file is mapped read-only into memory, so the
+ * tables are shared through the page cache between all processes using the
+ * same file. Tables are added by writing a new file and renaming it over the
+ * old one, so readers never see a partially written file and do not need any
+ * locking. Writers are serialised with a lock on the file '<path>.lock'.
+ * **************************************************************************/
+    char* path ;
+    /* path of the store file ('NULL' if no store is open) */
+
+    int writable ;
+    /* whether new tables are added to the file */
+
+    const void* map ;
+    /* mapping of the file ('NULL' if the file does not exist yet) */
+
+    size_t size ;
+    /* size of the mapping in bytes */
+
+    dev_t dev ;
+    ino_t ino ;
+    /* identity of the mapped file, used to detect that another process has
+     * replaced it */
+} Gw_store ;
+
+
+
+/* ***************************************************************************
+ * ***************************************************************************
+ * ** Public functions  ******************************************************
+ * ***************************************************************************
+ * **************************************************************************/
+
+int
+store_open (
+/* ***************************************************************************
+ * The function 'int store_open(...)' opens the table store at 'path' and maps
+ * it into memory. A file that does not exist yet is treated as an empty store
+ * and is created when the first table is added (if 'writable' is not 0).
+ * Returns 'STORE_OK' on success, 'STORE_EFORMAT' or 'STORE_EVERSION' if the
+ * file is not a valid store of the current version and 'STORE_EIO' or
+ * 'STORE_ENOMEM' otherwise. On error 'store' is left closed.
+ * **************************************************************************/
+        Gw_store* store ,
+        const char* path ,
+        int writable
+        ) ;
+
+
+const double*
+store_lookup (
+/* ***************************************************************************
+ * The function 'const double* store_lookup(...)' returns the values of the
+ * table with the given key, or 'NULL' if the store does not contain it. If
+ * the table is not found and the file has been replaced by another process,
+ * the new file is mapped and searched, too. The returned pointer points into
+ * the mapping; it is valid until the next call of a function of 'store.c'
+ * with the same 'store'.
+ * **************************************************************************/
+        Gw_store* store ,
+        double mu ,
+        double smoothness ,
+        double abstol ,
+        double reltol ,
+        size_t n
+        ) ;
+
+
+int
+store_add (
+/* ***************************************************************************
+ * The function 'int store_add(...)' adds the table 'values' with 'n' points
+ * and the given key to the store. The file is rewritten to a temporary file
+ * in the same directory which is then renamed over the store file, so the
+ * operation is atomic for all readers. If another process has added the same
+ * table in the meantime, nothing is written. Afterwards the new file is
+ * mapped. Returns 'STORE_OK' on success, 'STORE_EREADONLY' if the store is
+ * not writable and one of the other codes if the file could not be written;
+ * the store stays usable in any case.
+ * **************************************************************************/
+        Gw_store* store ,
+        double mu ,
+        double smoothness ,
+        double abstol ,
+        double reltol ,
+        size_t n ,
+        const double* values
+        ) ;
+
+
+size_t
+store_count (
+/* ***************************************************************************
+ * Returns the number of tables in the currently mapped file.
+ * **************************************************************************/
+        const Gw_store* store
+        ) ;
+
+
+void
+store_close (
+/* ***************************************************************************
+ * Unmaps the file and releases the memory held by 'store'. Closing a store
+ * that is not open has no effect.
+ * **************************************************************************/
+        Gw_store* store
+        ) ;
+
+
+const char*
+store_strerror (
+/* ***************************************************************************
+ * Returns a description of the return code 'code'.
+ * **************************************************************************/
+        int code
+        ) ;
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  /* #ifndef STORE_H_ */
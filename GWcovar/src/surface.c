@@ -0,0 +1,471 @@
+/* This file is part of the R-package 'GWcovar'
+ *
+ * Copyright (C) 2019 Josef Stocker <josef@josefstocker.ch>
+ *
+ * 'GWcovar' is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <https://www.gnu.org/licenses/>.
+ * */
+
+
+/* ***************************************************************************
+ * ** Include directives  ****************************************************
+ * **************************************************************************/
+
+#include "surface.h"
+
+#include "stdio.h"
+#include "stdlib.h"
+#include "string.h"
+#include "math.h"
+#include "errno.h"
+#include "fcntl.h"
+#include "unistd.h"
+#include "sys/mman.h"
+#include "sys/stat.h"
+#include "gsl/gsl_errno.h"
+
+#include "wendland.h"
+#include "table.h"
+#include "scratch.h"
+
+#ifdef _OPENMP
+#include "omp.h"
+#endif
+
+/* ***************************************************************************
+ * ** Private data structures ************************************************
+ * **************************************************************************/
+
+static const char surface_magic[8] = { 'G', 'W', 'C', 'O', 'V', 'S', 'R', 'F' } ;
+
+#define SURFACE_BYTE_ORDER 0x01020304u
+
+#define SURFACE_SAFETY 2
+/* factor between the largest error found at the check points and the
+ * recorded error, since the check points do not hit the maximum exactly;
+ * an empirical margin, not a proven bound */
+
+
+
+/* ***************************************************************************
+ * ** Functions **************************************************************
+ * **************************************************************************/
+
+
+/* ***********************
+ * ** private functions **
+ * **********************/
+
+static size_t
+lagrange_weights (
+
+        double x ,
+        double lo ,
+        double hi ,
+        size_t n ,
+        double* w
+        )
+/* weights of the cubic (or lower degree for n < 4) Lagrange polynomial
+ * through the grid points closest to 'x' among the 'n' equidistant points
+ * of [lo, hi]. Writes the weights to 'w' (up to 4) and returns the index of
+ * the first point; the number of points is min(n, 4). */
+{
+    size_t m = n < 4 ? n : 4 ;
+    double t = ( x - lo ) / ( hi - lo ) * (double) ( n - 1 ) ;
+    double first = floor( t ) - (double) ( m / 2 - 1 ) ;
+    if ( first > (double) ( n - m ) ) {
+
+        first = (double) ( n - m ) ;
+    }
+    if ( first < 0 ) {
+
+        first = 0 ;
+    }
+    for ( size_t a = 0 ; a < m ; a++ ) {
+
+        w[a] = 1 ;
+        for ( size_t b = 0 ; b < m ; b++ ) {
+
+            if ( b != a ) {
+
+                w[a] *= ( t - first - (double) b ) / ( (double) a - (double) b ) ;
+            }
+        }
+    }
+    return (size_t) first ;
+}
+
+static void
+interpolate (
+
+        const Surface_header* header ,
+        const double* values ,
+        double mu ,
+        double kappa ,
+        double* out
+        )
+/* table in r for (mu, kappa), see 'surface_values(...)' */
+{
+    size_t n_r = (size_t) header->n_r ;
+    size_t n_mu = (size_t) header->n_mu ;
+    size_t n_kappa = (size_t) header->n_kappa ;
+    double w_mu[4], w_kappa[4] ;
+    size_t m_mu = n_mu < 4 ? n_mu : 4 ;
+    size_t m_kappa = n_kappa < 4 ? n_kappa : 4 ;
+    size_t j0 = lagrange_weights( mu, header->mu_lo, header->mu_hi, n_mu,
+            w_mu ) ;
+    size_t l0 = lagrange_weights( kappa, header->kappa_lo, header->kappa_hi,
+            n_kappa, w_kappa ) ;
+
+    for ( size_t i = 0 ; i < n_r ; i++ ) {
+
+        out[i] = 0 ;
+    }
+    for ( size_t b = 0 ; b < m_kappa ; b++ ) {
+
+        for ( size_t a = 0 ; a < m_mu ; a++ ) {
+
+            double w = w_mu[a] * w_kappa[b] ;
+            const double* table = values
+                + ( ( l0 + b ) * n_mu + j0 + a ) * n_r ;
+            for ( size_t i = 0 ; i < n_r ; i++ ) {
+
+                out[i] += w * table[i] ;
+            }
+        }
+    }
+}
+
+static int
+correlation (
+
+        double r ,
+        double mu ,
+        double kappa ,
+        const Surface_header* header ,
+        int* gsl_error ,
+        double* value
+        )
+/* GW correlation function by numerical integration */
+{
+    Wendland_result result ;
+    wendland( &result, r, mu, kappa, header->abstol, header->reltol ) ;
+    *gsl_error = wendland_error( &result ) ;
+    if ( *gsl_error != 0 ) {
+
+        return result.error != 0 ? SURFACE_EINTEG : SURFACE_EBETA ;
+    }
+    *value = result.result ;
+    return SURFACE_OK ;
+}
+
+static int
+surface_write (
+
+        const Surface_header* header ,
+        const double* values ,
+        const char* path
+        )
+/* writes the surface to a temporary file and renames it over 'path' */
+{
+    size_t len = strlen( path ) ;
+    size_t count = (size_t) ( header->n_r * header->n_mu * header->n_kappa ) ;
+    char* tmp = malloc( len + 8 ) ;
+    if ( tmp == NULL ) {
+
+        return SURFACE_ENOMEM ;
+    }
+    memcpy( tmp, path, len ) ;
+    memcpy( tmp + len, ".XXXXXX", 8 ) ;
+    int fd = mkstemp( tmp ) ;
+    FILE* file = fd >= 0 ? fdopen( fd, "wb" ) : NULL ;
+    if ( file == NULL ) {
+
+        if ( fd >= 0 ) {
+
+            close( fd ) ;
+            unlink( tmp ) ;
+        }
+        free( tmp ) ;
+        return SURFACE_EIO ;
+    }
+    int ok = fwrite( header, sizeof(Surface_header), 1, file ) == 1
+        && fwrite( values, sizeof(double), count, file ) == count ;
+    ok = ( fclose( file ) == 0 ) && ok ;
+    if ( ok ) {
+
+        ok = rename( tmp, path ) == 0 ;
+    }
+    if ( !ok ) {
+
+        unlink( tmp ) ;
+    }
+    free( tmp ) ;
+    return ok ? SURFACE_OK : SURFACE_EIO ;
+}
+
+
+
+/* **********************
+ * ** public functions **
+ * *********************/
+
+int
+surface_build (
+
+        Surface_header* header ,
+        const char* path ,
+        int nthreads ,
+        int* gsl_error
+        )
+{
+    size_t n_r = (size_t) header->n_r ;
+    size_t n_mu = (size_t) header->n_mu ;
+    size_t n_kappa = (size_t) header->n_kappa ;
+    if ( n_r < 3 || n_mu < 2 || n_kappa < 2
+            || !( header->mu_lo > 0 ) || !( header->mu_hi > header->mu_lo )
+            || !( header->kappa_lo >= 0 )
+            || !( header->kappa_hi > header->kappa_lo ) ) {
+
+        return SURFACE_EINVAL ;
+    }
+    memcpy( header->magic, surface_magic, 8 ) ;
+    header->version = SURFACE_VERSION ;
+    header->byte_order = SURFACE_BYTE_ORDER ;
+    header->error = 0 ;
+
+    size_t nodes = n_mu * n_kappa ;
+    size_t cells = ( n_mu - 1 ) * ( n_kappa - 1 ) ;
+    double* values = malloc( nodes * n_r * sizeof(double) ) ;
+    if ( values == NULL ) {
+
+        return SURFACE_ENOMEM ;
+    }
+    double dmu = ( header->mu_hi - header->mu_lo ) / (double) ( n_mu - 1 ) ;
+    double dkappa = ( header->kappa_hi - header->kappa_lo )
+        / (double) ( n_kappa - 1 ) ;
+#ifdef _OPENMP
+    int nt = nthreads > 0 ? nthreads : omp_get_max_threads() ;
+#else
+    int nt = 1 ;
+    (void) nthreads ;
+#endif
+    int status = SURFACE_OK ;
+    double error = 0 ;
+    gsl_set_error_handler_off() ;
+
+    #pragma omp parallel num_threads(nt)
+    {
+        int ret = SURFACE_OK ;
+        int gsl = 0 ;
+        double worst = 0 ;
+
+        /* values in the grid points */
+        #pragma omp for schedule(dynamic, 1)
+        for ( size_t k = 0 ; k < nodes ; k++ ) {
+
+            double mu = header->mu_lo + (double) ( k % n_mu ) * dmu ;
+            double kappa = header->kappa_lo + (double) ( k / n_mu ) * dkappa ;
+            for ( size_t i = 0 ; i < n_r && ret == SURFACE_OK ; i++ ) {
+
+                ret = correlation( (double) i / (double) ( n_r - 1 ), mu,
+                        kappa, header, &gsl, values + k*n_r + i ) ;
+            }
+        }
+
+        /* check at 3 x 3 points of every cell; the barrier at the end of the
+         * previous loop makes all values visible */
+        double* table = scratch_alloc( n_r * sizeof(double) ) ;
+        if ( table == NULL && ret == SURFACE_OK ) {
+
+            ret = SURFACE_ENOMEM ;
+        }
+        #pragma omp for schedule(dynamic, 1)
+        for ( size_t k = 0 ; k < 9 * cells ; k++ ) {
+
+            if ( ret != SURFACE_OK ) {
+
+                continue ;
+            }
+            size_t cell = k / 9 ;
+            double mu = header->mu_lo + ( (double) ( cell % ( n_mu - 1 ) )
+                    + 0.25 * (double) ( 1 + k % 3 ) ) * dmu ;
+            double kappa = header->kappa_lo + ( (double) ( cell / ( n_mu - 1 ) )
+                    + 0.25 * (double) ( 1 + k / 3 % 3 ) ) * dkappa ;
+            Gw_table spline ;
+            interpolate( header, values, mu, kappa, table ) ;
+            if ( gw_table_wrap( &spline, n_r, table ) != TABLE_OK ) {
+
+                ret = SURFACE_ENOMEM ;
+                continue ;
+            }
+            for ( size_t i = 0 ; i + 1 < n_r && ret == SURFACE_OK ; i++ ) {
+
+                double r = ( (double) i + 0.5 ) / (double) ( n_r - 1 ) ;
+                double exact ;
+                ret = correlation( r, mu, kappa, header, &gsl, &exact ) ;
+                double diff = fabs( gw_table_eval( &spline, r, NULL )
+                        - exact ) ;
+                if ( ret == SURFACE_OK && diff > worst ) {
+
+                    worst = diff ;
+                }
+            }
+            gw_table_free( &spline ) ;
+        }
+        scratch_free( table ) ;
+
+        #pragma omp critical (surface_build)
+        {
+            if ( ret != SURFACE_OK && status == SURFACE_OK ) {
+
+                status = ret ;
+                *gsl_error = gsl ;
+            }
+            if ( worst > error ) {
+
+                error = worst ;
+            }
+        }
+    }
+
+    if ( status == SURFACE_OK ) {
+
+        header->error = SURFACE_SAFETY * error ;
+        status = surface_write( header, values, path ) ;
+    }
+    free( values ) ;
+    return status ;
+}
+
+int
+surface_open (
+
+        Gw_surface* surface ,
+        const char* path
+        )
+{
+    struct stat st ;
+    surface->map = NULL ;
+    surface->size = 0 ;
+
+    int fd = open( path, O_RDONLY ) ;
+    if ( fd < 0 ) {
+
+        return SURFACE_EIO ;
+    }
+    if ( fstat( fd, &st ) != 0 ) {
+
+        close( fd ) ;
+        return SURFACE_EIO ;
+    }
+    size_t size = (size_t) st.st_size ;
+    if ( size < sizeof(Surface_header) ) {
+
+        close( fd ) ;
+        return SURFACE_EFORMAT ;
+    }
+    void* map = mmap( NULL, size, PROT_READ, MAP_SHARED, fd, 0 ) ;
+    close( fd ) ;
+    /* the mapping stays valid after closing the file */
+    if ( map == MAP_FAILED ) {
+
+        return SURFACE_EIO ;
+    }
+
+    const Surface_header* header = map ;
+    int ret = SURFACE_OK ;
+    if ( memcmp( header->magic, surface_magic, 8 ) != 0 ) {
+
+        ret = SURFACE_EFORMAT ;
+    } else if ( header->version != SURFACE_VERSION
+            || header->byte_order != SURFACE_BYTE_ORDER ) {
+
+        ret = SURFACE_EVERSION ;
+    } else if ( header->n_r < 3 || header->n_mu < 2 || header->n_kappa < 2
+            || size != sizeof(Surface_header) + header->n_r * header->n_mu
+            * header->n_kappa * sizeof(double) ) {
+
+        ret = SURFACE_EFORMAT ;
+    }
+    if ( ret != SURFACE_OK ) {
+
+        munmap( map, size ) ;
+        return ret ;
+    }
+    surface->map = header ;
+    surface->size = size ;
+    return SURFACE_OK ;
+}
+
+int
+surface_covers (
+
+        const Gw_surface* surface ,
+        double mu ,
+        double kappa
+        )
+{
+    const Surface_header* header = surface->map ;
+    return header != NULL
+        && mu >= header->mu_lo && mu <= header->mu_hi
+        && kappa >= header->kappa_lo && kappa <= header->kappa_hi ;
+}
+
+void
+surface_values (
+
+        const Gw_surface* surface ,
+        double mu ,
+        double kappa ,
+        double* out
+        )
+{
+    interpolate( surface->map, (const double*) ( surface->map + 1 ), mu,
+            kappa, out ) ;
+}
+
+void
+surface_close (
+
+        Gw_surface* surface
+        )
+{
+    if ( surface->map != NULL ) {
+
+        munmap( (void*) surface->map, surface->size ) ;
+    }
+    surface->map = NULL ;
+    surface->size = 0 ;
+}
+
+const char*
+surface_strerror (
+
+        int code
+        )
+{
+    switch ( code ) {
+
+        case SURFACE_OK: return "success" ;
+        case SURFACE_ENOMEM: return "out of memory" ;
+        case SURFACE_EINTEG: return "numerical integration failed" ;
+        case SURFACE_EBETA: return "calculation of the beta function failed" ;
+        case SURFACE_EINVAL: return "invalid argument" ;
+        case SURFACE_EIO: return strerror( errno ) ;
+        case SURFACE_EFORMAT: return "file is not a GWcovar surface" ;
+        case SURFACE_EVERSION:
+            return "surface was written by another version or machine" ;
+        default: return "unknown error" ;
+    }
+}
@@ -0,0 +1,215 @@
+/* This file is part of the R-package 'GWcovar'
+ *
+ * Copyright (C) 2019 Josef Stocker <josef@josefstocker.ch>
+ *
+ * 'GWcovar' is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <https://www.gnu.org/licenses/>.
+ * */
+
+#ifndef SURFACE_H_
+#define SURFACE_H_
+
+
+/* ****************************************************************************
+ * ** Include directives  *****************************************************
+ * ***************************************************************************/
+
+#include "stddef.h" /* for type size_t */
+#include "stdint.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+
+/* ***************************************************************************
+ * ** Public data structures *************************************************
+ * **************************************************************************/
+
+#define SURFACE_OK 0
+#define SURFACE_ENOMEM 1
+#define SURFACE_EINTEG 2
+#define SURFACE_EBETA 3
+#define SURFACE_EINVAL 4
+#define SURFACE_EIO 5
+#define SURFACE_EFORMAT 6
+#define SURFACE_EVERSION 7
+/* return values of the functions in 'surface.c'; the first ones agree with
+ * the codes of 'gwcovar.h' */
+
+#define SURFACE_VERSION 1
+/* version of the file format; files with another version are not read */
+
+typedef struct {
+/* ***************************************************************************
+ * Header at the beginning of a surface file, followed by the values. A
+ * surface tabulates the GW correlation function over the normalised
+ * distance r, mu and the smoothness kappa on the tensor-product grid
+ *
+ *      r_i = i / (n_r-1) ,
+ *      mu_j = mu_lo + j * (mu_hi - mu_lo) / (n_mu-1) ,
+ *      kappa_l = kappa_lo + l * (kappa_hi - kappa_lo) / (n_kappa-1) ,
+ *
+ * value (i,j,l) being stored at position (l * n_mu + j) * n_r + i, i.e.
+ * the table in r of every grid point (mu_j, kappa_l) is contiguous. All
+ * numbers are stored in the byte order of the machine that wrote the file.
+ * **************************************************************************/
+    char magic[8] ;
+    /* "GWCOVSRF" */
+
+    uint32_t version ;
+    /* 'SURFACE_VERSION' */
+
+    uint32_t byte_order ;
+    /* 0x01020304 */
+
+    uint64_t n_r ;
+    uint64_t n_mu ;
+    uint64_t n_kappa ;
+    /* size of the grid */
+
+    double mu_lo ;
+    double mu_hi ;
+    double kappa_lo ;
+    double kappa_hi ;
+    /* box of the parameters */
+
+    double abstol ;
+    double reltol ;
+    /* tolerances of the numerical integration of the grid values */
+
+    double error ;
+    /* estimate of the largest absolute error of the interpolated correlation
+     * function over the box (see 'surface_build(...)') */
+} Surface_header ;
+
+
+typedef struct {
+/* ***************************************************************************
+ * An open surface. The file is mapped read-only into memory, so it is
+ * shared through the page cache between all processes using it.
+ * **************************************************************************/
+    const Surface_header* map ;
+    /* mapping of the file ('NULL' if no surface is open) */
+
+    size_t size ;
+    /* size of the mapping in bytes */
+} Gw_surface ;
+
+
+
+/* ***************************************************************************
+ * ***************************************************************************
+ * ** Public functions  ******************************************************
+ * ***************************************************************************
+ * **************************************************************************/
+
+int
+surface_build (
+/* ***************************************************************************
+ * The function 'int surface_build(...)' tabulates the GW correlation
+ * function on the grid described in 'header' (only the sizes, the box and
+ * the tolerances are read) with 'wendland(...)' and writes the surface to
+ * 'path'. The grid points are distributed over 'nthreads' OpenMP threads
+ * (<= 0: default of OpenMP).
+ *
+ * The values for a point (mu, kappa) of the box are interpolated as in
+ * 'surface_values(...)' and then with a cubic spline in r. This is checked
+ * against numerical integration in every cell of the grid, at the midpoints
+ * in r and at 1/4, 1/2 and 3/4 of the cell in mu and kappa (the interpolation
+ * in the cells at the border of the box is one-sided, so its error is not
+ * largest in the centre). Twice the largest absolute error found is written
+ * to 'header->error' and to the file as the error estimate for the whole
+ * box. This is an empirical estimate, not a proven bound: the check points
+ * come within a few percent of the maximum for a grid that resolves the
+ * function, but the error between them is not controlled.
+ *
+ * The file is written to a temporary file in the same directory and renamed
+ * over 'path'. Returns 'SURFACE_OK' on success, 'SURFACE_EINVAL' if a size
+ * is below 2 ('n_r' below 3) or the box is empty, 'SURFACE_EINTEG' or
+ * 'SURFACE_EBETA' (with the GSL error code in 'gsl_error') if an
+ * integration failed and 'SURFACE_ENOMEM' or 'SURFACE_EIO' otherwise.
+ * **************************************************************************/
+        Surface_header* header ,
+        const char* path ,
+        int nthreads ,
+        int* gsl_error
+        ) ;
+
+
+int
+surface_open (
+/* ***************************************************************************
+ * The function 'int surface_open(...)' maps the surface file at 'path'.
+ * Returns 'SURFACE_OK' on success, 'SURFACE_EFORMAT' or 'SURFACE_EVERSION'
+ * if the file is not a valid surface of the current version and
+ * 'SURFACE_EIO' otherwise. On error 'surface' is left closed.
+ * **************************************************************************/
+        Gw_surface* surface ,
+        const char* path
+        ) ;
+
+
+int
+surface_covers (
+/* ***************************************************************************
+ * Returns '1' if the point (mu, kappa) lies within the box of 'surface' and
+ * '0' otherwise (also if no surface is open).
+ * **************************************************************************/
+        const Gw_surface* surface ,
+        double mu ,
+        double kappa
+        ) ;
+
+
+void
+surface_values (
+/* ***************************************************************************
+ * The function 'void surface_values(...)' writes the GW correlation function
+ * with the parameters 'mu' and 'kappa' in the 'n_r' points i / (n_r-1) of
+ * the normalised distance to 'out', interpolated with local cubic
+ * polynomials through the 4 x 4 closest grid points in (mu, kappa). The
+ * result is a table for 'gw_kernel_wrap(...)' (see 'gwcovar.h'); no
+ * numerical integration is necessary. (mu, kappa) has to be covered by the
+ * surface (see 'surface_covers(...)').
+ * **************************************************************************/
+        const Gw_surface* surface ,
+        double mu ,
+        double kappa ,
+        double* out
+        ) ;
+
+
+void
+surface_close (
+/* ***************************************************************************
+ * Unmaps the file. Closing a surface that is not open has no effect.
+ * **************************************************************************/
+        Gw_surface* surface
+        ) ;
+
+
+const char*
+surface_strerror (
+/* ***************************************************************************
+ * Returns a description of the return code 'code' of 'surface.c'.
+ * **************************************************************************/
+        int code
+        ) ;
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  /* #ifndef SURFACE_H_ */
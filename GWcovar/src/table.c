@@ -0,0 +1,334 @@
+/* This file is part of the R-package 'GWcovar'
+ *
+ * Copyright (C) 2019 Josef Stocker <josef@josefstocker.ch>
+ *
+ * 'GWcovar' is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <https://www.gnu.org/licenses/>.
+ * */
+
+
+/* ***************************************************************************
+ * ** Include directives  ****************************************************
+ * **************************************************************************/
+
+#include "table.h"
+
+#include "stdlib.h"
+#include "math.h"
+#include "gsl/gsl_errno.h"
+
+#include "wendland.h"
+#include "scratch.h"
+
+
+
+/* ***************************************************************************
+ * ** Functions **************************************************************
+ * **************************************************************************/
+
+
+/* ***********************
+ * ** private functions **
+ * **********************/
+
+static int
+table_value (
+
+        double r ,
+        double mu ,
+        double smoothness ,
+        double abstol ,
+        double reltol ,
+        Covar_stats* stats ,
+        double* value ,
+        int* gsl_error
+        )
+/* calculates the GW correlation function in 'r' and records the integration
+ * in 'stats'. Returns 'TABLE_OK' on success; on error the GSL error code is
+ * written to 'gsl_error' and 'TABLE_EINTEG' or 'TABLE_EBETA' is returned. */
+{
+    Wendland_result result ;
+    wendland( &result, r, mu, smoothness, abstol, reltol ) ;
+    if ( stats != NULL && stats->enabled ) {
+
+        stats_record( stats, &result ) ;
+    }
+    *gsl_error = wendland_error( &result ) ;
+    if ( *gsl_error != 0 ) {
+
+        return result.error != 0 ? TABLE_EINTEG : TABLE_EBETA ;
+    }
+    *value = result.result ;
+    return TABLE_OK ;
+}
+
+static int
+table_init_interp (
+
+        Gw_table* table
+        )
+/* (re)initialises the spline through the points of 'table' */
+{
+    if ( table->interp != NULL ) {
+
+        gsl_interp_free( table->interp ) ;
+    }
+    table->interp = gsl_interp_alloc( gsl_interp_cspline, table->n ) ;
+    if ( table->interp == NULL ) {
+
+        return TABLE_ENOMEM ;
+    }
+    gsl_interp_init( table->interp, table->points, table->values, table->n ) ;
+    return TABLE_OK ;
+}
+
+
+
+/* **********************
+ * ** public functions **
+ * *********************/
+
+int
+gw_table_build (
+
+        Gw_table* table ,
+        size_t n ,
+        double mu ,
+        double smoothness ,
+        double abstol ,
+        double reltol ,
+        Covar_stats* stats
+        )
+{
+    table->n = n ;
+    table->points = scratch_alloc( n * sizeof(double) ) ;
+    table->values = scratch_alloc( n * sizeof(double) ) ;
+    table->interp = NULL ;
+    table->borrowed = 0 ;
+    table->gsl_error = 0 ;
+
+    if ( table->points == NULL || table->values == NULL ) {
+
+        gw_table_free( table ) ;
+        return TABLE_ENOMEM ;
+    }
+
+    gsl_set_error_handler_off() ;
+    for ( size_t i = 0 ; i < n ; i++ ) {
+
+        table->points[i] = (double) i / (double) ( n - 1 ) ;
+        int gsl_error ;
+        int ret = table_value( table->points[i], mu, smoothness, abstol,
+                reltol, stats, &table->values[i], &gsl_error ) ;
+        if ( ret != TABLE_OK ) {
+
+            gw_table_free( table ) ;
+            table->gsl_error = gsl_error ;
+            return ret ;
+        }
+    }
+
+    if ( table_init_interp( table ) != TABLE_OK ) {
+
+        gw_table_free( table ) ;
+        return TABLE_ENOMEM ;
+    }
+    return TABLE_OK ;
+}
+
+int
+gw_table_refine (
+
+        Gw_table* table ,
+        double mu ,
+        double smoothness ,
+        double abstol ,
+        double reltol ,
+        Covar_stats* stats
+        )
+{
+    size_t n = 2 * table->n - 1 ;
+    double* points = scratch_alloc( n * sizeof(double) ) ;
+    double* values = scratch_alloc( n * sizeof(double) ) ;
+
+    if ( points == NULL || values == NULL ) {
+
+        scratch_free( points ) ;
+        scratch_free( values ) ;
+        gw_table_free( table ) ;
+        return TABLE_ENOMEM ;
+    }
+
+    gsl_set_error_handler_off() ;
+    for ( size_t i = 0 ; i < n ; i++ ) {
+
+        points[i] = (double) i / (double) ( n - 1 ) ;
+        if ( i % 2 == 0 ) {
+            /* point of the coarser table */
+
+            values[i] = table->values[i/2] ;
+        } else {
+
+            int gsl_error ;
+            int ret = table_value( points[i], mu, smoothness, abstol, reltol,
+                    stats, &values[i], &gsl_error ) ;
+            if ( ret != TABLE_OK ) {
+
+                scratch_free( points ) ;
+                scratch_free( values ) ;
+                gw_table_free( table ) ;
+                table->gsl_error = gsl_error ;
+                return ret ;
+            }
+        }
+    }
+
+    scratch_free( table->points ) ;
+    if ( !table->borrowed ) {
+
+        scratch_free( table->values ) ;
+    }
+    table->points = points ;
+    table->values = values ;
+    table->n = n ;
+    table->borrowed = 0 ;
+
+    if ( table_init_interp( table ) != TABLE_OK ) {
+
+        gw_table_free( table ) ;
+        return TABLE_ENOMEM ;
+    }
+    return TABLE_OK ;
+}
+
+double
+gw_table_check (
+
+        Gw_table* table ,
+        double mu ,
+        double smoothness ,
+        double abstol ,
+        double reltol ,
+        size_t nchecks ,
+        Covar_stats* stats ,
+        int* error
+        )
+{
+    size_t intervals = table->n - 1 ;
+    size_t step = nchecks > 1 ? ( intervals - 1 ) / ( nchecks - 1 ) : 0 ;
+    double worst = 0 ;
+
+    if ( step == 0 ) {
+
+        step = 1 ;
+    }
+
+    gsl_set_error_handler_off() ;
+    for ( size_t k = 0 ; k < intervals ; k += step ) {
+
+        double r = 0.5 * ( table->points[k] + table->points[k+1] ) ;
+        double exact ;
+        *error = table_value( r, mu, smoothness, abstol, reltol, stats,
+                &exact, &table->gsl_error ) ;
+        if ( *error != TABLE_OK ) {
+
+            return INFINITY ;
+        }
+        double tol = fmax( abstol, reltol * fabs( exact ) ) ;
+        double ratio = fabs( gw_table_eval( table, r, NULL ) - exact ) / tol ;
+        if ( ratio > worst ) {
+
+            worst = ratio ;
+        }
+
+        if ( k + step >= intervals && k != intervals - 1 ) {
+            /* always check the last interval */
+
+            k = intervals - 1 - step ;
+        }
+    }
+    *error = TABLE_OK ;
+    return worst ;
+}
+
+int
+gw_table_wrap (
+
+        Gw_table* table ,
+        size_t n ,
+        const double* values
+        )
+{
+    table->n = n ;
+    table->points = scratch_alloc( n * sizeof(double) ) ;
+    table->values = (double*) values ;
+    /* the values are only read, also by 'gsl_interp_init(...)' */
+    table->interp = NULL ;
+    table->borrowed = 1 ;
+    table->gsl_error = 0 ;
+
+    if ( table->points == NULL ) {
+
+        gw_table_free( table ) ;
+        return TABLE_ENOMEM ;
+    }
+    for ( size_t i = 0 ; i < n ; i++ ) {
+
+        table->points[i] = (double) i / (double) ( n - 1 ) ;
+    }
+    if ( table_init_interp( table ) != TABLE_OK ) {
+
+        gw_table_free( table ) ;
+        return TABLE_ENOMEM ;
+    }
+    return TABLE_OK ;
+}
+
+double
+gw_table_eval (
+
+        const Gw_table* table ,
+        double r ,
+        gsl_interp_accel* acc
+        )
+{
+    if ( r >= 1 ) {
+
+        return 0 ;
+    }
+    return gsl_interp_eval( table->interp, table->points, table->values, r,
+            acc ) ;
+}
+
+void
+gw_table_free (
+
+        Gw_table* table
+        )
+{
+    if ( table->interp != NULL ) {
+
+        gsl_interp_free( table->interp ) ;
+    }
+    scratch_free( table->points ) ;
+    if ( !table->borrowed ) {
+
+        scratch_free( table->values ) ;
+    }
+    table->interp = NULL ;
+    table->points = NULL ;
+    table->values = NULL ;
+    table->n = 0 ;
+    table->borrowed = 0 ;
+    table->gsl_error = 0 ;
+}
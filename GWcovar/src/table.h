@@ -0,0 +1,186 @@
+/* This file is part of the R-package 'GWcovar'
+ *
+ * Copyright (C) 2019 Josef Stocker <josef@josefstocker.ch>
+ *
+ * 'GWcovar' is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <https://www.gnu.org/licenses/>.
+ * */
+
+#ifndef TABLE_H_
+#define TABLE_H_
+
+
+/* ****************************************************************************
+ * ** Include directives  *****************************************************
+ * ***************************************************************************/
+
+#include "stddef.h" /* for type size_t */
+#include "gsl/gsl_interp.h"
+
+#include "stats.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+
+/* ***************************************************************************
+ * ** Public data structures *************************************************
+ * **************************************************************************/
+
+#define TABLE_OK 0
+#define TABLE_ENOMEM 1
+#define TABLE_EINTEG 2
+#define TABLE_EBETA 3
+/* return values of the functions in 'table.c' */
+
+typedef struct {
+/* ***************************************************************************
+ * Table of the GW correlation function in 'n' equidistant points of the
+ * normalised distance r = dist / range in [0,1], interpolated with cubic
+ * splines. The table does not depend on the range, the sill and the nugget,
+ * so it can be reused whenever only these parameters change.
+ * **************************************************************************/
+    size_t n ;
+    /* number of interpolation points */
+
+    double* points ;
+    /* interpolation points i / (n-1) */
+
+    double* values ;
+    /* GW correlation function in the interpolation points */
+
+    gsl_interp* interp ;
+    /* cubic spline through the points */
+
+    int borrowed ;
+    /* '1' if 'values' is owned by someone else (e.g. a memory-mapped table
+     * store, see 'store.h') and must not be freed */
+
+    int gsl_error ;
+    /* GSL error code after a function returned 'TABLE_EINTEG' or
+     * 'TABLE_EBETA' (the table itself is freed then) */
+} Gw_table ;
+
+
+
+/* ***************************************************************************
+ * ***************************************************************************
+ * ** Public functions  ******************************************************
+ * ***************************************************************************
+ * **************************************************************************/
+
+int
+gw_table_build (
+/* ***************************************************************************
+ * The function 'int gw_table_build(...)' allocates 'table' and calculates the
+ * GW correlation function with the parameters 'mu' and 'smoothness' in 'n'
+ * points (n >= 3) using 'wendland(...)' with the tolerances 'abstol' and
+ * 'reltol'. The integrations are recorded in 'stats', if 'stats' is not
+ * 'NULL' and enabled. Returns 'TABLE_OK' on success. On error the table is
+ * freed and 'TABLE_ENOMEM', 'TABLE_EINTEG' (numerical integration failed) or
+ * 'TABLE_EBETA' (beta function failed) is returned.
+ * **************************************************************************/
+        Gw_table* table ,
+        size_t n ,
+        double mu ,
+        double smoothness ,
+        double abstol ,
+        double reltol ,
+        Covar_stats* stats
+        ) ;
+
+
+int
+gw_table_refine (
+/* ***************************************************************************
+ * The function 'int gw_table_refine(...)' doubles the resolution of 'table'
+ * (n -> 2n-1). The values in the existing points are kept, so only n-1 new
+ * integrations are necessary. The parameters have to be the same as the ones
+ * used to build the table. Returns the same codes as 'gw_table_build(...)';
+ * on error the table is freed.
+ * **************************************************************************/
+        Gw_table* table ,
+        double mu ,
+        double smoothness ,
+        double abstol ,
+        double reltol ,
+        Covar_stats* stats
+        ) ;
+
+
+double
+gw_table_check (
+/* ***************************************************************************
+ * The function 'double gw_table_check(...)' compares the interpolated values
+ * with 'wendland(...)' in the midpoints of 'nchecks' intervals spread over
+ * [0,1] (always including the first and the last interval). Returns the
+ * largest ratio between the interpolation error and the tolerance
+ * max( abstol, reltol * |value| ), i.e. a value <= 1 means that the table
+ * is as accurate as the numerical integration. If an integration fails,
+ * '*error' is set to 'TABLE_EINTEG' or 'TABLE_EBETA' and the GSL error code
+ * is written to 'table->gsl_error'.
+ * **************************************************************************/
+        Gw_table* table ,
+        double mu ,
+        double smoothness ,
+        double abstol ,
+        double reltol ,
+        size_t nchecks ,
+        Covar_stats* stats ,
+        int* error
+        ) ;
+
+
+int
+gw_table_wrap (
+/* ***************************************************************************
+ * The function 'int gw_table_wrap(...)' initialises 'table' with 'n' values
+ * of the GW correlation function in the points i / (n-1) that are owned by
+ * the caller, e.g. a table read from the table store. The values are not
+ * copied, so they have to stay valid (and unchanged) until 'table' is freed.
+ * Returns 'TABLE_OK' or 'TABLE_ENOMEM'.
+ * **************************************************************************/
+        Gw_table* table ,
+        size_t n ,
+        const double* values
+        ) ;
+
+
+double
+gw_table_eval (
+/* ***************************************************************************
+ * Returns the interpolated GW correlation function at the normalised
+ * distance 'r'. Values of 'r' >= 1 give 0. 'acc' may be 'NULL'; each thread
+ * has to use its own accelerator.
+ * **************************************************************************/
+        const Gw_table* table ,
+        double r ,
+        gsl_interp_accel* acc
+        ) ;
+
+
+void
+gw_table_free (
+/* ***************************************************************************
+ * Releases the memory held by 'table'.
+ * **************************************************************************/
+        Gw_table* table
+        ) ;
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  /* #ifndef TABLE_H_ */
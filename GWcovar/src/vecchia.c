@@ -0,0 +1,336 @@
+/* This file is part of the R-package 'GWcovar'
+ *
+ * Copyright (C) 2019 Josef Stocker <josef@josefstocker.ch>
+ *
+ * 'GWcovar' is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <https://www.gnu.org/licenses/>.
+ * */
+
+
+
+/* ***************************************************************************
+ * ** Include directives  ****************************************************
+ * **************************************************************************/
+
+#include "vecchia.h"
+
+#include "stdlib.h"
+#include "math.h"
+#include "gsl/gsl_errno.h"
+
+#include "grid_index.h"
+#include "scratch.h"
+
+/* ***************************************************************************
+ * ** Private data structures ************************************************
+ * **************************************************************************/
+
+typedef struct {
+    /* the 'm' nearest neighbours found so far, sorted by distance */
+    size_t self ;
+    /* only locations with a smaller index are neighbours */
+
+    size_t m ;
+    size_t k ;
+    /* maximal and current number of neighbours */
+
+    size_t* index ;
+    double* dist ;
+    /* neighbours and their distances; 'index' has space for m+1 entries */
+} Neighbours ;
+
+typedef struct {
+    /* memory of one thread */
+    Neighbours nb ;
+    double* dist ;
+    /* distances between the location and its neighbours, (m+1) x (m+1) */
+
+    double* covar ;
+    /* their covariance matrix and its Cholesky factor */
+
+    double* w ;
+    /* solution of the triangular system */
+} Workspace ;
+
+
+
+/* ***************************************************************************
+ * ** Functions **************************************************************
+ * **************************************************************************/
+
+
+/* ***********************
+ * ** private functions **
+ * **********************/
+
+static int
+closer (
+
+        double dist1 ,
+        size_t index1 ,
+        double dist2 ,
+        size_t index2
+        )
+/* '1' if (dist1, index1) comes before (dist2, index2); equal distances are
+ * ordered by the index, so the neighbours do not depend on the order in
+ * which the grid index visits the locations */
+{
+    return dist1 < dist2 || ( dist1 == dist2 && index1 < index2 ) ;
+}
+
+static void
+visit_neighbour (
+
+        size_t index ,
+        double dist ,
+        void* ctx
+        )
+/* callback of 'grid_index_query(...)': inserts 'index' into the sorted list
+ * of neighbours if it is among the 'm' nearest ones */
+{
+    Neighbours* nb = ctx ;
+    if ( index >= nb->self ) {
+
+        return ;
+    }
+    if ( nb->k == nb->m
+            && !closer( dist, index, nb->dist[nb->m-1], nb->index[nb->m-1] ) ) {
+
+        return ;
+    }
+    size_t j = nb->k < nb->m ? nb->k++ : nb->m - 1 ;
+    for ( ; j > 0 && closer( dist, index, nb->dist[j-1], nb->index[j-1] ) ;
+            j-- ) {
+
+        nb->dist[j] = nb->dist[j-1] ;
+        nb->index[j] = nb->index[j-1] ;
+    }
+    nb->dist[j] = dist ;
+    nb->index[j] = index ;
+}
+
+static int
+workspace_alloc (
+
+        Workspace* ws ,
+        size_t m
+        )
+{
+    size_t s = m + 1 ;
+    ws->nb.m = m ;
+    ws->nb.index = scratch_alloc( s * sizeof(size_t) ) ;
+    ws->nb.dist = scratch_alloc( ( m > 0 ? m : 1 ) * sizeof(double) ) ;
+    ws->dist = scratch_alloc( s * s * sizeof(double) ) ;
+    ws->covar = scratch_alloc( s * s * sizeof(double) ) ;
+    ws->w = scratch_alloc( s * sizeof(double) ) ;
+    return ws->nb.index != NULL && ws->nb.dist != NULL && ws->dist != NULL
+        && ws->covar != NULL && ws->w != NULL ;
+}
+
+static void
+workspace_free (
+
+        Workspace* ws
+        )
+{
+    scratch_free( ws->nb.index ) ;
+    scratch_free( ws->nb.dist ) ;
+    scratch_free( ws->dist ) ;
+    scratch_free( ws->covar ) ;
+    scratch_free( ws->w ) ;
+}
+
+static int
+conditional_term (
+
+        const Gw_kernel* kernel ,
+        const double* coords ,
+        size_t n ,
+        int dim ,
+        const double* y ,
+        size_t i ,
+        Workspace* ws ,
+        int* gsl_error ,
+        double* term
+        )
+/* log p( y_i | neighbours ) for the neighbours in 'ws->nb'. The location
+ * is the last one of the block, so the last row of the Cholesky factor
+ * gives the conditional standard deviation and residual. */
+{
+    size_t k = ws->nb.k ;
+    size_t s = k + 1 ;
+    size_t* index = ws->nb.index ;
+    index[k] = i ;
+
+    for ( size_t a = 0 ; a < s ; a++ ) {
+
+        size_t p = index[a] ;
+        ws->dist[a + a*s] = 0 ;
+        for ( size_t b = a+1 ; b < s ; b++ ) {
+
+            size_t q = index[b] ;
+            double d2 = 0 ;
+            for ( int l = 0 ; l < dim ; l++ ) {
+
+                double diff = coords[p + l*n] - coords[q + l*n] ;
+                d2 += diff * diff ;
+            }
+            ws->dist[a + b*s] = sqrt( d2 ) ;
+        }
+    }
+    int ret = gw_eval_matrix( kernel, ws->dist, ws->covar, s, s, NULL,
+            gsl_error ) ;
+    if ( ret != GW_OK ) {
+
+        return ret ;
+    }
+
+    /* Cholesky factor L (lower triangle, column-major) and L w = y */
+    double* L = ws->covar ;
+    for ( size_t a = 0 ; a < s ; a++ ) {
+
+        for ( size_t b = 0 ; b <= a ; b++ ) {
+
+            double sum = L[a + b*s] ;
+            for ( size_t c = 0 ; c < b ; c++ ) {
+
+                sum -= L[a + c*s] * L[b + c*s] ;
+            }
+            if ( a == b ) {
+
+                if ( !( sum > 0 ) ) {
+
+                    return GW_ENOTPD ;
+                }
+                L[a + a*s] = sqrt( sum ) ;
+            } else {
+
+                L[a + b*s] = sum / L[b + b*s] ;
+            }
+        }
+        double sum = y[index[a]] ;
+        for ( size_t c = 0 ; c < a ; c++ ) {
+
+            sum -= L[a + c*s] * ws->w[c] ;
+        }
+        ws->w[a] = sum / L[a + a*s] ;
+    }
+    *term = -0.5 * log( 2 * M_PI ) - log( L[k + k*s] )
+        - 0.5 * ws->w[k] * ws->w[k] ;
+    return GW_OK ;
+}
+
+
+
+/* **********************
+ * ** public functions **
+ * *********************/
+
+int
+gw_vecchia_loglik (
+
+        const Gw_kernel* kernel ,
+        const double* coords ,
+        size_t n ,
+        int dim ,
+        const double* y ,
+        size_t m ,
+        double* loglik ,
+        int* gsl_error
+        )
+{
+    const Gw_params* params = gw_kernel_params( kernel ) ;
+    Grid_index index ;
+    double total = 0 ;
+    int status = GW_OK ;
+    int error = 0 ;
+
+    *loglik = 0 ;
+    if ( n == 0 ) {
+
+        return GW_OK ;
+    }
+    if ( grid_index_build( &index, coords, n, dim, params->rnge ) != 0 ) {
+
+        return GW_ENOMEM ;
+    }
+    gsl_set_error_handler_off() ;
+
+#pragma omp parallel
+    {
+        Workspace ws ;
+        int ok = workspace_alloc( &ws, m ) ;
+        if ( !ok ) {
+
+#pragma omp critical (vecchia_error)
+            {
+                if ( status == GW_OK ) {
+
+#pragma omp atomic write
+                    status = GW_ENOMEM ;
+                }
+            }
+        }
+
+#pragma omp for schedule(dynamic, 64) reduction(+:total)
+        for ( long i = 0 ; i < (long) n ; i++ ) {
+
+            int failed ;
+#pragma omp atomic read
+            failed = status ;
+            if ( failed != GW_OK || !ok ) {
+
+                continue ;
+            }
+
+            ws.nb.self = (size_t) i ;
+            ws.nb.k = 0 ;
+            if ( m > 0 ) {
+
+                grid_index_query( &index, coords + i, n, params->rnge,
+                        visit_neighbour, &ws.nb ) ;
+            }
+            double term ;
+            int gsl = 0 ;
+            int ret = conditional_term( kernel, coords, n, dim, y, (size_t) i,
+                    &ws, &gsl, &term ) ;
+            if ( ret != GW_OK ) {
+
+#pragma omp critical (vecchia_error)
+                {
+                    if ( status == GW_OK ) {
+
+                        error = gsl ;
+#pragma omp atomic write
+                        status = ret ;
+                    }
+                }
+                continue ;
+            }
+            total += term ;
+        }
+        workspace_free( &ws ) ;
+    }
+    grid_index_free( &index ) ;
+
+    if ( status != GW_OK ) {
+
+        if ( gsl_error != NULL ) {
+
+            *gsl_error = error ;
+        }
+        return status ;
+    }
+    *loglik = total ;
+    return GW_OK ;
+}
@@ -0,0 +1,107 @@
+/* This file is part of the R-package 'GWcovar'
+ *
+ * Copyright (C) 2019 Josef Stocker <josef@josefstocker.ch>
+ *
+ * 'GWcovar' is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <https://www.gnu.org/licenses/>.
+ * */
+
+#ifndef VECCHIA_H_
+#define VECCHIA_H_
+
+
+/* ****************************************************************************
+ * ** Include directives  *****************************************************
+ * ***************************************************************************/
+
+#include "stddef.h" /* for type size_t */
+
+#include "gwcovar.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+
+/* ***************************************************************************
+ * ***************************************************************************
+ * ** Public functions  ******************************************************
+ * ***************************************************************************
+ * **************************************************************************/
+
+int
+gw_vecchia_loglik (
+/* ***************************************************************************
+ * The function 'int gw_vecchia_loglik(...)' calculates the Vecchia
+ * approximation of the log-likelihood of the observations 'y' of a zero mean
+ * Gaussian random field with the covariance function 'kernel',
+ *
+ *      log p(y) ~ sum_i log p( y_i | y_j, j in N(i) ) ,
+ *
+ * where N(i) are the (at most) 'm' nearest locations among the locations
+ * 1, ..., i-1 within the range of the kernel. The order of the locations
+ * therefore matters; it is the one of 'coords'. Each term needs the Cholesky
+ * factor of the covariance matrix of at most m+1 locations, so the cost is
+ * O(n m^3) and the terms are calculated in parallel with OpenMP. The
+ * neighbours are found with a grid index ('grid_index.h') whose cells have
+ * the size of the range.
+ *
+ *
+ *  ****************
+ *  ** Arguments: **
+ *  ****************
+ *
+ *  -> const Gw_kernel* kernel:
+ *                          covariance function; a kernel with interpolation
+ *                          table avoids a numerical integration per entry of
+ *                          the small matrices.
+ *
+ *  -> const double* coords:
+ *                          coordinates in column major order (n x dim).
+ *
+ *  -> size_t n, int dim:   number of locations and dimension.
+ *
+ *  -> const double* y:     observations (length n).
+ *
+ *  -> size_t m:            maximal number of neighbours.
+ *
+ *  -> double* loglik:      the log-likelihood is written here.
+ *
+ *  -> int* gsl_error:      the GSL error code is written here if a numerical
+ *                          integration fails; may be 'NULL'.
+ *
+ *  ******************
+ *  ** Return value **
+ *  ******************
+ *
+ *  'GW_OK', 'GW_ENOMEM', 'GW_EINTEG', 'GW_EBETA' or 'GW_ENOTPD' if the
+ *  covariance matrix of a location and its neighbours is not positive
+ *  definite (e.g. two equal locations without nugget).
+ *
+ * **************************************************************************/
+        const Gw_kernel* kernel ,
+        const double* coords ,
+        size_t n ,
+        int dim ,
+        const double* y ,
+        size_t m ,
+        double* loglik ,
+        int* gsl_error
+        ) ;
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  /* #ifndef VECCHIA_H_ */
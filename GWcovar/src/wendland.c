@@ -26,9 +26,7 @@
 #include "gsl/gsl_sf_gamma.h"
 #include "gsl/gsl_integration.h"
 #include "gsl/gsl_errno.h"
-#include "stdio.h"
 #include "math.h" 
-#include "R_ext/Print.h"
 
 /* ***************************************************************************
  * ** Private data structures ************************************************
@@ -91,35 +89,16 @@ fct2 (
 /* **********************
  * ** public functions **
  * *********************/
-int 
-check_wendland_errors ( 
-        Wendland_result* result 
-        ) 
+int
+wendland_error (
+        const Wendland_result* result
+        )
 {
-    int ret = 1 ;
     if ( result->error != 0 ) {
 
-        ret = 0 ;
-        REprintf(
-                "%s\n%s%s\n",
-                "Error occured during numerical integration",
-                "GSL Error: ",
-                gsl_strerror(result->error) 
-               ) ;
-
+        return result->error ;
     }
-    if ( result->error_b != 0 ) {
-
-        ret = 0 ;
-        REprintf(
-                "%s\n%s%s\n",
-                "Error occured while calculating the beta function",
-                "GSL Error: ",
-                gsl_strerror(result->error_b) 
-               ) ;
-
-    }
-    return ret ;
+    return result->error_b ;
 }
 
 void
@@ -147,6 +126,8 @@ wendland (
 
             result->result = 0  ;
         }
+        result->abserr = 0 ;
+        result->neval = 0 ;
         result->error = 0 ;
         result->error_b = 0 ;
     } else {
@@ -158,6 +139,7 @@ wendland (
             Fct_params params = { dist, mu, smoothness } ;
             F.function = &fct2 ;
             F.params = &params ;
+            result->error_b = 0 ;
 
             result->error = gsl_integration_qng(
 
@@ -174,6 +156,8 @@ wendland (
         } else {
 
             result->result = 0 ;
+            result->abserr = 0 ;
+            result->neval = 0 ;
             result->error = 0 ;
             result->error_b = 0 ;
         }
@@ -217,6 +201,8 @@ wendland_qag (
 
             result->result = 0  ;
         }
+        result->abserr = 0 ;
+        result->neval = 0 ;
         result->error = 0 ;
         result->error_b = 0 ;
     } else {
@@ -228,6 +214,7 @@ wendland_qag (
             Fct_params params = { dist, mu, smoothness } ;
             F.function = &fct2 ;
             F.params = &params ;
+            result->error_b = 0 ;
 
             gsl_integration_workspace *p_workspace = 
                 gsl_integration_workspace_alloc( intervals ) ;
@@ -245,11 +232,16 @@ wendland_qag (
                     &(result->abserr) 
                     ) ;
             gsl_integration_workspace_free( p_workspace ) ;
+            result->neval = 0 ;
+            /* 'gsl_integration_qag' does not report the number of
+             * evaluations */
 
 
         } else {
 
             result->result = 0 ;
+            result->abserr = 0 ;
+            result->neval = 0 ;
             result->error = 0 ;
             result->error_b = 0 ;
         }
@@ -265,3 +257,54 @@ wendland_qag (
         }    
     }
 }
+
+int
+wendland_closed_form (
+
+        Wendland_result* result ,
+        double dist,        /*distance between locations*/
+        double mu,          /*param. of correlation func.*/
+        double smoothness   /*param. of correlation func.*/
+        )
+/* The function 'int wendland_closed_form(...)' calculates the GW correlation
+ * function for the smoothness parameters 0, 1, 2 and 3 for which a closed
+ * form is known.
+ * */
+{
+    if ( smoothness != 0 && smoothness != 1 && smoothness != 2
+            && smoothness != 3 ) {
+
+        return 0 ;
+    }
+
+    result->abserr = 0 ;
+    result->neval = 0 ;
+    result->error = 0 ;
+    result->error_b = 0 ;
+
+    if ( dist >= 1 ) {
+
+        result->result = 0 ;
+        return 1 ;
+    }
+
+    double l = mu + smoothness ;
+    double r = dist ;
+    double poly ;
+    if ( smoothness == 0 ) {
+
+        poly = 1 ;
+    } else if ( smoothness == 1 ) {
+
+        poly = 1 + l*r ;
+    } else if ( smoothness == 2 ) {
+
+        poly = 1 + l*r + ( l*l - 1 ) * r*r / 3.0 ;
+    } else {
+
+        poly = 1 + l*r + ( 2*l*l - 3 ) * r*r / 5.0
+            + l * ( l*l - 4 ) * r*r*r / 15.0 ;
+    }
+    result->result = pow( 1.0 - r, l ) * poly ;
+    return 1 ;
+}
@@ -26,6 +26,10 @@
 
 #include "stddef.h" /* for type size_t */
 
+#ifdef __cplusplus
+extern "C" {
+#endif
+
 
 
 /* ***************************************************************************
@@ -44,7 +48,8 @@ typedef struct {
     /* error of the numerical integration */
     
     size_t neval ;
-    /* number of evaluation for num. integration */
+    /* number of evaluation for num. integration ('0' if no numerical
+     * integration was done) */
 
     int error ;
     /* exit status of the GSL function used for numerical integration */
@@ -54,6 +59,23 @@ typedef struct {
 } Wendland_result ;
 
 
+typedef struct {
+/* ***************************************************************************
+ * Parameters of the GW covariance function and of the numerical integration
+ * as they are passed from R.
+ * **************************************************************************/
+    double mu ;
+    double smoothness ;
+    double sill ;
+    double rnge ;
+    double nugget ;
+    double abstol ;
+    double reltol ;
+    double eps ;
+    /* distances below 'eps' are considered to be 0 */
+} Gw_params ;
+
+
 
 
 /* ***************************************************************************
@@ -62,18 +84,20 @@ typedef struct {
  * ***************************************************************************
  * **************************************************************************/
 
-int 
-check_wendland_errors ( 
+int
+wendland_error (
 /* ***************************************************************************
- * The function 'void check_wendland_errors(...)' checks if there has been an
- * errror in the calculation done by a function from 'wendland.c'
- *
- * The function takes an argument 'result' of type 'Wendland_result' and
- * returns '1' if both 'result.error' and 'result.error_b' are '0'. Otherwise
- * it returns '0'. If there is an error, 'check_wendland_errors' also produces
- * an error message using REprintf. 
+ * The function 'int wendland_error(...)' checks if there has been an error
+ * in the calculation done by a function from 'wendland.c'.
+ *
+ * Returns '0' if both 'result.error' and 'result.error_b' are '0', otherwise
+ * the GSL error code of the numerical integration ('result.error') or, if the
+ * integration succeeded, of the beta function ('result.error_b'). Nothing is
+ * printed, so the functions in 'wendland.c' can be used without R (see
+ * 'gwcovar.h'); the R interface reports the errors with
+ * 'check_wendland_errors(...)' in 'covar.c'.
  * **************************************************************************/
-        Wendland_result* result 
+        const Wendland_result* result
         )  ;
 
 
@@ -165,4 +189,32 @@ wendland_qag (
         int key
         ) ;
 
+
+int
+wendland_closed_form (
+/* ***************************************************************************
+ * The function 'int wendland_closed_form(...)' calculates the value of the GW
+ * correlation function without numerical integration, if a closed form is
+ * known for 'smoothness'. This is the case for the integer values 0, 1, 2
+ * and 3, where the GW function reduces to the original Wendland functions
+ * with l = mu + smoothness:
+ *
+ *      k = 0:  (1-r)^mu
+ *      k = 1:  (1-r)^l * ( 1 + l r )
+ *      k = 2:  (1-r)^l * ( 1 + l r + (l^2-1) r^2 / 3 )
+ *      k = 3:  (1-r)^l * ( 1 + l r + (2 l^2-3) r^2 / 5 + l (l^2-4) r^3 / 15 )
+ *
+ * Returns '1' and fills 'result' if a closed form was used, otherwise '0' is
+ * returned and 'result' is not touched.
+ * ***************************************************************************/
+        Wendland_result* result ,
+        double dist,
+        double mu,
+        double smoothness
+        ) ;
+
+#ifdef __cplusplus
+}
+#endif
+
 #endif  /* #ifndef WENDLAND_H_ */